@@ -0,0 +1,160 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+// 性能测试公用的计时与回环客户端工具（仅头文件）
+
+#include "Frame.h"
+#include "Socket.h"
+#include "Crypto.h"
+#include "Packet.h"
+#include "TimeTools.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <netinet/tcp.h>
+
+// 计时辅助：返回秒
+inline double ElapsedSec(uint64_t startUS)
+{
+    return (GetTimeUS() - startUS) / 1e6;
+}
+
+// 阻塞读满 len 字节
+inline bool RecvAll(SOCKET_TYPE sock, uint8_t *buf, size_t len)
+{
+    size_t got = 0;
+    while (got < len)
+    {
+        int n = recv(sock, reinterpret_cast<char *>(buf + got), (int)(len - got), 0);
+        if (n <= 0)
+            return false;
+        got += n;
+    }
+    return true;
+}
+
+inline bool SendAll(SOCKET_TYPE sock, const uint8_t *bytes, size_t len)
+{
+    size_t sent = 0;
+    while (sent < len)
+    {
+        int n = send(sock, reinterpret_cast<const char *>(bytes + sent), (int)(len - sent), 0);
+        if (n <= 0)
+            return false;
+        sent += n;
+    }
+    return true;
+}
+
+inline bool SendAll(SOCKET_TYPE sock, const std::vector<uint8_t> &bytes)
+{
+    return SendAll(sock, bytes.data(), bytes.size());
+}
+
+// 读取一个完整的帧，返回帧头，负载写入 data
+inline bool RecvFrame(SOCKET_TYPE sock, Frame::Header &head, std::vector<uint8_t> &data)
+{
+    if (!RecvAll(sock, reinterpret_cast<uint8_t *>(&head), sizeof(head)))
+        return false;
+    if (head.length < sizeof(head))
+        return false;
+    data.resize(head.length - sizeof(head));
+    return data.empty() || RecvAll(sock, data.data(), data.size());
+}
+
+// 连接本机端口，返回阻塞 Socket
+inline SOCKET_TYPE ConnectLoopback(int port)
+{
+    SOCKET_TYPE sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == (SOCKET_TYPE)INVALID_SOCKET)
+        return sock;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(sock, (sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        CLOSE_SOCKET(sock);
+        return (SOCKET_TYPE)INVALID_SOCKET;
+    }
+    int one = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char *)&one, sizeof(one));
+    return sock;
+}
+
+// 完成 Hello -> NewSession -> Pending -> Activated 握手，session 中得到 sessionId、会话密钥与采用的线路格式；
+// identity 非空时校验服务端对临时公钥的签名；format 为期望的线路格式，服务端可能退回标准格式
+inline bool Handshake(SOCKET_TYPE sock, SessionContext &session, const std::vector<uint8_t> *identity = nullptr,
+                      WireFormat format = WireFormat::Standard)
+{
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    if (!SendAll(sock, Frame(Frame::Status::Hello).ToBytes()) || !RecvFrame(sock, head, data) ||
+        head.status != Frame::Status::NewSession || data.size() != X25519_KEY_SIZE + SIGNATURE_SIZE)
+        return false;
+    session.sessionId = head.sessionId;
+    std::vector<uint8_t> serverPk(data.begin(), data.begin() + X25519_KEY_SIZE);
+    if (identity)
+    {
+        std::vector<uint8_t> message = SessionContext::SignedMessage(session.sessionId, serverPk);
+        if (!VerifySignature(*identity, message.data(), message.size(), data.data() + X25519_KEY_SIZE))
+            return false;
+    }
+
+    // 客户端一侧：sk / pk 为本端临时密钥，pk2 为服务端临时公钥
+    std::vector<uint8_t> secret;
+    if (!session.KeyGen() || !X25519Agree(session.sk, serverPk, secret))
+        return false;
+    session.pk2 = serverPk;
+    session.sharedKey = DeriveSessionKey(secret, serverPk, session.pk);
+    session.resumeKey = DeriveResumeKey(secret, serverPk, session.pk);
+    session.InitNonce(false);
+    if (!session.InitCipher())
+        return false;
+    std::vector<uint8_t> pending = session.pk;
+    if (format != WireFormat::Standard)
+        pending.push_back((uint8_t)format);
+    if (!SendAll(sock, Frame(Frame::Status::Pending, session.sessionId, {}, pending).ToBytes()) || !RecvFrame(sock, head, data))
+        return false;
+    session.isActive = head.status == Frame::Status::Activated;
+    session.wireFormat = data.empty() ? (uint8_t)WireFormat::Standard : data[0];
+    return session.isActive;
+}
+
+// 只关心能否建立会话时使用，返回 sessionId（失败返回 0）
+inline uint64_t Handshake(SOCKET_TYPE sock)
+{
+    SessionContext session(-1, 0);
+    return Handshake(sock, session) ? session.sessionId : 0;
+}
+
+// 以会话密钥加密负载并组成 Active（或 Batch）帧，nonce 取客户端方向的会话计数
+inline std::vector<uint8_t> SealFrame(SessionContext &session, std::vector<uint8_t> payload,
+                                      Frame::Status status = Frame::Status::Active)
+{
+    std::array<uint8_t, 16> iv;
+    session.NextNonce(iv.data());
+    Frame frame(status, session.sessionId, iv, std::move(payload));
+    std::array<uint8_t, 12> aad = frame.AuthData();
+    session.Encrypt(frame.data, iv.data(), aad.data(), aad.size());
+    return frame.ToBytes();
+}
+
+// 多个请求编码为 Batch 帧的负载
+inline std::vector<uint8_t> BatchBytes(const std::vector<Packet> &packets, WireFormat format = WireFormat::Standard)
+{
+    std::vector<uint8_t> bytes(BatchEncodedSize(packets.data(), packets.size(), format));
+    WriteBatch(packets.data(), packets.size(), bytes.data(), format);
+    return bytes;
+}
+
+// 校验并解密服务端推送的负载
+inline bool OpenFrame(SessionContext &session, const Frame::Header &head, std::vector<uint8_t> &data)
+{
+    Frame frame(head.status, head.sessionId);
+    std::array<uint8_t, 12> aad = frame.AuthData();
+    return session.Decrypt(data, head.iv.data(), aad.data(), aad.size());
+}
+
+#endif // BENCH_UTIL_H
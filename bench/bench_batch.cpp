@@ -0,0 +1,95 @@
+// 批量帧测试：客户端一次发出 4 个请求（如加入房间后同步座位、设置与对局），逐帧发送 vs 合并为一个 Batch 帧
+//
+// 用法：bench_batch [轮数]
+// 服务端回调直接回显 Packet，不经过 Handler；每轮等全部应答收齐再开始下一轮，
+// 计时包含两端的加解密、帧头解析与一次往返。
+
+#include "BenchUtil.h"
+#include "Server.h"
+#include "Logger.h"
+
+#include <thread>
+#include <cstdlib>
+
+#define BENCH_PORT 18070
+#define REQUESTS_PER_ROUND 4
+
+static void Report(const char *name, int rounds, double sec, uint64_t frames)
+{
+    std::printf("  %-16s %10.0f req/s %8.1f us/round   (%llu frames received)\n", name,
+                rounds * REQUESTS_PER_ROUND / sec, sec * 1e6 / rounds, (unsigned long long)frames);
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 20000;
+    Logger::init("", LogLevel::ERROR, true);
+
+    Server server;
+    server.SetPort(BENCH_PORT);
+    server.SetOnPacketCallback([&server](const Packet &packet)
+                               { server.SendPacket(packet); });
+    if (server.Init() != 0)
+    {
+        std::fprintf(stderr, "server init failed\n");
+        return 1;
+    }
+    std::thread serverThread([&server]()
+                             { server.Run(); });
+
+    SOCKET_TYPE sock = ConnectLoopback(BENCH_PORT);
+    SessionContext session(-1, 0);
+    if (sock == (SOCKET_TYPE)INVALID_SOCKET || !Handshake(sock, session))
+    {
+        std::fprintf(stderr, "handshake failed\n");
+        return 1;
+    }
+
+    const MsgType types[REQUESTS_PER_ROUND] = {MsgType::JoinRoom, MsgType::SyncSeat, MsgType::SyncRoomSetting,
+                                               MsgType::SyncGame};
+    std::vector<Packet> requests;
+    for (MsgType type : types)
+    {
+        Packet packet(session.sessionId, type);
+        packet.AddParam("roomId", uint32_t(1));
+        requests.push_back(packet);
+    }
+
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    uint64_t frames = 0;
+    bool ok = true;
+    uint64_t start = GetTimeUS();
+    for (int i = 0; i < rounds && ok; i++)
+    {
+        for (const Packet &request : requests)
+            ok &= SendAll(sock, SealFrame(session, request.ToBytes()));
+        for (int j = 0; j < REQUESTS_PER_ROUND && ok; j++)
+        {
+            ok &= RecvFrame(sock, head, data) && OpenFrame(session, head, data);
+            Packet reply;
+            ok &= reply.FromData(session.sessionId, std::move(data));
+            frames++;
+        }
+    }
+    Report("frame per packet", rounds, ElapsedSec(start), frames);
+
+    frames = 0;
+    std::vector<Packet> replies;
+    start = GetTimeUS();
+    for (int i = 0; i < rounds && ok; i++)
+    {
+        ok &= SendAll(sock, SealFrame(session, BatchBytes(requests), Frame::Status::Batch));
+        ok &= RecvFrame(sock, head, data) && OpenFrame(session, head, data) &&
+              ReadBatch(session.sessionId, data, replies) && replies.size() == REQUESTS_PER_ROUND;
+        frames++;
+    }
+    Report("batch frame", rounds, ElapsedSec(start), frames);
+
+    if (!ok)
+        std::fprintf(stderr, "client operations failed\n");
+    CLOSE_SOCKET(sock);
+    server.Stop();
+    serverThread.join();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+// 帧负载加密吞吐测试：AES-256-GCM，每会话缓存的密码上下文 vs 每帧重建上下文
+//
+// 用法：bench_crypto [每种帧长的帧数]
+// 缓存上下文时每帧只重置 nonce；重建时每帧都要分配上下文并做一次密钥扩展。
+// 末尾对比每帧取 nonce 的开销：会话计数 vs 每帧分配缓冲并调用 RAND_bytes，以及随机数池与直接调用系统 RNG。
+
+#include "BenchUtil.h"
+#include "Crypto.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+// 每帧新建上下文（未缓存时的做法）
+static bool SealUncached(const std::vector<uint8_t> &key, uint8_t *data, size_t len, const uint8_t *nonce, uint8_t *tag)
+{
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    int outLen = 0;
+    bool ok = EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr, key.data(), nonce) == 1 &&
+              EVP_EncryptUpdate(ctx, data, &outLen, data, (int)len) == 1 &&
+              EVP_EncryptFinal_ex(ctx, data + len, &outLen) == 1 &&
+              EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, AEAD_TAG_SIZE, tag) == 1;
+    EVP_CIPHER_CTX_free(ctx);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    int frames = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+    DHContext ctx;
+    ctx.sharedKey = GenerateRandomBytes(AEAD_KEY_SIZE);
+    if (!ctx.InitCipher())
+    {
+        std::printf("cipher init failed\n");
+        return 1;
+    }
+
+    uint8_t nonce[AEAD_NONCE_SIZE] = {};
+    uint8_t tag[AEAD_TAG_SIZE];
+    uint8_t aad[12] = {};
+    std::printf("%8s %14s %14s %14s %14s\n", "bytes", "seal MB/s", "seal frames/s", "open MB/s", "uncached f/s");
+    for (size_t len : {64, 256, 512, 1024 - 37, 16384})
+    {
+        std::vector<uint8_t> buffer = GenerateRandomBytes(len);
+
+        uint64_t start = GetTimeUS();
+        for (int i = 0; i < frames; i++)
+        {
+            std::memcpy(nonce, &i, sizeof(i));
+            ctx.Seal(buffer.data(), len, nonce, aad, sizeof(aad), tag);
+        }
+        double sealSec = ElapsedSec(start);
+
+        // 解密：每轮先把同一份密文拷回工作缓冲区再校验解密（拷贝开销远小于 GCM）
+        std::vector<uint8_t> sealed = buffer;
+        uint8_t sealedTag[AEAD_TAG_SIZE];
+        ctx.Seal(sealed.data(), len, nonce, aad, sizeof(aad), sealedTag);
+        start = GetTimeUS();
+        int failed = 0;
+        for (int i = 0; i < frames; i++)
+        {
+            std::memcpy(buffer.data(), sealed.data(), len);
+            failed += !ctx.Open(buffer.data(), len, nonce, aad, sizeof(aad), sealedTag);
+        }
+        double openSec = ElapsedSec(start);
+        if (failed)
+            std::printf("  open failed %d times\n", failed);
+
+        start = GetTimeUS();
+        for (int i = 0; i < frames; i++)
+        {
+            std::memcpy(nonce, &i, sizeof(i));
+            SealUncached(ctx.sharedKey, buffer.data(), len, nonce, tag);
+        }
+        double uncachedSec = ElapsedSec(start);
+
+        double mb = (double)len * frames / (1024 * 1024);
+        std::printf("%8zu %14.1f %14.0f %14.1f %14.0f\n", len, mb / sealSec, frames / sealSec,
+                    mb / openSec, frames / uncachedSec);
+    }
+
+    // 每帧 nonce：会话计数 vs 每帧分配 + RAND_bytes（原做法）
+    ctx.InitNonce(true);
+    uint64_t start = GetTimeUS();
+    uint8_t iv[FRAME_IV_SIZE];
+    for (int i = 0; i < frames; i++)
+        ctx.NextNonce(iv);
+    double counterSec = ElapsedSec(start);
+    start = GetTimeUS();
+    for (int i = 0; i < frames; i++)
+    {
+        std::vector<uint8_t> random(FRAME_IV_SIZE);
+        RAND_bytes(random.data(), (int)random.size());
+    }
+    double randSec = ElapsedSec(start);
+    std::printf("\nnonce per frame: counter %.1f ns, alloc + RAND_bytes %.1f ns\n",
+                counterSec * 1e9 / frames, randSec * 1e9 / frames);
+
+    // sessionId：随机数池 vs 每次 RAND_bytes
+    uint64_t sink = 0;
+    start = GetTimeUS();
+    for (int i = 0; i < frames; i++)
+        sink ^= RandomU64();
+    double poolSec = ElapsedSec(start);
+    start = GetTimeUS();
+    for (int i = 0; i < frames; i++)
+    {
+        uint64_t value;
+        RAND_bytes(reinterpret_cast<uint8_t *>(&value), sizeof(value));
+        sink ^= value;
+    }
+    double directSec = ElapsedSec(start);
+    std::printf("random u64: pool %.1f ns, RAND_bytes %.1f ns (%llx)\n",
+                poolSec * 1e9 / frames, directSec * 1e9 / frames, (unsigned long long)(sink & 0xF));
+    return 0;
+}
@@ -0,0 +1,62 @@
+// 空闲超时时间轮测试：大量会话下每次心跳与每个 tick 的开销
+//
+// 用法：bench_expiry [会话数] [每 tick 活跃比例 0..1]
+// 模拟 30 秒超时、1 秒精度，时间由测试推进而非真实等待。
+
+#include "BenchUtil.h"
+#include "ExpiryWheel.h"
+
+#include <cstdlib>
+#include <random>
+
+#define TIMEOUT_MS 30000
+#define TICK_MS 1000
+
+int main(int argc, char **argv)
+{
+    int sessions = argc > 1 ? std::atoi(argv[1]) : 100000;
+    double activeRatio = argc > 2 ? std::atof(argv[2]) : 0.1;
+
+    ExpiryWheel wheel;
+    wheel.Init(TICK_MS, TIMEOUT_MS / TICK_MS + 2);
+    std::vector<uint64_t> lastActive(sessions, 0);
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> pick(0, sessions - 1);
+
+    uint64_t now = 1000000;
+    uint64_t start = GetTimeUS();
+    for (int fd = 0; fd < sessions; fd++)
+    {
+        lastActive[fd] = now;
+        wheel.Schedule(fd, now + TIMEOUT_MS);
+    }
+    double scheduleSec = ElapsedSec(start);
+
+    // 推进 120 秒：每个 tick 随机一部分会话发送心跳（只写时间戳），其余最终超时
+    int touches = (int)(sessions * activeRatio);
+    uint64_t touchUS = 0, advanceUS = 0, expired = 0, renewed = 0;
+    for (int tick = 0; tick < 120; tick++)
+    {
+        now += TICK_MS;
+        start = GetTimeUS();
+        for (int i = 0; i < touches; i++)
+            lastActive[pick(rng)] = now;
+        touchUS += GetTimeUS() - start;
+
+        start = GetTimeUS();
+        wheel.Advance(now, [&](int fd) -> uint64_t
+                      {
+            uint64_t deadline = lastActive[fd] + TIMEOUT_MS;
+            if (deadline > now) { renewed++; return deadline; }
+            expired++;
+            return 0; });
+        advanceUS += GetTimeUS() - start;
+    }
+
+    std::printf("sessions %d, active %.0f%% per tick\n", sessions, activeRatio * 100);
+    std::printf("  schedule     %10.1f ns/session\n", scheduleSec * 1e9 / sessions);
+    std::printf("  heartbeat    %10.1f ns/touch\n", touchUS * 1e3 / std::max(1, touches * 120));
+    std::printf("  advance      %10.1f us/tick (%llu renewed, %llu expired, %zu left)\n",
+                advanceUS / 120.0, (unsigned long long)renewed, (unsigned long long)expired, wheel.Size());
+    return 0;
+}
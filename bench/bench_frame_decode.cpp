@@ -0,0 +1,108 @@
+// 解帧吞吐测试：增量解码器与旧的逐字节 erase 式解码在干净 / 损坏数据流上的对比
+//
+// 用法：bench_frame_decode [流大小 MB] [损坏比例 0..1]
+// 损坏流在每帧之间随机插入垃圾字节，旧实现每次校验失败只丢弃 1 字节并整体前移缓冲区。
+
+#include "BenchUtil.h"
+#include "FrameDecoder.h"
+
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#define CHUNK_SIZE 4096 // 模拟单次 recv 的大小
+
+// 旧实现：vector 头部 erase，每个非法字节都要搬移整个缓冲区
+static bool LegacyReadStream(Frame &frame, std::vector<uint8_t> &buffer)
+{
+    while (buffer.size() >= sizeof(Frame::Header))
+    {
+        if (!frame.ReadHeader(buffer.data(), buffer.size()))
+        {
+            buffer.erase(buffer.begin());
+            continue;
+        }
+        if (buffer.size() < frame.head.length)
+            return false;
+        frame.ReadBytes(buffer.data(), buffer.size());
+        buffer.erase(buffer.begin(), buffer.begin() + frame.head.length);
+        return true;
+    }
+    return false;
+}
+
+static std::vector<uint8_t> BuildStream(size_t totalBytes, double corruptRatio, size_t &frames)
+{
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> sizeDist(16, 512);
+    std::uniform_int_distribution<int> byteDist(0, 255);
+    std::bernoulli_distribution corrupt(corruptRatio);
+
+    std::vector<uint8_t> stream;
+    stream.reserve(totalBytes + MAX_FRAME_SIZE);
+    frames = 0;
+    while (stream.size() < totalBytes)
+    {
+        if (corrupt(rng))
+        {
+            int n = sizeDist(rng);
+            for (int i = 0; i < n; i++)
+                stream.push_back((uint8_t)byteDist(rng));
+        }
+        std::vector<uint8_t> payload(sizeDist(rng), 0x5A);
+        auto bytes = Frame(Frame::Status::Active, frames, {}, payload).ToBytes();
+        stream.insert(stream.end(), bytes.begin(), bytes.end());
+        frames++;
+    }
+    return stream;
+}
+
+static void Report(const char *name, size_t bytes, size_t frames, size_t expect, double sec)
+{
+    std::printf("  %-12s %12.1f MB/s %14.0f frames/s %10zu/%zu\n", name,
+                bytes / sec / 1e6, frames / sec, frames, expect);
+}
+
+static void RunOnce(const char *label, const std::vector<uint8_t> &stream, size_t expect)
+{
+    std::printf("%s (%zu bytes)\n", label, stream.size());
+
+    FrameDecoder decoder;
+    Frame frame;
+    size_t frames = 0;
+    uint64_t start = GetTimeUS();
+    for (size_t offset = 0; offset < stream.size(); offset += CHUNK_SIZE)
+    {
+        decoder.Feed(stream.data() + offset, std::min((size_t)CHUNK_SIZE, stream.size() - offset));
+        while (decoder.Next(frame))
+            frames++;
+    }
+    Report("decoder", stream.size(), frames, expect, ElapsedSec(start));
+
+    std::vector<uint8_t> buffer;
+    frames = 0;
+    start = GetTimeUS();
+    for (size_t offset = 0; offset < stream.size(); offset += CHUNK_SIZE)
+    {
+        size_t len = std::min((size_t)CHUNK_SIZE, stream.size() - offset);
+        buffer.insert(buffer.end(), stream.data() + offset, stream.data() + offset + len);
+        while (LegacyReadStream(frame, buffer))
+            frames++;
+    }
+    Report("legacy", stream.size(), frames, expect, ElapsedSec(start));
+}
+
+int main(int argc, char **argv)
+{
+    size_t mb = argc > 1 ? std::atoi(argv[1]) : 64;
+    double corruptRatio = argc > 2 ? std::atof(argv[2]) : 0.2;
+
+    size_t frames = 0;
+    auto clean = BuildStream(mb << 20, 0, frames);
+    RunOnce("clean", clean, frames);
+
+    auto corrupted = BuildStream(mb << 20, corruptRatio, frames);
+    RunOnce("corrupted", corrupted, frames);
+    return 0;
+}
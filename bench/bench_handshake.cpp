@@ -0,0 +1,101 @@
+// 握手吞吐测试：单核每秒可完成的密钥协商数，以及回环上的端到端握手速率
+//
+// 用法：bench_handshake [握手次数] [握手线程数]
+// 第一部分只测服务端一次握手的公钥运算（X25519 生成 + Ed25519 签名 + X25519 协商 + HKDF），
+// 第二部分经回环完成完整的 Hello -> Activated 往返，对比在 Reactor 线程上计算与交给握手线程计算。
+// 客户端同样要做 X25519 运算，与服务端同机运行时端到端结果会被客户端线程稀释。
+
+#include "BenchUtil.h"
+#include "Server.h"
+#include "Logger.h"
+
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+
+#define BENCH_PORT 18280
+#define CLIENT_THREADS 4
+
+static double RunLoopback(int count, int handshakeThreads)
+{
+    Server server;
+    server.SetPort(BENCH_PORT + handshakeThreads);
+    server.SetHandshakeThreads(handshakeThreads);
+    if (server.Init() != 0)
+    {
+        std::fprintf(stderr, "server init failed\n");
+        std::exit(1);
+    }
+    std::thread serverThread([&server]()
+                             { server.Run(); });
+
+    std::atomic<int> failed{0};
+    std::vector<std::thread> clients;
+    uint64_t start = GetTimeUS();
+    for (int t = 0; t < CLIENT_THREADS; t++)
+    {
+        clients.emplace_back([&]()
+                             {
+            for (int i = 0; i < count / CLIENT_THREADS; i++) {
+                SOCKET_TYPE sock = ConnectLoopback(BENCH_PORT + handshakeThreads);
+                SessionContext session(-1, 0);
+                if (sock == (SOCKET_TYPE)INVALID_SOCKET || !Handshake(sock, session, &server.GetIdentityKey()))
+                    failed++;
+                if (sock != (SOCKET_TYPE)INVALID_SOCKET)
+                    CLOSE_SOCKET(sock);
+            } });
+    }
+    for (auto &c : clients)
+        c.join();
+    double sec = ElapsedSec(start);
+
+    server.Stop();
+    serverThread.join();
+    if (failed)
+        std::fprintf(stderr, "  %d handshakes failed\n", failed.load());
+    return (count / CLIENT_THREADS * CLIENT_THREADS) / sec;
+}
+
+int main(int argc, char **argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 4000;
+    int workers = argc > 2 ? std::atoi(argv[2]) : (int)std::max(1u, std::thread::hardware_concurrency());
+
+    Logger::init("", LogLevel::ERROR, true);
+
+    // 第一部分：服务端单核运算
+    SigningKey identity;
+    SessionContext client(-1, 0);
+    client.KeyGen();
+    double keygen = 0, sign = 0, derive = 0;
+    int ok = 0;
+    for (int i = 0; i < count; i++)
+    {
+        SessionContext ctx(i, (uint64_t)i << 8);
+        uint64_t t0 = GetTimeUS();
+        bool good = ctx.KeyGen();
+        uint64_t t1 = GetTimeUS();
+        good = ctx.Sign(identity) && good;
+        uint64_t t2 = GetTimeUS();
+        ctx.pk2 = client.pk;
+        good = ctx.CalculateSharedKey() && good;
+        uint64_t t3 = GetTimeUS();
+        keygen += t1 - t0;
+        sign += t2 - t1;
+        derive += t3 - t2;
+        ok += good;
+    }
+    double total = keygen + sign + derive;
+    std::printf("server crypto per handshake: %.1f us (keygen %.1f, sign %.1f, derive %.1f), %d/%d ok\n",
+                total / count, keygen / count, sign / count, derive / count, ok, count);
+    std::printf("handshakes/s per core: %.0f\n\n", count / (total / 1e6));
+
+    // 第二部分：回环端到端
+    std::printf("%-20s %15s\n", "handshake threads", "handshakes/s");
+    std::printf("%-20d %15.0f\n", 0, RunLoopback(count, 0));
+    std::printf("%-20d %15.0f\n", workers, RunLoopback(count, workers));
+
+    TimeTools::ReleaseInstance();
+    Logger::shutdown();
+    return 0;
+}
@@ -0,0 +1,159 @@
+// 消息编解码测试：类型化消息（编译期字段表）vs Packet 的 std::map 字段表
+//
+// 用法：bench_packet [每项的次数]
+// map 方式每个字段都要分配键字符串、插入红黑树并经 variant 分派；类型化消息直接读写线路格式；
+// PacketView 直接在原始字节上按键取值，不复制数据。
+// 出站部分对比逐层复制（负载 vector -> Frame -> 帧字节 vector -> 队列）与两遍编码直接写入出站队列（不含加密）。
+// 扇出部分对比大厅推送逐会话复制、编码与 Share() 后共用一份已编码负载（紧凑格式，按每个接收者计时）。
+
+#include "BenchUtil.h"
+#include "PacketView.h"
+#include "SendQueue.h"
+
+#include <cstdlib>
+#include <cstring>
+
+static void Report(const char *name, int count, double sec, uint64_t check)
+{
+    std::printf("  %-22s %12.0f ops/s %10.1f ns/op   (check %llu)\n", name, count / sec, sec * 1e9 / count,
+                (unsigned long long)check);
+}
+
+int main(int argc, char **argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    std::printf("MakeMove {x, y}\n");
+    uint64_t check = 0;
+    uint64_t start = GetTimeUS();
+    for (int i = 0; i < count; i++)
+    {
+        Packet packet(1, MsgType::MakeMove);
+        packet.AddParam("x", uint32_t(i & 15));
+        packet.AddParam("y", uint32_t(i >> 4 & 15));
+        check += packet.ToBytes().size();
+    }
+    Report("map encode", count, ElapsedSec(start), check);
+
+    check = 0;
+    start = GetTimeUS();
+    for (int i = 0; i < count; i++)
+    {
+        MoveMsg move;
+        move.x = i & 15;
+        move.y = i >> 4 & 15;
+        check += Packet::Of(1, MsgType::MakeMove, move).ToBytes().size();
+    }
+    Report("typed encode", count, ElapsedSec(start), check);
+
+    MoveMsg sample;
+    sample.x = 7;
+    sample.y = 8;
+    const std::vector<uint8_t> bytes = Packet::Of(1, MsgType::MakeMove, sample).ToBytes();
+
+    check = 0;
+    start = GetTimeUS();
+    for (int i = 0; i < count; i++)
+    {
+        Packet packet;
+        packet.FromData(1, bytes);
+        check += packet.GetParam<uint32_t>("x") + packet.GetParam<uint32_t>("y");
+    }
+    Report("map decode", count, ElapsedSec(start), check);
+
+    check = 0;
+    start = GetTimeUS();
+    for (int i = 0; i < count; i++)
+    {
+        Packet packet;
+        packet.FromData(1, bytes);
+        MoveMsg move;
+        packet.As(move);
+        check += move.x + move.y;
+    }
+    Report("typed decode", count, ElapsedSec(start), check);
+
+    check = 0;
+    start = GetTimeUS();
+    for (int i = 0; i < count; i++)
+    {
+        PacketView view;
+        view.Parse(1, bytes.data(), bytes.size());
+        check += view.Get<uint32_t>("x") + view.Get<uint32_t>("y");
+    }
+    Report("view decode", count, ElapsedSec(start), check);
+
+    std::printf("MakeMove -> outbound queue\n");
+    const Packet packet = Packet::Of(1, MsgType::MakeMove, sample);
+    SendQueue queue;
+    check = 0;
+    start = GetTimeUS();
+    for (int i = 0; i < count; i++)
+    {
+        Frame frame(Frame::Status::Active, 1, {}, packet.ToBytes());
+        std::vector<uint8_t> bytes = frame.ToBytes();
+        queue.Append(bytes.data(), bytes.size());
+        check += queue.Size();
+        queue.Clear();
+    }
+    Report("copy per layer", count, ElapsedSec(start), check);
+
+    check = 0;
+    start = GetTimeUS();
+    for (int i = 0; i < count; i++)
+    {
+        size_t payloadLen = packet.EncodedSize();
+        size_t len = sizeof(Frame::Header) + payloadLen;
+        uint8_t *out = queue.Reserve(len);
+        packet.WriteTo(out + sizeof(Frame::Header));
+        Frame frame(Frame::Status::Active, 1);
+        frame.head.length = (uint32_t)len;
+        std::memcpy(out, &frame.head, sizeof(Frame::Header));
+        queue.Commit(len);
+        check += queue.Size();
+        queue.Clear();
+    }
+    Report("two-pass in place", count, ElapsedSec(start), check);
+
+    const int recipients = 1000;
+    int rounds = count / recipients > 0 ? count / recipients : 1;
+    std::printf("RoomList push -> %d sessions (compact)\n", recipients);
+    RoomListMsg rooms;
+    for (int i = 0; i < 10; i++)
+        rooms.roomList += "#" + std::to_string(i) + ", 空闲, player" + std::to_string(i) + " (等待对手), ";
+    rooms.count = 10;
+    const Packet push = Packet::Of(0, MsgType::updateRoomsToLobby, rooms);
+
+    auto fanOut = [&queue](const Packet &packet, int recipients)
+    {
+        uint64_t total = 0;
+        for (int i = 0; i < recipients; i++)
+        {
+            Packet copy = packet;
+            copy.sessionId = i;
+            size_t len = copy.EncodedSize(WireFormat::Compact);
+            copy.WriteTo(queue.Reserve(len), WireFormat::Compact);
+            queue.Commit(len);
+            total += queue.Size();
+            queue.Clear();
+        }
+        return total;
+    };
+
+    check = 0;
+    start = GetTimeUS();
+    for (int r = 0; r < rounds; r++)
+        check += fanOut(push, recipients);
+    Report("copy per session", rounds * recipients, ElapsedSec(start), check);
+
+    check = 0;
+    start = GetTimeUS();
+    for (int r = 0; r < rounds; r++)
+    {
+        Packet shared = push;
+        shared.Share();
+        check += fanOut(shared, recipients);
+    }
+    Report("shared payload", rounds * recipients, ElapsedSec(start), check);
+    return 0;
+}
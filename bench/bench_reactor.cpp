@@ -0,0 +1,149 @@
+// 多 Reactor 扩展性测试：1..N 个 Reactor 线程下的建连速率与收发包速率
+//
+// 用法：bench_reactor [最大线程数] [每线程连接数] [每连接包数]
+// 服务端回调直接回显 Packet，不经过 Handler，测的是网络层本身。
+// 客户端与服务端运行在同一台机器上，核数不足时结果会被客户端线程稀释。
+
+#include "BenchUtil.h"
+#include "Server.h"
+#include "Logger.h"
+
+#include <thread>
+#include <atomic>
+#include <string>
+#include <cstdlib>
+#include <memory>
+
+#define BENCH_PORT 18080
+#define CLIENT_THREADS 4
+#define PIPELINE_WINDOW 16
+
+struct Result
+{
+    double connPerSec;
+    double pktPerSec;
+    Server::NetStats stats;
+};
+
+static Result RunOnce(int reactors, int connsPerThread, int pktsPerConn)
+{
+    Server server;
+    server.SetPort(BENCH_PORT + reactors);
+    server.SetThreadCount(reactors);
+    server.SetOnPacketCallback([&server](const Packet &packet)
+                               { server.SendPacket(packet); });
+    if (server.Init() != 0)
+    {
+        std::fprintf(stderr, "server init failed\n");
+        std::exit(1);
+    }
+    std::thread serverThread([&server]()
+                             { server.Run(); });
+
+    std::vector<std::vector<SOCKET_TYPE>> socks(CLIENT_THREADS);
+    std::vector<std::vector<std::unique_ptr<SessionContext>>> sessions(CLIENT_THREADS);
+    std::atomic<int> failed{0};
+
+    // 阶段一：建连 + 握手
+    uint64_t start = GetTimeUS();
+    std::vector<std::thread> clients;
+    for (int t = 0; t < CLIENT_THREADS; t++)
+    {
+        clients.emplace_back([&, t]()
+                             {
+            for (int i = 0; i < connsPerThread; i++) {
+                SOCKET_TYPE sock = ConnectLoopback(BENCH_PORT + reactors);
+                auto session = std::make_unique<SessionContext>(-1, 0);
+                if (sock == (SOCKET_TYPE)INVALID_SOCKET || !Handshake(sock, *session)) {
+                    failed++;
+                    if (sock != (SOCKET_TYPE)INVALID_SOCKET)
+                        CLOSE_SOCKET(sock);
+                    continue;
+                }
+                socks[t].push_back(sock);
+                sessions[t].push_back(std::move(session));
+            } });
+    }
+    for (auto &c : clients)
+        c.join();
+    double connSec = ElapsedSec(start);
+    clients.clear();
+
+    // 阶段二：每个连接流水线发送心跳包并读取回显；负载按会话加密，全部帧预先组好
+    // （每帧序号不同，重发同一窗口会被服务端当作重放拒绝），每轮发送其中一段
+    int rounds = pktsPerConn / PIPELINE_WINDOW;
+    std::vector<std::vector<std::vector<uint8_t>>> streams(CLIENT_THREADS);
+    std::vector<size_t> windowBytes(CLIENT_THREADS, 0);
+    for (int t = 0; t < CLIENT_THREADS; t++)
+    {
+        for (auto &session : sessions[t])
+        {
+            std::vector<uint8_t> payload = Packet(session->sessionId, MsgType::None).ToBytes();
+            std::vector<uint8_t> stream;
+            for (int i = 0; i < rounds * PIPELINE_WINDOW; i++)
+            {
+                auto bytes = SealFrame(*session, payload);
+                windowBytes[t] = bytes.size() * PIPELINE_WINDOW;
+                stream.insert(stream.end(), bytes.begin(), bytes.end());
+            }
+            streams[t].push_back(std::move(stream));
+        }
+    }
+
+    start = GetTimeUS();
+    for (int t = 0; t < CLIENT_THREADS; t++)
+    {
+        clients.emplace_back([&, t]()
+                             {
+            Frame::Header head;
+            std::vector<uint8_t> data;
+            for (int round = 0; round < rounds; round++) {
+                for (size_t i = 0; i < socks[t].size(); i++)
+                    SendAll(socks[t][i], streams[t][i].data() + round * windowBytes[t], windowBytes[t]);
+                for (SOCKET_TYPE sock : socks[t])
+                    for (int i = 0; i < PIPELINE_WINDOW; i++)
+                        if (!RecvFrame(sock, head, data)) { failed++; return; }
+            } });
+    }
+    for (auto &c : clients)
+        c.join();
+    double pktSec = ElapsedSec(start);
+
+    Server::NetStats stats = server.GetStats();
+    for (auto &list : socks)
+        for (SOCKET_TYPE sock : list)
+            CLOSE_SOCKET(sock);
+    server.Stop();
+    serverThread.join();
+
+    if (failed)
+        std::fprintf(stderr, "  %d client operations failed\n", failed.load());
+
+    double conns = double(CLIENT_THREADS) * connsPerThread;
+    double pkts = conns * (pktsPerConn / PIPELINE_WINDOW * PIPELINE_WINDOW);
+    return {conns / connSec, pkts / pktSec, stats};
+}
+
+int main(int argc, char **argv)
+{
+    int maxThreads = argc > 1 ? std::atoi(argv[1]) : (int)std::max(1u, std::thread::hardware_concurrency());
+    int connsPerThread = argc > 2 ? std::atoi(argv[2]) : 250;
+    int pktsPerConn = argc > 3 ? std::atoi(argv[3]) : 256;
+
+    Logger::init("", LogLevel::ERROR, true);
+
+    std::printf("%-10s %15s %15s %15s %15s\n", "reactors", "conn/s", "pkt/s", "frames/send", "sends saved");
+    for (int n = 1; n <= maxThreads; n *= 2)
+    {
+        Result r = RunOnce(n, connsPerThread, pktsPerConn);
+        double perCall = r.stats.sendCalls ? double(r.stats.framesSent) / r.stats.sendCalls : 0;
+        std::printf("%-10d %15.0f %15.0f %15.2f %15llu\n", n, r.connPerSec, r.pktPerSec, perCall,
+                    (unsigned long long)r.stats.syscallsSaved);
+        if (n < maxThreads && n * 2 > maxThreads)
+            n = maxThreads / 2; // 保证最后一轮测到 maxThreads
+    }
+
+    TimeTools::ReleaseInstance();
+    Logger::shutdown();
+    return 0;
+}
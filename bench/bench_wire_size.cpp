@@ -0,0 +1,137 @@
+// 线路格式体积测试：标准格式 vs 紧凑格式（键字典 + varint），按 MsgType 列出典型消息的负载与帧大小
+//
+// 用法：bench_wire_size [转换次数]
+// 帧大小含帧头与 AEAD tag，即加密会话上单条消息实际写入 Socket 的字节数。
+// 最后给出紧凑格式双向转换的耗时（服务端每收发一条消息各转换一次）。
+
+#include "BenchUtil.h"
+#include "CompactCodec.h"
+#include "Message.h"
+
+#include <cstdlib>
+#include <string>
+
+struct Sample
+{
+    const char *name;
+    Packet packet;
+};
+
+template <typename M>
+static Sample Make(const char *name, MsgType type, const M &msg)
+{
+    return {name, Packet::Of(1, type, msg)};
+}
+
+static std::vector<Sample> BuildSamples()
+{
+    std::vector<Sample> samples;
+    samples.push_back({"None (heartbeat)", Packet(1, MsgType::None)});
+
+    CredentialsMsg credentials;
+    credentials.username = "alice";
+    credentials.password = "secret123";
+    samples.push_back(Make("Login req", MsgType::Login, credentials));
+    AccountMsg account;
+    account.username = "alice";
+    account.rating = 1500;
+    samples.push_back(Make("Login resp", MsgType::Login, account));
+
+    JoinRoomMsg join;
+    join.roomId = 12;
+    samples.push_back(Make("JoinRoom req", MsgType::JoinRoom, join));
+    JoinRoomResultMsg joined;
+    joined.roomId = 12;
+    samples.push_back(Make("JoinRoom resp", MsgType::JoinRoom, joined));
+
+    RoomListMsg rooms;
+    rooms.roomList = "12:alice:1/2;13:bob:2/2;14:carol:1/2";
+    rooms.count = 3;
+    samples.push_back(Make("updateRoomsToLobby", MsgType::updateRoomsToLobby, rooms));
+
+    SeatMsg seat;
+    seat.P1 = "alice";
+    seat.P2 = "bob";
+    samples.push_back(Make("SyncSeat push", MsgType::SyncSeat, seat));
+
+    ChatPushMsg chat;
+    chat.roomId = 12;
+    chat.userId = 1001;
+    chat.message = "good game";
+    samples.push_back(Make("ChatMessage push", MsgType::ChatMessage, chat));
+
+    RoomCreatedMsg created;
+    created.roomId = 12;
+    created.userId = 1001;
+    samples.push_back(Make("SyncGame push", MsgType::SyncGame, created));
+
+    MoveMsg move;
+    move.x = 7;
+    move.y = 8;
+    samples.push_back(Make("MakeMove req/push", MsgType::MakeMove, move));
+    MoveResultMsg moved;
+    moved.x = 7;
+    moved.y = 8;
+    samples.push_back(Make("MakeMove resp", MsgType::MakeMove, moved));
+
+    NegotiateMsg draw;
+    samples.push_back(Make("Draw req/push", MsgType::Draw, draw));
+
+    GameEndedMsg ended;
+    ended.roomId = 12;
+    ended.winnerId = 1001;
+    ended.msg = "five in a row";
+    samples.push_back(Make("GameEnded push", MsgType::GameEnded, ended));
+
+    ErrorMsg error;
+    error.error = "Room not found";
+    samples.push_back(Make("Error", MsgType::Error, error));
+    return samples;
+}
+
+int main(int argc, char **argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    const size_t overhead = sizeof(Frame::Header) + AEAD_TAG_SIZE;
+
+    std::vector<Sample> samples = BuildSamples();
+    std::printf("%-20s %9s %9s %7s   %9s %9s %7s\n", "message", "standard", "compact", "saved", "frame", "frame'", "saved");
+    for (const Sample &s : samples)
+    {
+        size_t standard = s.packet.ToBytes().size();
+        size_t compact = s.packet.ToBytes(WireFormat::Compact).size();
+        std::printf("%-20s %8zuB %8zuB %6.1f%%   %8zuB %8zuB %6.1f%%\n", s.name, standard, compact,
+                    100.0 * (standard - compact) / standard, standard + overhead, compact + overhead,
+                    100.0 * (standard - compact) / (standard + overhead));
+    }
+
+    MoveMsg move;
+    move.x = 7;
+    move.y = 8;
+    const std::vector<uint8_t> standard = Packet::Of(1, MsgType::MakeMove, move).ToBytes();
+    const std::vector<uint8_t> compact = Packet::Of(1, MsgType::MakeMove, move).ToBytes(WireFormat::Compact);
+
+    std::printf("\nMakeMove transcoding\n");
+    uint64_t check = 0;
+    uint64_t start = GetTimeUS();
+    for (int i = 0; i < count; i++)
+    {
+        std::vector<uint8_t> out;
+        CompactEncode(standard.data(), standard.size(), out);
+        check += out.size();
+    }
+    double sec = ElapsedSec(start);
+    std::printf("  %-22s %10.1f ns/op   (check %llu)\n", "standard -> compact", sec * 1e9 / count, (unsigned long long)check);
+
+    check = 0;
+    start = GetTimeUS();
+    for (int i = 0; i < count; i++)
+    {
+        std::vector<uint8_t> out;
+        CompactDecode(compact.data(), compact.size(), out);
+        check += out.size();
+    }
+    sec = ElapsedSec(start);
+    std::printf("  %-22s %10.1f ns/op   (check %llu)\n", "compact -> standard", sec * 1e9 / count, (unsigned long long)check);
+    return 0;
+}
@@ -0,0 +1,291 @@
+#include "CompactCodec.h"
+#include "Message.h"
+
+// 按使用频率排列；只能在末尾追加
+static const std::string_view compactKeys[] = {
+    "msgType", "x", "y", "roomId", "userId", "success", "error", "username",
+    "password", "rating", "message", "status", "boardSize", "count", "maxCount", "userList",
+    "roomList", "P1", "P2", "action", "negStatus", "playerCount", "playerListStr", "statusStr",
+    "winnerId", "msg", "requestId"};
+static constexpr size_t compactKeyCount = sizeof(compactKeys) / sizeof(compactKeys[0]);
+static_assert(compactKeyCount <= COMPACT_MAX_KEY_ID, "键字典超出 5 bit 编号");
+
+template <typename Out>
+static void PutVarint(Out &out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        WirePutByte(out, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    WirePutByte(out, (uint8_t)value);
+}
+
+static size_t VarintSize(uint64_t value)
+{
+    size_t size = 1;
+    for (; value >= 0x80; value >>= 7)
+        size++;
+    return size;
+}
+
+static bool GetVarint(const uint8_t *data, size_t len, size_t &offset, uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && offset < len; shift += 7)
+    {
+        uint8_t byte = data[offset++];
+        // 第 10 个字节只能剩 1 bit
+        if (shift == 63 && byte > 1)
+            return false;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static bool GetVarint32(const uint8_t *data, size_t len, size_t &offset, uint32_t &value)
+{
+    uint64_t v = 0;
+    if (!GetVarint(data, len, offset, v) || v > UINT32_MAX)
+        return false;
+    value = (uint32_t)v;
+    return true;
+}
+
+size_t CompactKeyId(std::string_view key)
+{
+    for (size_t i = 0; i < compactKeyCount; i++)
+    {
+        if (compactKeys[i] == key)
+            return i + 1;
+    }
+    return 0;
+}
+
+static bool EncodeValue(uint8_t index, const uint8_t *data, size_t len, size_t &offset, WireWriter &out)
+{
+    switch (index)
+    {
+    case 0: // int：zigzag 后小的负数也只占 1 字节
+    {
+        uint32_t raw = 0;
+        if (!WireGetU32(data, len, offset, raw))
+            return false;
+        uint32_t zigzag = (raw << 1) ^ (uint32_t)((int32_t)raw >> 31);
+        PutVarint(out, zigzag);
+        return true;
+    }
+    case 1: // uint8_t
+    case 5: // bool
+        if (offset >= len)
+            return false;
+        WirePutByte(out, data[offset++]);
+        return true;
+    case 2: // uint32_t
+    {
+        uint32_t value = 0;
+        if (!WireGetU32(data, len, offset, value))
+            return false;
+        PutVarint(out, value);
+        return true;
+    }
+    case 3: // uint64_t
+    {
+        uint64_t value = 0;
+        if (offset + 8 > len)
+            return false;
+        std::memcpy(&value, data + offset, 8);
+        offset += 8;
+        PutVarint(out, value);
+        return true;
+    }
+    case 4: // std::string
+    case 6: // std::vector<uint8_t>
+    {
+        uint32_t size = 0;
+        if (!WireGetU32(data, len, offset, size) || size > len - offset)
+            return false;
+        PutVarint(out, size);
+        WireAppend(out, data + offset, size);
+        offset += size;
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+static bool DecodeValue(uint8_t index, const uint8_t *data, size_t len, size_t &offset, std::vector<uint8_t> &out)
+{
+    switch (index)
+    {
+    case 0: // int
+    {
+        uint32_t zigzag = 0;
+        if (!GetVarint32(data, len, offset, zigzag))
+            return false;
+        WirePutU32(out, (zigzag >> 1) ^ (0u - (zigzag & 1)));
+        return true;
+    }
+    case 1: // uint8_t
+    case 5: // bool
+        if (offset >= len)
+            return false;
+        out.push_back(data[offset++]);
+        return true;
+    case 2: // uint32_t
+    {
+        uint32_t value = 0;
+        if (!GetVarint32(data, len, offset, value))
+            return false;
+        WirePutU32(out, value);
+        return true;
+    }
+    case 3: // uint64_t
+    {
+        uint64_t value = 0;
+        if (!GetVarint(data, len, offset, value))
+            return false;
+        WirePutValue(out, value);
+        return true;
+    }
+    case 4: // std::string
+    case 6: // std::vector<uint8_t>
+    {
+        uint32_t size = 0;
+        if (!GetVarint32(data, len, offset, size) || size > len - offset)
+            return false;
+        WirePutU32(out, size);
+        out.insert(out.end(), data + offset, data + offset + size);
+        offset += size;
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+bool CompactEncode(const uint8_t *data, size_t len, WireWriter &out)
+{
+    size_t offset = 0;
+    uint32_t type = 0, count = 0;
+    if (!WireGetU32(data, len, offset, type) || !WireGetU32(data, len, offset, count))
+        return false;
+    PutVarint(out, type);
+    // 字段数需扣除 msgType，遍历完才知道：先占 1 字节，超过 127 个字段时再把字段整体后移
+    size_t countPos = out.size;
+    WirePutByte(out, 0);
+
+    uint32_t written = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        std::string_view key;
+        if (!WireGetKey(data, len, offset, key) || offset >= len)
+            return false;
+        uint8_t index = data[offset++];
+        if (index >= std::variant_size_v<ValueType>)
+            return false;
+        // msgType 字段与头部重复，不上线路
+        if (key == "msgType")
+        {
+            if (!WireSkipValue(index, data, len, offset))
+                return false;
+            continue;
+        }
+
+        size_t id = CompactKeyId(key);
+        WirePutByte(out, (uint8_t)(id << 3 | index));
+        if (id == 0)
+        {
+            PutVarint(out, key.size());
+            WireAppend(out, key.data(), key.size());
+        }
+        if (!EncodeValue(index, data, len, offset, out))
+            return false;
+        written++;
+    }
+
+    size_t extra = VarintSize(written) - 1;
+    if (out.data)
+    {
+        size_t fieldsPos = countPos + 1;
+        if (extra > 0)
+            std::memmove(out.data + fieldsPos + extra, out.data + fieldsPos, out.size - fieldsPos);
+        WireWriter count{out.data, countPos};
+        PutVarint(count, written);
+    }
+    out.size += extra;
+    return true;
+}
+
+bool CompactEncode(const uint8_t *data, size_t len, std::vector<uint8_t> &out)
+{
+    WireWriter counter;
+    if (!CompactEncode(data, len, counter))
+        return false;
+    size_t base = out.size();
+    out.resize(base + counter.size);
+    WireWriter writer{out.data() + base};
+    return CompactEncode(data, len, writer);
+}
+
+bool CompactDecode(const uint8_t *data, size_t len, std::vector<uint8_t> &out)
+{
+    size_t offset = 0;
+    uint32_t type = 0, count = 0;
+    // 每个字段至少 2 字节，字段数不可能超过剩余长度
+    if (!GetVarint32(data, len, offset, type) || !GetVarint32(data, len, offset, count) || count > len - offset)
+        return false;
+    // 短消息以键名为主，展开后约为 4 倍；长字符串为主时接近原长
+    out.reserve(out.size() + len * 4 + 32);
+    WirePutU32(out, type);
+    WirePutU32(out, count + 1);
+
+    const std::string_view msgTypeKey = "msgType";
+    bool msgTypeWritten = false;
+    std::string_view previous;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (offset >= len)
+            return false;
+        uint8_t tag = data[offset++];
+        size_t id = tag >> 3;
+        uint8_t index = tag & 7;
+
+        std::string_view key;
+        if (id == 0)
+        {
+            uint32_t size = 0;
+            if (!GetVarint32(data, len, offset, size) || size > len - offset)
+                return false;
+            key = std::string_view(reinterpret_cast<const char *>(data + offset), size);
+            offset += size;
+        }
+        else if (id <= compactKeyCount)
+            key = compactKeys[id - 1];
+        else
+            return false;
+        // 键须严格递增（与标准格式一致），msgType 才能按序插回；乱序或重复的键视为非法
+        if (key == msgTypeKey || (i > 0 && !(previous < key)))
+            return false;
+        previous = key;
+
+        if (!msgTypeWritten && msgTypeKey < key)
+        {
+            WirePutKey(out, msgTypeKey, WireIndex<uint32_t>());
+            WirePutU32(out, type);
+            msgTypeWritten = true;
+        }
+        WirePutKey(out, key, index);
+        if (!DecodeValue(index, data, len, offset, out))
+            return false;
+    }
+    if (!msgTypeWritten)
+    {
+        WirePutKey(out, msgTypeKey, WireIndex<uint32_t>());
+        WirePutU32(out, type);
+    }
+    return offset == len;
+}
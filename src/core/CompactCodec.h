@@ -0,0 +1,32 @@
+#ifndef COMPACT_CODEC_H
+#define COMPACT_CODEC_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief 紧凑线路格式（WireFormat::Compact），握手时协商启用
+ *
+ * 格式：[msgType varint][字段数 varint] + 字段 * [[键编号 5bit | 值类型索引 3bit][键][值]]
+ * - 键编号为静态字典中的下标加一，字典外的键编号为 0，随后原样携带 [键长度 varint][键]；
+ * - 整数为 LEB128 varint，int 先做 zigzag；uint8_t、bool 占 1 字节；字符串与字节数组为 [长度 varint][内容]；
+ * - 字段按键名严格递增排列（标准格式由 std::map 与类型化消息按同一顺序写出），乱序或重复的键解码失败；
+ * - 不携带 msgType 字段，解码时按头部的 msgType 补回到按键名排序的位置。
+ * 与标准格式逐字段互相转换、顺序不变，上层（Packet、PacketView、类型化消息）只处理标准格式。
+ * 字典只能在末尾追加，已分配的编号不能改动。
+ */
+
+#define COMPACT_MAX_KEY_ID 31 // 键编号占 5 bit
+
+size_t CompactKeyId(std::string_view key); // 不在字典中返回 0
+
+struct WireWriter;
+
+// 标准格式 -> 紧凑格式 / 紧凑格式 -> 标准格式，结果追加到 out；数据截断或类型索引未知时返回 false。
+// WireWriter 版本用于两遍编码：先以空游标求出长度，再写入调用方预留好的缓冲区
+bool CompactEncode(const uint8_t *data, size_t len, WireWriter &out);
+bool CompactEncode(const uint8_t *data, size_t len, std::vector<uint8_t> &out);
+bool CompactDecode(const uint8_t *data, size_t len, std::vector<uint8_t> &out);
+
+#endif // COMPACT_CODEC_H
@@ -10,10 +10,12 @@ Handler::Handler(ObjectManager &objMgr, std::function<void(const Packet &)> send
 Handler::~Handler() {}
 
 // 分组处理方法实现
-void Handler::HandleAuthPacket(const Packet &packet)
+void Handler::HandleAuthPacket(const PacketView &packet)
 {
-    std::string username = packet.GetParam<std::string>("username");
-    std::string password = packet.GetParam<std::string>("password");
+    CredentialsMsg credentials;
+    packet.As(credentials);
+    const std::string &username = credentials.username;
+    const std::string &password = credentials.password;
     switch (packet.msgType)
     {
     case MsgType::Login:
@@ -35,10 +37,9 @@ void Handler::HandleAuthPacket(const Packet &packet)
 
         LOG_INFO("Login successful for user: " + username + " (ID: " + std::to_string(user->GetID()) + ")");
 
-        MapType response;
-        response["success"] = true;
-        response["username"] = username;
-        response["rating"] = user->GetRanking();
+        AccountMsg response;
+        response.username = username;
+        response.rating = user->GetRanking();
         SendResponse(packet, MsgType::Login, response);
 
         // 发布用户登录事件，触发用户列表广播
@@ -47,24 +48,39 @@ void Handler::HandleAuthPacket(const Packet &packet)
     }
     case MsgType::SignIn:
     {
-        // 业务逻辑：注册新用户
-        User *user = objMgr.CreateUser(username, password);
-        if (!user)
+        // 业务逻辑：注册新用户。写库在 Reactor 之外执行，完成前同一会话的后续请求照常处理，
+        // 响应靠 requestId 与请求对应
+        if (objMgr.GetUserByUsername(username))
         {
             SendError(packet, "Username already exists");
             return;
         }
 
-        objMgr.MapSessionToUser(packet.sessionId, user->GetID());
+        uint64_t sessionId = packet.sessionId;
+        uint32_t requestId = packet.RequestId();
+        auto userId = std::make_shared<uint64_t>(0);
+        RunAsync(
+            sessionId, [userId, username, password]()
+            { *userId = ObjectManager::InsertUser(username, password); },
+            [this, sessionId, requestId, userId, username, password]()
+            {
+                User *user = objMgr.AddUser(*userId, username, password);
+                if (!user)
+                {
+                    SendError(sessionId, requestId, "Username already exists");
+                    return;
+                }
 
-        MapType response;
-        response["success"] = true;
-        response["username"] = username;
-        response["rating"] = user->GetRanking();
-        SendResponse(packet, MsgType::SignIn, response);
+                objMgr.MapSessionToUser(sessionId, user->GetID());
 
-        // 发布用户登录事件，触发用户列表广播
-        EventBus<Event>::GetInstance().Publish(Event::UserLoggedIn, user->GetID());
+                AccountMsg response;
+                response.username = username;
+                response.rating = user->GetRanking();
+                SendResponse(sessionId, requestId, MsgType::SignIn, response);
+
+                // 发布用户登录事件，触发用户列表广播
+                EventBus<Event>::GetInstance().Publish(Event::UserLoggedIn, user->GetID());
+            });
         return;
     }
     case MsgType::LoginAsGuest:
@@ -74,10 +90,9 @@ void Handler::HandleAuthPacket(const Packet &packet)
 
         objMgr.MapSessionToUser(packet.sessionId, guestId);
 
-        MapType response;
-        response["success"] = true;
-        response["username"] = "Guest_" + std::to_string(guestId);
-        response["rating"] = 0; // 默认 rating
+        AccountMsg response;
+        response.username = "Guest_" + std::to_string(guestId);
+        response.rating = 0; // 默认 rating
         SendResponse(packet, MsgType::LoginAsGuest, response);
 
         // 发布用户登录事件，触发用户列表广播
@@ -91,9 +106,7 @@ void Handler::HandleAuthPacket(const Packet &packet)
         if (userId != 0)
             objMgr.UnmapSession(packet.sessionId);
 
-        MapType response;
-        response["success"] = true;
-        SendResponse(packet, MsgType::LogOut, response);
+        SendResponse(packet, MsgType::LogOut, ResultMsg());
         return;
     }
     default:
@@ -103,7 +116,7 @@ void Handler::HandleAuthPacket(const Packet &packet)
     }
 }
 
-void Handler::HandleLobbyPacket(const Packet &packet)
+void Handler::HandleLobbyPacket(const PacketView &packet)
 {
     switch (packet.msgType)
     {
@@ -142,8 +155,8 @@ void Handler::HandleLobbyPacket(const Packet &packet)
         LOG_INFO("Room created successfully: roomId=" + std::to_string(room->GetRoomId()) +
                  ", ownerId=" + std::to_string(user->GetID()));
 
-        MapType response;
-        response["roomId"] = uint64_t(room->GetRoomId());
+        RoomMsg response;
+        response.roomId = room->GetRoomId();
         SendResponse(packet, MsgType::CreateRoom, response);
 
         // 发布房间创建事件，触发广播
@@ -162,7 +175,9 @@ void Handler::HandleLobbyPacket(const Packet &packet)
             return;
         }
 
-        uint32_t roomId = packet.GetParam<uint32_t>("roomId");
+        JoinRoomMsg request;
+        packet.As(request);
+        uint32_t roomId = request.roomId;
         Room *room = objMgr.GetRoom(roomId);
         if (!room)
         {
@@ -181,9 +196,8 @@ void Handler::HandleLobbyPacket(const Packet &packet)
         objMgr.MapUserToRoom(user->GetID(), roomId);
 
         // 发送加入房间响应
-        MapType response;
-        response["roomId"] = roomId;
-        response["success"] = true;
+        JoinRoomResultMsg response;
+        response.roomId = roomId;
         SendResponse(packet, MsgType::JoinRoom, response);
 
         // 发布玩家加入事件（广播给其他玩家）
@@ -207,7 +221,9 @@ void Handler::HandleLobbyPacket(const Packet &packet)
     case MsgType::updateUsersToLobby:
     {
         // 获取最大数量参数，默认为10
-        size_t maxCount = packet.GetParam<uint32_t>("maxCount", 10);
+        ListQueryMsg query;
+        packet.As(query);
+        size_t maxCount = query.maxCount;
 
         // 从 ObjectManager 获取用户列表
         std::vector<User *> userList = objMgr.GetUserList(maxCount);
@@ -235,16 +251,18 @@ void Handler::HandleLobbyPacket(const Packet &packet)
 
         LOG_DEBUG("User list requested, returning " + std::to_string(userList.size()) + " users");
 
-        MapType response;
-        response["userList"] = userListStr;
-        response["count"] = uint32_t(userList.size());
+        UserListMsg response;
+        response.userList = userListStr;
+        response.count = uint32_t(userList.size());
         SendResponse(packet, MsgType::updateUsersToLobby, response);
         return;
     }
     case MsgType::updateRoomsToLobby:
     {
         // 获取最大数量参数，默认为10
-        size_t maxCount = packet.GetParam<uint32_t>("maxCount", 10);
+        ListQueryMsg query;
+        packet.As(query);
+        size_t maxCount = query.maxCount;
 
         // 从 ObjectManager 获取房间列表
         std::vector<Room *> roomList = objMgr.GetRoomList(maxCount);
@@ -311,9 +329,9 @@ void Handler::HandleLobbyPacket(const Packet &packet)
 
         LOG_DEBUG("Room list requested, returning " + std::to_string(roomList.size()) + " rooms");
 
-        MapType response;
-        response["roomList"] = roomListStr;
-        response["count"] = uint32_t(roomList.size());
+        RoomListMsg response;
+        response.roomList = roomListStr;
+        response.count = uint32_t(roomList.size());
         SendResponse(packet, MsgType::updateRoomsToLobby, response);
         return;
     }
@@ -324,7 +342,7 @@ void Handler::HandleLobbyPacket(const Packet &packet)
     }
 }
 
-void Handler::HandleRoomPacket(const Packet &packet)
+void Handler::HandleRoomPacket(const PacketView &packet)
 {
     switch (packet.msgType)
     {
@@ -353,11 +371,11 @@ void Handler::HandleRoomPacket(const Packet &packet)
             return;
         }
 
-        std::string blackUsername = packet.GetParam<std::string>("P1", "");
-        std::string whiteUsername = packet.GetParam<std::string>("P2", "");
+        SeatMsg seat;
+        packet.As(seat);
 
-        User *blackUser = objMgr.GetUserByUsername(blackUsername);
-        User *whiteUser = objMgr.GetUserByUsername(whiteUsername);
+        User *blackUser = objMgr.GetUserByUsername(seat.P1);
+        User *whiteUser = objMgr.GetUserByUsername(seat.P2);
 
         if (!room->SyncSeat(user->GetID(),
                             blackUser ? blackUser->GetID() : 0,
@@ -367,9 +385,7 @@ void Handler::HandleRoomPacket(const Packet &packet)
             return;
         }
 
-        MapType response;
-        response["success"] = true;
-        SendResponse(packet, MsgType::SyncSeat, response);
+        SendResponse(packet, MsgType::SyncSeat, ResultMsg());
         return;
     }
     case MsgType::SyncRoomSetting:
@@ -396,16 +412,14 @@ void Handler::HandleRoomPacket(const Packet &packet)
             return;
         }
 
-        // 直接使用packet.params而不是GetParams()
-        if (!room->EditRoomSetting(user->GetID(), packet.params))
+        // 房间设置是开放的字段表，仍按 map 解析
+        if (!room->EditRoomSetting(user->GetID(), packet.ToParams()))
         {
             SendError(packet, "Failed to edit room setting: " + room->GetError());
             return;
         }
 
-        MapType response;
-        response["success"] = true;
-        SendResponse(packet, MsgType::SyncRoomSetting, response);
+        SendResponse(packet, MsgType::SyncRoomSetting, ResultMsg());
         return;
     }
     case MsgType::ChatMessage:
@@ -425,7 +439,9 @@ void Handler::HandleRoomPacket(const Packet &packet)
             return;
         }
 
-        std::string message = packet.GetParam<std::string>("message");
+        ChatMsg chat;
+        packet.As(chat);
+        std::string &message = chat.message;
 
         Room *room = objMgr.GetRoom(roomId);
         if (!room)
@@ -435,9 +451,7 @@ void Handler::HandleRoomPacket(const Packet &packet)
         }
 
         // 发送聊天消息响应
-        MapType response;
-        response["success"] = true;
-        SendResponse(packet, MsgType::ChatMessage, response);
+        SendResponse(packet, MsgType::ChatMessage, ResultMsg());
 
         // 发布聊天消息接收事件，Notifier 会处理广播
         EventBus<Event>::GetInstance().Publish(Event::ChatMessageRecv, roomId, user->GetID(), message);
@@ -492,8 +506,8 @@ void Handler::HandleRoomPacket(const Packet &packet)
                 playerListStr += ", ";
         }
 
-        MapType response;
-        response["playerListStr"] = playerListStr;
+        PlayerListMsg response;
+        response.playerListStr = playerListStr;
         SendResponse(packet, MsgType::SyncUsersToRoom, response);
         return;
     }
@@ -512,9 +526,7 @@ void Handler::HandleRoomPacket(const Packet &packet)
         // 从房间映射中移除用户
         objMgr.UnmapUserFromRoom(user->GetID());
 
-        MapType response;
-        response["success"] = true;
-        SendResponse(packet, MsgType::ExitRoom, response);
+        SendResponse(packet, MsgType::ExitRoom, ResultMsg());
 
         // 发布玩家离开事件（事件驱动架构）
         EventBus<Event>::GetInstance().Publish(Event::PlayerLeft, roomId, user->GetID());
@@ -527,7 +539,7 @@ void Handler::HandleRoomPacket(const Packet &packet)
     }
 }
 
-void Handler::HandleGamePacket(const Packet &packet)
+void Handler::HandleGamePacket(const PacketView &packet)
 {
     switch (packet.msgType)
     {
@@ -562,9 +574,7 @@ void Handler::HandleGamePacket(const Packet &packet)
             return;
         }
 
-        MapType response;
-        response["success"] = true;
-        SendResponse(packet, MsgType::GameStarted, response);
+        SendResponse(packet, MsgType::GameStarted, ResultMsg());
         return;
     }
     case MsgType::GameEnded:
@@ -592,8 +602,10 @@ void Handler::HandleGamePacket(const Packet &packet)
             return;
         }
 
-        uint32_t x = packet.GetParam<uint32_t>("x");
-        uint32_t y = packet.GetParam<uint32_t>("y");
+        MoveMsg move;
+        packet.As(move);
+        uint32_t x = move.x;
+        uint32_t y = move.y;
 
         LOG_DEBUG("Make move request: userId=" + std::to_string(user->GetID()) +
                   ", roomId=" + std::to_string(roomId) +
@@ -623,10 +635,9 @@ void Handler::HandleGamePacket(const Packet &packet)
                  ", position=(" + std::to_string(x) + "," + std::to_string(y) + ")");
 
         // 发送落子响应
-        MapType response;
-        response["x"] = x;
-        response["y"] = y;
-        response["success"] = true;
+        MoveResultMsg response;
+        response.x = x;
+        response.y = y;
         SendResponse(packet, MsgType::MakeMove, response);
         return;
     }
@@ -661,9 +672,7 @@ void Handler::HandleGamePacket(const Packet &packet)
             return;
         }
 
-        MapType response;
-        response["success"] = true;
-        SendResponse(packet, MsgType::GiveUp, response);
+        SendResponse(packet, MsgType::GiveUp, ResultMsg());
         return;
     }
     case MsgType::Draw:
@@ -691,7 +700,9 @@ void Handler::HandleGamePacket(const Packet &packet)
         }
 
         // 获取协商状态参数
-        NegStatus negStatus = static_cast<NegStatus>(packet.GetParam<uint8_t>("negStatus", static_cast<uint8_t>(NegStatus::Ask)));
+        NegotiateMsg negotiate;
+        packet.As(negotiate);
+        NegStatus negStatus = static_cast<NegStatus>(negotiate.negStatus);
 
         // 根据协商状态处理平局请求
         bool success = false;
@@ -720,9 +731,9 @@ void Handler::HandleGamePacket(const Packet &packet)
             return;
         }
 
-        MapType response;
-        response["success"] = success;
-        response["negStatus"] = static_cast<uint8_t>(negStatus);
+        NegotiateResultMsg response;
+        response.success = success;
+        response.negStatus = static_cast<uint8_t>(negStatus);
         SendResponse(packet, MsgType::Draw, response);
         return;
     }
@@ -751,7 +762,9 @@ void Handler::HandleGamePacket(const Packet &packet)
         }
 
         // 获取协商状态参数
-        NegStatus negStatus = static_cast<NegStatus>(packet.GetParam<uint8_t>("negStatus", static_cast<uint8_t>(NegStatus::Ask)));
+        NegotiateMsg negotiate;
+        packet.As(negotiate);
+        NegStatus negStatus = static_cast<NegStatus>(negotiate.negStatus);
 
         // 根据协商状态处理悔棋请求
         bool success = false;
@@ -779,9 +792,9 @@ void Handler::HandleGamePacket(const Packet &packet)
             return;
         }
 
-        MapType response;
-        response["success"] = success;
-        response["negStatus"] = static_cast<uint8_t>(negStatus);
+        NegotiateResultMsg response;
+        response.success = success;
+        response.negStatus = static_cast<uint8_t>(negStatus);
         SendResponse(packet, MsgType::UndoMove, response);
         return;
     }
@@ -829,9 +842,8 @@ void Handler::HandleGamePacket(const Packet &packet)
             statusStr = "unknown";
         }
 
-        MapType response;
-        response["success"] = true;
-        response["statusStr"] = statusStr;
+        GameStatusMsg response;
+        response.statusStr = statusStr;
         SendResponse(packet, MsgType::SyncGame, response);
         return;
     }
@@ -842,8 +854,11 @@ void Handler::HandleGamePacket(const Packet &packet)
     }
 }
 
-void Handler::HandlePacket(const Packet &packet)
+void Handler::HandlePacket(const Packet &request)
 {
+    // 字段在帧负载上原地读取，心跳、落子、加入房间等请求的解析与分发不分配内存；
+    // 结构已在 Packet::FromData 中校验，As 只会为缺失的字段保留默认值
+    PacketView packet = request.View();
     if (packet.msgType == MsgType::None)
     {
         LOG_TRACE("HeartBeat");
@@ -880,11 +895,17 @@ void Handler::HandlePacket(const Packet &packet)
 
 // --- 辅助函数 ---
 
-void Handler::SendResponse(const Packet &request, MsgType responseType, const MapType &params)
+template <typename M>
+void Handler::SendResponse(const PacketView &request, MsgType responseType, const M &msg)
+{
+    SendResponse(request.sessionId, request.RequestId(), responseType, msg);
+}
+
+template <typename M>
+void Handler::SendResponse(uint64_t sessionId, uint32_t requestId, MsgType responseType, const M &msg)
 {
-    // 创建响应包（事件驱动架构，不需要requestId）
-    Packet response(request.sessionId, responseType);
-    response.params = params;
+    // 创建响应包，字段直接编码，不经过 map；请求带有 requestId 时原样带回
+    Packet response = Packet::Of(sessionId, responseType, msg, requestId);
     LOG_DEBUG("Sending response: msgType=" + std::to_string((int)responseType));
     if (sendCallback)
     {
@@ -896,11 +917,17 @@ void Handler::SendResponse(const Packet &request, MsgType responseType, const Ma
     }
 }
 
-void Handler::SendError(const Packet &request, const std::string &errMsg)
+void Handler::SendError(const PacketView &request, const std::string &errMsg)
 {
-    // 错误响应（事件驱动架构，不需要requestId）
-    Packet errPacket(request.sessionId, MsgType::Error);
-    errPacket.AddParam("error", errMsg);
+    SendError(request.sessionId, request.RequestId(), errMsg);
+}
+
+void Handler::SendError(uint64_t sessionId, uint32_t requestId, const std::string &errMsg)
+{
+    // 错误响应同样带回 requestId，客户端据此判断是哪个请求失败
+    ErrorMsg error;
+    error.error = errMsg;
+    Packet errPacket = Packet::Of(sessionId, MsgType::Error, error, requestId);
     LOG_WARN("[Handler] Sending error: " + errMsg);
     if (sendCallback)
     {
@@ -912,6 +939,22 @@ void Handler::SendError(const Packet &request, const std::string &errMsg)
     }
 }
 
+void Handler::RunAsync(uint64_t sessionId, std::function<void()> work, std::function<void()> done)
+{
+    if (asyncCallback)
+    {
+        asyncCallback(sessionId, std::move(work), std::move(done));
+        return;
+    }
+    work();
+    done();
+}
+
+void Handler::SetAsyncCallback(std::function<void(uint64_t, std::function<void()>, std::function<void()>)> cb)
+{
+    asyncCallback = cb;
+}
+
 // --- 房间状态发送辅助函数 ---
 
 void Handler::SendBoardState(uint64_t sessionId, Room *room)
@@ -920,9 +963,10 @@ void Handler::SendBoardState(uint64_t sessionId, Room *room)
         return;
 
     // 创建棋盘状态推送包 - 使用 SyncGame
-    Packet boardStatePush(sessionId, MsgType::SyncGame);
-    boardStatePush.AddParam("roomId", room->GetRoomId());
-    boardStatePush.AddParam("boardSize", (uint32_t)15); // TODO: 从room获取实际棋盘大小
+    BoardStateMsg boardState;
+    boardState.roomId = room->GetRoomId();
+    boardState.boardSize = 15; // TODO: 从room获取实际棋盘大小
+    Packet boardStatePush = Packet::Of(sessionId, MsgType::SyncGame, boardState);
 
     // TODO: 添加棋盘数据序列化
     // 目前先发送空棋盘状态
@@ -942,9 +986,10 @@ void Handler::SendPlayerList(uint64_t sessionId, Room *room)
         return;
 
     // 创建玩家列表推送包 - 使用 SyncUsersToRoom
-    Packet playerListPush(sessionId, MsgType::SyncUsersToRoom);
-    playerListPush.AddParam("roomId", room->GetRoomId());
-    playerListPush.AddParam("playerCount", (uint32_t)room->playerIds.size());
+    PlayerCountMsg playerCount;
+    playerCount.roomId = room->GetRoomId();
+    playerCount.playerCount = (uint32_t)room->playerIds.size();
+    Packet playerListPush = Packet::Of(sessionId, MsgType::SyncUsersToRoom, playerCount);
 
     // 添加玩家ID列表
     // TODO: 需要将玩家ID列表序列化为数组
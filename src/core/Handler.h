@@ -2,6 +2,7 @@
 #define HANDLER_H
 
 #include "Packet.h"
+#include "PacketView.h"
 #include "EventBus.hpp"
 #include <memory>
 #include <functional>
@@ -15,19 +16,27 @@ class Handler
 private:
     ObjectManager &objMgr;
     std::function<void(const Packet &)> sendCallback;
+    // 异步执行：work 在 Reactor 之外运行，done 随后在逻辑锁内运行；未设置时两者依次同步执行
+    std::function<void(uint64_t, std::function<void()>, std::function<void()>)> asyncCallback;
 
     // 分组处理方法 - 按MsgType分段
-    void HandleAuthPacket(const Packet &packet);         // 100-199: 账户操作
-    void HandleLobbyPacket(const Packet &packet);        // 200-299: 大厅操作
-    void HandleRoomPacket(const Packet &packet);         // 300-399: 房间操作
-    void HandleGamePacket(const Packet &packet);         // 400-499: 游戏操作
-    void HandleNotificationPacket(const Packet &packet); // 推送消息
+    void HandleAuthPacket(const PacketView &packet);         // 100-199: 账户操作
+    void HandleLobbyPacket(const PacketView &packet);        // 200-299: 大厅操作
+    void HandleRoomPacket(const PacketView &packet);         // 300-399: 房间操作
+    void HandleGamePacket(const PacketView &packet);         // 400-499: 游戏操作
+    void HandleNotificationPacket(const PacketView &packet); // 推送消息
 
     // 辅助函数（暂时保留，后续改为事件发布）
     User *GetUserBySessionId(uint64_t sessionId);
     uint64_t GetUserRoomId(User *user);
-    void SendResponse(const Packet &request, MsgType responseType, const MapType &params = {});
-    void SendError(const Packet &request, const std::string &errMsg);
+    // 响应与错误都带回请求中的 requestId；异步完成时请求视图已失效，用显式的 sessionId 与 requestId
+    template <typename M>
+    void SendResponse(const PacketView &request, MsgType responseType, const M &msg); // M 为 Message.h 中的消息类型
+    template <typename M>
+    void SendResponse(uint64_t sessionId, uint32_t requestId, MsgType responseType, const M &msg);
+    void SendError(const PacketView &request, const std::string &errMsg);
+    void SendError(uint64_t sessionId, uint32_t requestId, const std::string &errMsg);
+    void RunAsync(uint64_t sessionId, std::function<void()> work, std::function<void()> done);
 
     // 房间状态发送辅助函数
     void SendRoomStateToPlayer(uint64_t sessionId, Room *room);
@@ -40,6 +49,8 @@ public:
     ~Handler();
 
     void HandlePacket(const Packet &packet);
+    // 注册异步执行回调（Server::RunAsync），注册后写库等耗时请求不阻塞 Reactor，可晚于后续请求完成
+    void SetAsyncCallback(std::function<void(uint64_t, std::function<void()>, std::function<void()>)> cb);
 };
 
 #endif
@@ -0,0 +1,54 @@
+#include "Message.h"
+
+bool WireGetU32(const uint8_t *data, size_t len, size_t &offset, uint32_t &value)
+{
+    if (offset + 4 > len)
+        return false;
+    std::memcpy(&value, data + offset, 4);
+    offset += 4;
+    return true;
+}
+
+bool WireGetKey(const uint8_t *data, size_t len, size_t &offset, std::string_view &key)
+{
+    uint32_t size = 0;
+    if (!WireGetU32(data, len, offset, size) || size > len - offset)
+        return false;
+    key = std::string_view(reinterpret_cast<const char *>(data + offset), size);
+    offset += size;
+    return true;
+}
+
+bool WireSkipValue(uint8_t index, const uint8_t *data, size_t len, size_t &offset)
+{
+    size_t size = 0;
+    switch (index)
+    {
+    case 0: // int
+    case 2: // uint32_t
+        size = 4;
+        break;
+    case 1: // uint8_t
+    case 5: // bool
+        size = 1;
+        break;
+    case 3: // uint64_t
+        size = 8;
+        break;
+    case 4: // std::string
+    case 6: // std::vector<uint8_t>
+    {
+        uint32_t n = 0;
+        if (!WireGetU32(data, len, offset, n))
+            return false;
+        size = n;
+        break;
+    }
+    default:
+        return false;
+    }
+    if (size > len - offset)
+        return false;
+    offset += size;
+    return true;
+}
@@ -0,0 +1,647 @@
+#ifndef MESSAGE_H
+#define MESSAGE_H
+
+#include "Packet.h"
+
+#include <array>
+#include <cstring>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+/**
+ * @brief 类型化消息：由编译期字段表直接编解码，不经过 MapType
+ *
+ * 每个消息结构体以静态函数 Fields() 给出字段表（键名 + 成员指针），
+ * 编码时按键名字节序输出并补上 msgType 键（以及非零的 requestId 键），与 Packet 由 std::map 序列化出的字节完全一致；
+ * 解码时接受任意顺序，未知键跳过，缺失的字段保留结构体中的默认值，与 GetParam 的默认值语义一致。
+ * 字段类型限于 ValueType 中的类型。
+ */
+
+template <typename M, typename T>
+struct FieldDef
+{
+    std::string_view key;
+    T M::*member;
+};
+
+template <typename M, typename T>
+constexpr FieldDef<M, T> Field(std::string_view key, T M::*member)
+{
+    return {key, member};
+}
+
+// 字段类型在 ValueType 中的下标，即线路上的类型索引
+template <typename T, size_t I = 0>
+constexpr uint8_t WireIndex()
+{
+    static_assert(I < std::variant_size_v<ValueType>, "字段类型不在 ValueType 中");
+    if constexpr (std::is_same_v<T, std::variant_alternative_t<I, ValueType>>)
+        return (uint8_t)I;
+    else
+        return WireIndex<T, I + 1>();
+}
+
+/**
+ * @brief 写入预留好的缓冲区的输出游标，用于两遍编码
+ *
+ * data 为空时只累计长度：第一遍求出确切字节数，调用方据此预留空间后再以同样的调用写入，
+ * 中间不经过任何临时缓冲区。写入时不检查边界，由第一遍的长度保证。
+ */
+struct WireWriter
+{
+    uint8_t *data = nullptr;
+    size_t size = 0;
+};
+
+// 线路格式的底层写入（小端序），Packet、类型化消息与紧凑格式共用；out 为 std::vector<uint8_t> 或 WireWriter
+inline void WireAppend(std::vector<uint8_t> &out, const void *bytes, size_t n)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(bytes);
+    out.insert(out.end(), p, p + n);
+}
+
+inline void WireAppend(WireWriter &out, const void *bytes, size_t n)
+{
+    if (out.data && n > 0)
+        std::memcpy(out.data + out.size, bytes, n);
+    out.size += n;
+}
+
+inline void WirePutByte(std::vector<uint8_t> &out, uint8_t byte)
+{
+    out.push_back(byte);
+}
+
+inline void WirePutByte(WireWriter &out, uint8_t byte)
+{
+    if (out.data)
+        out.data[out.size] = byte;
+    out.size++;
+}
+
+template <typename Out>
+void WirePutU32(Out &out, uint32_t value)
+{
+    WireAppend(out, &value, 4);
+}
+
+template <typename Out>
+void WirePutKey(Out &out, std::string_view key, uint8_t index)
+{
+    WirePutU32(out, (uint32_t)key.size());
+    WireAppend(out, key.data(), key.size());
+    WirePutByte(out, index);
+}
+
+template <typename Out, typename T>
+void WirePutValue(Out &out, const T &value)
+{
+    if constexpr (std::is_same_v<T, bool>)
+        WirePutByte(out, value ? 1 : 0);
+    else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::vector<uint8_t>>)
+    {
+        WirePutU32(out, (uint32_t)value.size());
+        WireAppend(out, value.data(), value.size());
+    }
+    else if constexpr (std::is_same_v<T, int>)
+        WirePutU32(out, (uint32_t)value);
+    else
+        WireAppend(out, &value, sizeof(T));
+}
+
+bool WireGetU32(const uint8_t *data, size_t len, size_t &offset, uint32_t &value);
+// 读取键：[长度 4B][键]，key 指向 data 内部
+bool WireGetKey(const uint8_t *data, size_t len, size_t &offset, std::string_view &key);
+// 跳过一个值；类型索引未知或数据截断时返回 false
+bool WireSkipValue(uint8_t index, const uint8_t *data, size_t len, size_t &offset);
+
+// 按字段类型读取一个值。4 字节整数兼容 int 与 uint32_t 两种索引（Packet 反序列化时把 int 读成 uint32_t）；
+// 其余类型不符时跳过该值并保留默认值，与 GetParam 遇到类型不符时的行为一致
+template <typename T>
+bool WireGetValue(uint8_t index, const uint8_t *data, size_t len, size_t &offset, T &value)
+{
+    constexpr uint8_t expected = WireIndex<T>();
+    bool match = index == expected;
+    if constexpr (std::is_same_v<T, uint32_t> || std::is_same_v<T, int>)
+        match = index == WireIndex<int>() || index == WireIndex<uint32_t>();
+    if (!match)
+        return WireSkipValue(index, data, len, offset);
+
+    if constexpr (std::is_same_v<T, bool>)
+    {
+        if (offset + 1 > len)
+            return false;
+        value = data[offset++] != 0;
+    }
+    else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::vector<uint8_t>>)
+    {
+        uint32_t size = 0;
+        if (!WireGetU32(data, len, offset, size) || size > len - offset)
+            return false;
+        value.assign(data + offset, data + offset + size);
+        offset += size;
+    }
+    else
+    {
+        if (offset + sizeof(T) > len)
+            return false;
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+    }
+    return true;
+}
+
+template <typename M>
+constexpr size_t FieldCount()
+{
+    return std::tuple_size_v<decltype(M::Fields())>;
+}
+
+// 请求 id：客户端可选地在请求中携带，服务端在对应的响应与错误中原样带回，用于流水线请求的乱序匹配
+#define REQUEST_ID_KEY "requestId"
+
+// 全部键名，末尾追加 msgType 键与 requestId 键
+template <typename M>
+constexpr std::array<std::string_view, FieldCount<M>() + 2> MessageKeys()
+{
+    std::array<std::string_view, FieldCount<M>() + 2> keys{};
+    std::apply([&keys](const auto &...f)
+               { size_t i = 0; ((keys[i++] = f.key), ...); },
+               M::Fields());
+    keys[FieldCount<M>()] = "msgType";
+    keys[FieldCount<M>() + 1] = REQUEST_ID_KEY;
+    return keys;
+}
+
+// 输出顺序：与 std::map<std::string, ...> 一致按键名字节序排列，
+// 下标 FieldCount<M>() 代表 msgType 键，FieldCount<M>() + 1 代表 requestId 键
+template <typename M>
+constexpr std::array<size_t, FieldCount<M>() + 2> MessageOrder()
+{
+    constexpr size_t n = FieldCount<M>() + 2;
+    constexpr std::array<std::string_view, n> keys = MessageKeys<M>();
+    std::array<size_t, n> order{};
+    for (size_t i = 0; i < n; i++)
+        order[i] = i;
+    for (size_t i = 1; i < n; i++)
+    {
+        for (size_t j = i; j > 0 && keys[order[j]] < keys[order[j - 1]]; j--)
+        {
+            size_t t = order[j];
+            order[j] = order[j - 1];
+            order[j - 1] = t;
+        }
+    }
+    return order;
+}
+
+template <typename M>
+constexpr bool MessageKeysUnique()
+{
+    constexpr std::array<std::string_view, FieldCount<M>() + 2> keys = MessageKeys<M>();
+    for (size_t i = 0; i < keys.size(); i++)
+        for (size_t j = i + 1; j < keys.size(); j++)
+            if (keys[i] == keys[j])
+                return false;
+    return true;
+}
+
+template <typename M>
+struct MessageLayout
+{
+    static_assert(MessageKeysUnique<M>(), "字段键名重复或与 msgType / requestId 冲突");
+    static constexpr auto fields = M::Fields();
+    static constexpr size_t count = FieldCount<M>();
+    static constexpr std::array<size_t, count + 2> order = MessageOrder<M>();
+};
+
+template <typename M, size_t I, typename Out>
+void EncodeField(const M &msg, uint32_t msgType, uint32_t requestId, Out &out)
+{
+    using Layout = MessageLayout<M>;
+    if constexpr (I == Layout::count)
+    {
+        WirePutKey(out, "msgType", WireIndex<uint32_t>());
+        WirePutU32(out, msgType);
+    }
+    else if constexpr (I == Layout::count + 1)
+    {
+        if (requestId != 0)
+        {
+            WirePutKey(out, REQUEST_ID_KEY, WireIndex<uint32_t>());
+            WirePutU32(out, requestId);
+        }
+    }
+    else
+    {
+        constexpr auto field = std::get<I>(Layout::fields);
+        using T = std::decay_t<decltype(msg.*(field.member))>;
+        WirePutKey(out, field.key, WireIndex<T>());
+        WirePutValue(out, msg.*(field.member));
+    }
+}
+
+template <typename M, typename Out, size_t... K>
+void EncodeFields(const M &msg, uint32_t msgType, uint32_t requestId, Out &out, std::index_sequence<K...>)
+{
+    (EncodeField<M, MessageLayout<M>::order[K]>(msg, msgType, requestId, out), ...);
+}
+
+template <typename T>
+size_t WireValueSize(const T &value)
+{
+    if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::vector<uint8_t>>)
+        return 4 + value.size();
+    else if constexpr (std::is_same_v<T, bool>)
+        return 1;
+    else
+        return sizeof(T);
+}
+
+// 编码后的字节数，供一次预留到位
+template <typename M>
+size_t EncodedSize(const M &msg, uint32_t requestId = 0)
+{
+    size_t size = 8 + (4 + 7 + 1 + 4); // 头部 + msgType 键
+    if (requestId != 0)
+        size += 4 + sizeof(REQUEST_ID_KEY) - 1 + 1 + 4;
+    std::apply([&](const auto &...f)
+               { ((size += 4 + f.key.size() + 1 + WireValueSize(msg.*(f.member))), ...); },
+               MessageLayout<M>::fields);
+    return size;
+}
+
+// 追加到 out 末尾：[msgType 4B][字段数 4B][字段...]；requestId 为 0 时不输出该键
+template <typename M, typename Out>
+void EncodeMessage(MsgType msgType, const M &msg, Out &out, uint32_t requestId = 0)
+{
+    using Layout = MessageLayout<M>;
+    WirePutU32(out, (uint32_t)msgType);
+    WirePutU32(out, (uint32_t)(Layout::count + 1 + (requestId != 0 ? 1 : 0)));
+    EncodeFields(msg, (uint32_t)msgType, requestId, out, std::make_index_sequence<Layout::count + 2>());
+}
+
+template <typename M, size_t... I>
+bool DecodeField(std::string_view key, uint8_t index, const uint8_t *data, size_t len, size_t &offset,
+                 M &msg, std::index_sequence<I...>)
+{
+    constexpr auto &fields = MessageLayout<M>::fields;
+    bool matched = false, ok = true;
+    ((!matched && std::get<I>(fields).key == key &&
+      (matched = true, ok = WireGetValue(index, data, len, offset, msg.*(std::get<I>(fields).member)))),
+     ...);
+    return matched ? ok : WireSkipValue(index, data, len, offset);
+}
+
+// 由线路数据解码；msgType 由调用方确定，这里不校验。数据截断或出现未知类型索引时返回 false
+template <typename M>
+bool DecodeMessage(const uint8_t *data, size_t len, M &msg)
+{
+    size_t offset = 4;
+    uint32_t count = 0;
+    if (len < 4 || !WireGetU32(data, len, offset, count))
+        return false;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        std::string_view key;
+        if (!WireGetKey(data, len, offset, key) || offset >= len)
+            return false;
+        uint8_t index = data[offset++];
+        if (!DecodeField(key, index, data, len, offset, msg, std::make_index_sequence<MessageLayout<M>::count>()))
+            return false;
+    }
+    return true;
+}
+
+template <typename M>
+Packet Packet::Of(uint64_t sessionId, MsgType msgType, const M &msg, uint32_t requestId)
+{
+    Packet packet(sessionId, msgType);
+    packet.body.resize(::EncodedSize(msg, requestId));
+    WireWriter out{packet.body.data()};
+    EncodeMessage(msgType, msg, out, requestId);
+    // 字段以 body 为准，按 map 读取或追加时再解析
+    packet.paramsReady = false;
+    return packet;
+}
+
+template <typename M>
+bool Packet::As(M &msg) const
+{
+    const std::vector<uint8_t> &bytes = Bytes();
+    return DecodeMessage(bytes.data(), bytes.size(), msg);
+}
+
+// --- 消息定义 ---
+// 结构体可被多个 MsgType 共用（如 Login / SignIn 的请求），注释中标出用途
+
+// Login, SignIn 请求
+struct CredentialsMsg
+{
+    std::string username;
+    std::string password;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("username", &CredentialsMsg::username),
+                               Field("password", &CredentialsMsg::password));
+    }
+};
+
+// Login, SignIn, LoginAsGuest 响应
+struct AccountMsg
+{
+    bool success = true;
+    std::string username;
+    int rating = 0;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("success", &AccountMsg::success),
+                               Field("username", &AccountMsg::username),
+                               Field("rating", &AccountMsg::rating));
+    }
+};
+
+// 只含结果的响应（LogOut、SyncSeat、ChatMessage、ExitRoom、GameStarted、GiveUp 等）
+struct ResultMsg
+{
+    bool success = true;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("success", &ResultMsg::success));
+    }
+};
+
+struct ErrorMsg
+{
+    std::string error;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("error", &ErrorMsg::error));
+    }
+};
+
+// CreateRoom 响应；GameStarted、SyncGame 推送
+struct RoomMsg
+{
+    uint64_t roomId = 0;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("roomId", &RoomMsg::roomId));
+    }
+};
+
+// JoinRoom 请求
+struct JoinRoomMsg
+{
+    uint32_t roomId = 0;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("roomId", &JoinRoomMsg::roomId));
+    }
+};
+
+// JoinRoom 响应
+struct JoinRoomResultMsg
+{
+    uint32_t roomId = 0;
+    bool success = true;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("roomId", &JoinRoomResultMsg::roomId),
+                               Field("success", &JoinRoomResultMsg::success));
+    }
+};
+
+// updateUsersToLobby, updateRoomsToLobby 请求
+struct ListQueryMsg
+{
+    uint32_t maxCount = 10;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("maxCount", &ListQueryMsg::maxCount));
+    }
+};
+
+// updateUsersToLobby 响应与推送
+struct UserListMsg
+{
+    std::string userList;
+    uint32_t count = 0;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("userList", &UserListMsg::userList),
+                               Field("count", &UserListMsg::count));
+    }
+};
+
+// updateRoomsToLobby 响应与推送
+struct RoomListMsg
+{
+    std::string roomList;
+    uint32_t count = 0;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("roomList", &RoomListMsg::roomList),
+                               Field("count", &RoomListMsg::count));
+    }
+};
+
+// SyncSeat 请求与推送：P1 黑方、P2 白方用户名
+struct SeatMsg
+{
+    std::string P1;
+    std::string P2;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("P1", &SeatMsg::P1), Field("P2", &SeatMsg::P2));
+    }
+};
+
+// ChatMessage 请求
+struct ChatMsg
+{
+    std::string message;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("message", &ChatMsg::message));
+    }
+};
+
+// ChatMessage 推送
+struct ChatPushMsg
+{
+    uint64_t roomId = 0;
+    uint64_t userId = 0;
+    std::string message;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("roomId", &ChatPushMsg::roomId),
+                               Field("userId", &ChatPushMsg::userId),
+                               Field("message", &ChatPushMsg::message));
+    }
+};
+
+// SyncUsersToRoom 响应
+struct PlayerListMsg
+{
+    std::string playerListStr;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("playerListStr", &PlayerListMsg::playerListStr));
+    }
+};
+
+// SyncUsersToRoom 推送：玩家数量
+struct PlayerCountMsg
+{
+    uint64_t roomId = 0;
+    uint32_t playerCount = 0;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("roomId", &PlayerCountMsg::roomId),
+                               Field("playerCount", &PlayerCountMsg::playerCount));
+    }
+};
+
+// 玩家进出房间、认输等推送
+struct RoomUserMsg
+{
+    uint64_t roomId = 0;
+    uint64_t userId = 0;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("roomId", &RoomUserMsg::roomId),
+                               Field("userId", &RoomUserMsg::userId));
+    }
+};
+
+// 玩家加入、平局请求 / 接受推送
+struct RoomActionMsg
+{
+    uint64_t roomId = 0;
+    uint64_t userId = 0;
+    std::string action;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("roomId", &RoomActionMsg::roomId),
+                               Field("userId", &RoomActionMsg::userId),
+                               Field("action", &RoomActionMsg::action));
+    }
+};
+
+// 房间状态变化推送（SyncGame）
+struct RoomStatusMsg
+{
+    uint64_t roomId = 0;
+    uint64_t userId = 0;
+    std::string status;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("roomId", &RoomStatusMsg::roomId),
+                               Field("userId", &RoomStatusMsg::userId),
+                               Field("status", &RoomStatusMsg::status));
+    }
+};
+
+// 房间创建推送（SyncGame）
+struct RoomCreatedMsg
+{
+    uint64_t roomId = 0;
+    uint64_t userId = 0;
+    std::string status = "created";
+    uint32_t boardSize = 15;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("roomId", &RoomCreatedMsg::roomId),
+                               Field("userId", &RoomCreatedMsg::userId),
+                               Field("status", &RoomCreatedMsg::status),
+                               Field("boardSize", &RoomCreatedMsg::boardSize));
+    }
+};
+
+// 棋盘状态推送（SyncGame）
+struct BoardStateMsg
+{
+    uint64_t roomId = 0;
+    uint32_t boardSize = 15;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("roomId", &BoardStateMsg::roomId),
+                               Field("boardSize", &BoardStateMsg::boardSize));
+    }
+};
+
+// SyncGame 响应
+struct GameStatusMsg
+{
+    bool success = true;
+    std::string statusStr;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("success", &GameStatusMsg::success),
+                               Field("statusStr", &GameStatusMsg::statusStr));
+    }
+};
+
+// MakeMove 请求与推送
+struct MoveMsg
+{
+    uint32_t x = 0;
+    uint32_t y = 0;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("x", &MoveMsg::x), Field("y", &MoveMsg::y));
+    }
+};
+
+// MakeMove 响应
+struct MoveResultMsg
+{
+    uint32_t x = 0;
+    uint32_t y = 0;
+    bool success = true;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("x", &MoveResultMsg::x), Field("y", &MoveResultMsg::y),
+                               Field("success", &MoveResultMsg::success));
+    }
+};
+
+// Draw, UndoMove 请求
+struct NegotiateMsg
+{
+    uint8_t negStatus = static_cast<uint8_t>(NegStatus::Ask);
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("negStatus", &NegotiateMsg::negStatus));
+    }
+};
+
+// Draw, UndoMove 响应
+struct NegotiateResultMsg
+{
+    bool success = true;
+    uint8_t negStatus = static_cast<uint8_t>(NegStatus::Ask);
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("success", &NegotiateResultMsg::success),
+                               Field("negStatus", &NegotiateResultMsg::negStatus));
+    }
+};
+
+// GameEnded 推送
+struct GameEndedMsg
+{
+    uint64_t roomId = 0;
+    uint64_t winnerId = 0;
+    std::string msg;
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(Field("roomId", &GameEndedMsg::roomId),
+                               Field("winnerId", &GameEndedMsg::winnerId),
+                               Field("msg", &GameEndedMsg::msg));
+    }
+};
+
+#endif // MESSAGE_H
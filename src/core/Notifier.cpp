@@ -1,4 +1,5 @@
 #include "Notifier.h"
+#include "Message.h"
 #include "ObjectManager.h"
 #include "Logger.h"
 
@@ -88,19 +89,21 @@ void Notifier::OnPlayerJoined(uint64_t roomId, uint64_t userId)
     // 创建推送包（事件驱动架构，不需要requestId）
     // 注意：sessionId 应该在 BroadcastToRoom 中设置，这里先用 0
     // 使用 SyncUsersToRoom 通知玩家加入
-    Packet push(0, MsgType::SyncUsersToRoom);
-    push.AddParam("roomId", roomId);
-    push.AddParam("userId", userId);
-    push.AddParam("action", "joined");
+    RoomActionMsg joined;
+    joined.roomId = roomId;
+    joined.userId = userId;
+    joined.action = "joined";
+    Packet push = Packet::Of(0, MsgType::SyncUsersToRoom, joined);
 
     BroadcastToRoom(roomId, push);
 }
 
 void Notifier::OnPlayerLeft(uint64_t roomId, uint64_t userId)
 {
-    Packet push(0, MsgType::SyncUsersToRoom);
-    push.AddParam("roomId", roomId);
-    push.AddParam("userId", userId);
+    RoomUserMsg left;
+    left.roomId = roomId;
+    left.userId = userId;
+    Packet push = Packet::Of(0, MsgType::SyncUsersToRoom, left);
 
     BroadcastToRoom(roomId, push);
 }
@@ -108,21 +111,22 @@ void Notifier::OnPlayerLeft(uint64_t roomId, uint64_t userId)
 void Notifier::OnPiecePlaced(uint64_t roomId, uint64_t userId, uint32_t x, uint32_t y)
 {
     // 使用 MakeMove 推送，因为棋子放置就是落子
-    Packet push(0, MsgType::MakeMove);
-    push.AddParam("x", x);
-    push.AddParam("y", y);
+    MoveMsg move;
+    move.x = x;
+    move.y = y;
+    Packet push = Packet::Of(0, MsgType::MakeMove, move);
 
     BroadcastToRoom(roomId, push);
 }
 
 void Notifier::OnGameEnded(uint64_t roomId, uint64_t winnerId)
 {
-    Packet push(0, MsgType::GameEnded);
-    push.AddParam("roomId", roomId);
-    push.AddParam("winnerId", winnerId);
+    GameEndedMsg ended;
+    ended.roomId = roomId;
+    ended.winnerId = winnerId;
     User *winner = objMgr.GetUserByUserId(winnerId);
-    std::string msg = winner->username + " 获胜！";
-    push.AddParam("msg", msg);
+    ended.msg = winner->username + " 获胜！";
+    Packet push = Packet::Of(0, MsgType::GameEnded, ended);
     BroadcastToRoom(roomId, push);
 }
 
@@ -136,15 +140,32 @@ void Notifier::BroadcastToRoom(uint64_t roomId, const Packet &packet)
         return;
     }
 
-    // 遍历房间内所有玩家，逐个发送推送消息
+    // 收集房间内所有在线玩家的会话，统一发送
+    std::vector<uint64_t> sessionIds;
+    sessionIds.reserve(room->playerIds.size());
     for (uint64_t userId : room->playerIds)
     {
         uint64_t sessionId = objMgr.GetSessionIdByUserId(userId);
         if (sessionId != 0)
         {
-            SendToSession(sessionId, packet);
+            sessionIds.push_back(sessionId);
         }
     }
+    BroadcastToSessions(sessionIds, packet);
+}
+
+void Notifier::BroadcastToSessions(const std::vector<uint64_t> &sessionIds, const Packet &packet)
+{
+    if (sessionIds.empty())
+        return;
+
+    // 负载只编码一次，之后每个会话的副本只复制引用计数
+    Packet shared = packet;
+    shared.Share();
+    for (uint64_t sessionId : sessionIds)
+    {
+        SendToSession(sessionId, shared);
+    }
 }
 
 void Notifier::SendToSession(uint64_t sessionId, const Packet &packet)
@@ -155,21 +176,42 @@ void Notifier::SendToSession(uint64_t sessionId, const Packet &packet)
         return;
     }
 
-    // 创建会话级的包副本，设置正确的 sessionId
+    // 创建会话级的包副本，设置正确的 sessionId（共享负载时不复制数据）
     Packet sessionPacket = packet;
     sessionPacket.sessionId = sessionId;
     sendPacketCb(sessionPacket);
 }
 
+std::vector<uint64_t> Notifier::OnlineSessionIds() const
+{
+    // 获取所有用户列表
+    std::vector<User *> allUsers = objMgr.GetUserList(1000); // 获取大量用户，确保覆盖所有
+
+    std::vector<uint64_t> sessionIds;
+    for (User *user : allUsers)
+    {
+        if (!user)
+            continue;
+
+        uint64_t sessionId = objMgr.GetSessionIdByUserId(user->GetID());
+        if (sessionId != 0)
+        {
+            sessionIds.push_back(sessionId);
+        }
+    }
+    return sessionIds;
+}
+
 // 新增的推送消息处理函数
 
 void Notifier::OnRoomStatusChanged(uint64_t roomId, uint64_t userId, const std::string &status)
 {
     // 使用 SyncGame 通知房间状态变化
-    Packet push(0, MsgType::SyncGame);
-    push.AddParam("roomId", roomId);
-    push.AddParam("userId", userId);
-    push.AddParam("status", status);
+    RoomStatusMsg changed;
+    changed.roomId = roomId;
+    changed.userId = userId;
+    changed.status = status;
+    Packet push = Packet::Of(0, MsgType::SyncGame, changed);
 
     BroadcastToRoom(roomId, push);
 }
@@ -177,10 +219,11 @@ void Notifier::OnRoomStatusChanged(uint64_t roomId, uint64_t userId, const std::
 void Notifier::OnDrawRequested(uint64_t roomId, uint64_t userId)
 {
     // 使用 Draw 推送
-    Packet push(0, MsgType::Draw);
-    push.AddParam("roomId", roomId);
-    push.AddParam("userId", userId);
-    push.AddParam("action", "request");
+    RoomActionMsg request;
+    request.roomId = roomId;
+    request.userId = userId;
+    request.action = "request";
+    Packet push = Packet::Of(0, MsgType::Draw, request);
 
     BroadcastToRoom(roomId, push);
 }
@@ -188,10 +231,11 @@ void Notifier::OnDrawRequested(uint64_t roomId, uint64_t userId)
 void Notifier::OnDrawAccepted(uint64_t roomId, uint64_t userId)
 {
     // 使用 Draw 推送
-    Packet push(0, MsgType::Draw);
-    push.AddParam("roomId", roomId);
-    push.AddParam("userId", userId);
-    push.AddParam("action", "accept");
+    RoomActionMsg accept;
+    accept.roomId = roomId;
+    accept.userId = userId;
+    accept.action = "accept";
+    Packet push = Packet::Of(0, MsgType::Draw, accept);
 
     BroadcastToRoom(roomId, push);
 }
@@ -199,9 +243,10 @@ void Notifier::OnDrawAccepted(uint64_t roomId, uint64_t userId)
 void Notifier::OnGiveUpRequested(uint64_t roomId, uint64_t userId)
 {
     // 使用 GiveUp 推送
-    Packet push(0, MsgType::GiveUp);
-    push.AddParam("roomId", roomId);
-    push.AddParam("userId", userId);
+    RoomUserMsg giveUp;
+    giveUp.roomId = roomId;
+    giveUp.userId = userId;
+    Packet push = Packet::Of(0, MsgType::GiveUp, giveUp);
 
     BroadcastToRoom(roomId, push);
 }
@@ -220,11 +265,11 @@ void Notifier::OnRoomCreated(uint64_t roomId, uint64_t ownerId)
     LOG_INFO("Room created: roomId=" + std::to_string(roomId) + ", ownerId=" + std::to_string(ownerId));
 
     // 1. 广播房间状态变化消息
-    Packet roomStatusPush(0, MsgType::SyncGame);
-    roomStatusPush.AddParam("roomId", roomId);
-    roomStatusPush.AddParam("userId", ownerId);
-    roomStatusPush.AddParam("status", "created");
-    roomStatusPush.AddParam("boardSize", (uint32_t)15); // TODO: 从room获取实际棋盘大小
+    RoomCreatedMsg created;
+    created.roomId = roomId;
+    created.userId = ownerId;
+    created.boardSize = 15; // TODO: 从room获取实际棋盘大小
+    Packet roomStatusPush = Packet::Of(0, MsgType::SyncGame, created);
     BroadcastToRoom(roomId, roomStatusPush);
 
     // 2. 广播棋盘状态
@@ -240,9 +285,10 @@ void Notifier::SendBoardStateToRoom(Room *room)
         return;
 
     // 使用 SyncGame 推送棋盘状态
-    Packet boardStatePush(0, MsgType::SyncGame);
-    boardStatePush.AddParam("roomId", room->GetRoomId());
-    boardStatePush.AddParam("boardSize", (uint32_t)15); // TODO: 从room获取实际棋盘大小
+    BoardStateMsg boardState;
+    boardState.roomId = room->GetRoomId();
+    boardState.boardSize = 15; // TODO: 从room获取实际棋盘大小
+    Packet boardStatePush = Packet::Of(0, MsgType::SyncGame, boardState);
 
     // TODO: 添加棋盘数据序列化
     // 目前先发送空棋盘状态
@@ -257,9 +303,10 @@ void Notifier::SendPlayerListToRoom(Room *room)
         return;
 
     // 使用 SyncUsersToRoom 推送玩家列表
-    Packet playerListPush(0, MsgType::SyncUsersToRoom);
-    playerListPush.AddParam("roomId", room->GetRoomId());
-    playerListPush.AddParam("playerCount", (uint32_t)room->playerIds.size());
+    PlayerCountMsg playerCount;
+    playerCount.roomId = room->GetRoomId();
+    playerCount.playerCount = (uint32_t)room->playerIds.size();
+    Packet playerListPush = Packet::Of(0, MsgType::SyncUsersToRoom, playerCount);
 
     // TODO: 添加玩家ID列表序列化
     // 目前先发送玩家数量
@@ -306,180 +353,137 @@ void Notifier::OnRoomListUpdated()
 
 void Notifier::BroadcastUserListUpdate()
 {
-    // 获取所有用户列表
-    std::vector<User *> allUsers = objMgr.GetUserList(1000); // 获取大量用户，确保覆盖所有
-
-    // 统计在线用户数量
-    size_t onlineCount = 0;
-
-    // 为每个在线用户发送用户列表更新
-    for (User *user : allUsers)
+    // 推送内容与接收者无关，先确认有在线用户，再构造一次发给所有人
+    std::vector<uint64_t> sessionIds = OnlineSessionIds();
+    if (sessionIds.empty())
     {
-        if (!user)
-            continue;
-
-        uint64_t userId = user->GetID();
-        uint64_t sessionId = objMgr.GetSessionIdByUserId(userId);
-
-        if (sessionId == 0)
-            continue; // 用户不在线
-
-        onlineCount++;
-
-        // 创建用户列表包
-        Packet userListPush(sessionId, MsgType::updateUsersToLobby);
+        LOG_DEBUG("No online users to broadcast user list update");
+        return;
+    }
 
-        // 获取用户列表（前10个）
-        std::vector<User *> userList = objMgr.GetUserList(10);
+    // 获取用户列表（前10个）
+    std::vector<User *> userList = objMgr.GetUserList(10);
 
-        // 构造用户列表字符串（与Handler::OnGetUserList相同的逻辑）
-        std::string userListStr;
-        for (size_t i = 0; i < userList.size(); i++)
+    // 构造用户列表字符串（与Handler::OnGetUserList相同的逻辑）
+    std::string userListStr;
+    for (size_t i = 0; i < userList.size(); i++)
+    {
+        User *listUser = userList[i];
+        if (listUser)
         {
-            User *listUser = userList[i];
-            if (listUser)
-            {
-                // 判断用户是否在线
-                uint64_t userSessionId = objMgr.GetSessionIdByUserId(listUser->GetID());
-                std::string status = (userSessionId != 0) ? "在线" : "离线";
+            // 判断用户是否在线
+            uint64_t userSessionId = objMgr.GetSessionIdByUserId(listUser->GetID());
+            std::string status = (userSessionId != 0) ? "在线" : "离线";
 
-                userListStr += listUser->GetUsername() + " (" + status + ")";
+            userListStr += listUser->GetUsername() + " (" + status + ")";
 
-                if (i != userList.size() - 1)
-                {
-                    userListStr += ", ";
-                }
+            if (i != userList.size() - 1)
+            {
+                userListStr += ", ";
             }
         }
-
-        userListPush.AddParam("userList", userListStr);
-        userListPush.AddParam("count", uint32_t(userList.size()));
-
-        // 发送给该session
-        SendToSession(sessionId, userListPush);
     }
 
-    if (onlineCount == 0)
-    {
-        LOG_DEBUG("No online users to broadcast user list update");
-    }
-    else
-    {
-        LOG_DEBUG("Broadcast user list update to " + std::to_string(onlineCount) + " online users");
-    }
+    // 创建用户列表包
+    UserListMsg users;
+    users.userList = userListStr;
+    users.count = uint32_t(userList.size());
+    Packet userListPush = Packet::Of(0, MsgType::updateUsersToLobby, users);
+
+    BroadcastToSessions(sessionIds, userListPush);
+    LOG_DEBUG("Broadcast user list update to " + std::to_string(sessionIds.size()) + " online users");
 }
 
 void Notifier::BroadcastRoomListUpdate()
 {
-    // 获取所有用户列表
-    std::vector<User *> allUsers = objMgr.GetUserList(1000); // 获取大量用户，确保覆盖所有
-
-    // 统计在线用户数量
-    size_t onlineCount = 0;
-
-    // 为每个在线用户发送房间列表更新
-    for (User *user : allUsers)
+    // 推送内容与接收者无关，先确认有在线用户，再构造一次发给所有人
+    std::vector<uint64_t> sessionIds = OnlineSessionIds();
+    if (sessionIds.empty())
     {
-        if (!user)
-            continue;
+        LOG_DEBUG("No online users to broadcast room list update");
+        return;
+    }
 
-        uint64_t userId = user->GetID();
-        uint64_t sessionId = objMgr.GetSessionIdByUserId(userId);
+    // 从ObjectManager获取房间列表
+    std::vector<Room *> roomList = objMgr.GetRoomList(10); // 默认获取前10个房间
 
-        if (sessionId == 0)
-            continue; // 用户不在线
+    // 构造房间列表字符串（与Handler::OnGetRoomList相同的逻辑）
+    std::string roomListStr;
+    for (size_t i = 0; i < roomList.size(); i++)
+    {
+        Room *room = roomList[i];
+        if (room)
+        {
+            // 获取房间状态
+            std::string statusStr;
+            switch (room->status)
+            {
+            case RoomStatus::Free:
+                statusStr = "空闲";
+                break;
+            case RoomStatus::Playing:
+                statusStr = "对战中";
+                break;
+            case RoomStatus::End:
+                statusStr = "已结束";
+                break;
+            default:
+                statusStr = "未知";
+                break;
+            }
 
-        onlineCount++;
+            // 获取房间描述
+            std::string description;
+            if (room->status == RoomStatus::Playing)
+            {
+                // 对战中：显示对战双方
+                User *blackUser = objMgr.GetUserByUserId(room->blackPlayerId);
+                User *whiteUser = objMgr.GetUserByUserId(room->whitePlayerId);
 
-        // 创建房间列表包
-        Packet roomListPush(sessionId, MsgType::updateRoomsToLobby);
+                std::string blackName = blackUser ? blackUser->GetUsername() : "";
+                std::string whiteName = whiteUser ? whiteUser->GetUsername() : "";
+                description = blackName + " vs " + whiteName;
+            }
+            else if (room->status == RoomStatus::Free)
+            {
+                // 空闲：显示房主信息
+                User *owner = objMgr.GetUserByUserId(room->ownerId);
+                std::string ownerName = owner ? owner->GetUsername() : "";
+                description = ownerName + " (等待对手)";
+            }
+            else
+            {
+                description = "房间已结束";
+            }
 
-        // 从ObjectManager获取房间列表
-        std::vector<Room *> roomList = objMgr.GetRoomList(10); // 默认获取前10个房间
+            // 格式： "#001", "空闲", "等待玩家加入"
+            roomListStr += "#" + std::to_string(room->GetRoomId()) + ", " +
+                           statusStr + ", " + description;
 
-        // 构造房间列表字符串（与Handler::OnGetRoomList相同的逻辑）
-        std::string roomListStr;
-        for (size_t i = 0; i < roomList.size(); i++)
-        {
-            Room *room = roomList[i];
-            if (room)
+            if (i != roomList.size() - 1)
             {
-                // 获取房间状态
-                std::string statusStr;
-                switch (room->status)
-                {
-                case RoomStatus::Free:
-                    statusStr = "空闲";
-                    break;
-                case RoomStatus::Playing:
-                    statusStr = "对战中";
-                    break;
-                case RoomStatus::End:
-                    statusStr = "已结束";
-                    break;
-                default:
-                    statusStr = "未知";
-                    break;
-                }
-
-                // 获取房间描述
-                std::string description;
-                if (room->status == RoomStatus::Playing)
-                {
-                    // 对战中：显示对战双方
-                    User *blackUser = objMgr.GetUserByUserId(room->blackPlayerId);
-                    User *whiteUser = objMgr.GetUserByUserId(room->whitePlayerId);
-
-                    std::string blackName = blackUser ? blackUser->GetUsername() : "";
-                    std::string whiteName = whiteUser ? whiteUser->GetUsername() : "";
-                    description = blackName + " vs " + whiteName;
-                }
-                else if (room->status == RoomStatus::Free)
-                {
-                    // 空闲：显示房主信息
-                    User *owner = objMgr.GetUserByUserId(room->ownerId);
-                    std::string ownerName = owner ? owner->GetUsername() : "";
-                    description = ownerName + " (等待对手)";
-                }
-                else
-                {
-                    description = "房间已结束";
-                }
-
-                // 格式： "#001", "空闲", "等待玩家加入"
-                roomListStr += "#" + std::to_string(room->GetRoomId()) + ", " +
-                               statusStr + ", " + description;
-
-                if (i != roomList.size() - 1)
-                {
-                    roomListStr += ", ";
-                }
+                roomListStr += ", ";
             }
         }
-
-        roomListPush.AddParam("roomList", roomListStr);
-        roomListPush.AddParam("count", uint32_t(roomList.size()));
-
-        // 发送给该session
-        SendToSession(sessionId, roomListPush);
     }
 
-    if (onlineCount == 0)
-    {
-        LOG_DEBUG("No online users to broadcast room list update");
-    }
-    else
-    {
-        LOG_DEBUG("Broadcast room list update to " + std::to_string(onlineCount) + " online users");
-    }
+    // 创建房间列表包
+    RoomListMsg rooms;
+    rooms.roomList = roomListStr;
+    rooms.count = uint32_t(roomList.size());
+    Packet roomListPush = Packet::Of(0, MsgType::updateRoomsToLobby, rooms);
+
+    BroadcastToSessions(sessionIds, roomListPush);
+    LOG_DEBUG("Broadcast room list update to " + std::to_string(sessionIds.size()) + " online users");
 }
 
 // --- 新增的推送消息处理函数 ---
 
 void Notifier::OnGameStarted(uint64_t roomId)
 {
-    Packet push(0, MsgType::GameStarted);
-    push.AddParam("roomId", roomId);
+    RoomMsg started;
+    started.roomId = roomId;
+    Packet push = Packet::Of(0, MsgType::GameStarted, started);
 
     BroadcastToRoom(roomId, push);
 }
@@ -487,10 +491,11 @@ void Notifier::OnGameStarted(uint64_t roomId)
 void Notifier::OnChatMessageRecv(uint64_t roomId, uint64_t userId, const std::string &message)
 {
     // 使用 ChatMessage 推送聊天消息
-    Packet push(0, MsgType::ChatMessage);
-    push.AddParam("roomId", roomId);
-    push.AddParam("userId", userId);
-    push.AddParam("message", message);
+    ChatPushMsg chat;
+    chat.roomId = roomId;
+    chat.userId = userId;
+    chat.message = message;
+    Packet push = Packet::Of(0, MsgType::ChatMessage, chat);
 
     BroadcastToRoom(roomId, push);
 }
@@ -498,8 +503,9 @@ void Notifier::OnChatMessageRecv(uint64_t roomId, uint64_t userId, const std::st
 void Notifier::OnRoomSync(uint64_t roomId)
 {
     // 房间同步可以使用 SyncGame
-    Packet push(0, MsgType::SyncGame);
-    push.AddParam("roomId", roomId);
+    RoomMsg sync;
+    sync.roomId = roomId;
+    Packet push = Packet::Of(0, MsgType::SyncGame, sync);
 
     // TODO: 添加房间同步数据
     BroadcastToRoom(roomId, push);
@@ -508,8 +514,9 @@ void Notifier::OnRoomSync(uint64_t roomId)
 void Notifier::OnGameSync(uint64_t roomId)
 {
     // 游戏同步可以使用 SyncGame
-    Packet push(0, MsgType::SyncGame);
-    push.AddParam("roomId", roomId);
+    RoomMsg sync;
+    sync.roomId = roomId;
+    Packet push = Packet::Of(0, MsgType::SyncGame, sync);
 
     // TODO: 添加游戏同步数据
     BroadcastToRoom(roomId, push);
@@ -534,9 +541,10 @@ void Notifier::OnSyncSeat(uint64_t roomId, uint64_t blackPlayerId, uint64_t whit
     }
 
     // 使用 SyncSeat 推送座位分配（包含用户名）
-    Packet push(0, MsgType::SyncSeat);
-    push.AddParam("P1", blackUsername);
-    push.AddParam("P2", whiteUsername);
+    SeatMsg seat;
+    seat.P1 = blackUsername;
+    seat.P2 = whiteUsername;
+    Packet push = Packet::Of(0, MsgType::SyncSeat, seat);
 
     LOG_DEBUG("Broadcasting seat sync for room " + std::to_string(roomId) +
               ": black=" + blackUsername + "(" + std::to_string(blackPlayerId) + ")" +
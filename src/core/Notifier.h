@@ -37,9 +37,11 @@ private:
     void OnGameSync(uint64_t roomId);
     void OnSyncSeat(uint64_t roomId, uint64_t blackPlayerId, uint64_t whitePlayerId);
 
-    // 辅助函数：通过 sessionId 发送推送消息
+    // 辅助函数：通过 sessionId 发送推送消息；广播只序列化一次，各会话共用同一份负载
     void BroadcastToRoom(uint64_t roomId, const Packet &packet);
+    void BroadcastToSessions(const std::vector<uint64_t> &sessionIds, const Packet &packet);
     void SendToSession(uint64_t sessionId, const Packet &packet);
+    std::vector<uint64_t> OnlineSessionIds() const;
 
     // 房间状态广播辅助函数
     void SendBoardStateToRoom(Room *room);
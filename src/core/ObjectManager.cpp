@@ -3,6 +3,7 @@
 #include "Logger.h"
 #include <algorithm>
 #include <sstream>
+#include <cstdlib>
 
 ObjectManager::ObjectManager()
 {
@@ -55,15 +56,23 @@ User *ObjectManager::CreateUser(const std::string &username, const std::string &
         return nullptr;
     }
 
+    uint64_t userId = InsertUser(username, password);
+    if (userId == 0)
+        return nullptr;
+    return AddUser(userId, username, password);
+}
+
+uint64_t ObjectManager::InsertUser(const std::string &username, const std::string &password)
+{
     Database &db = Database::GetInstance();
 
-    // 插入到数据库
+    // 插入到数据库（用户名唯一，并发注册同名用户时后到的一个失败）
     std::ostringstream sql;
     sql << "INSERT INTO users (username, password) VALUES ('" << username << "', '" << password << "');";
 
     if (!db.Execute(sql.str()))
     {
-        return nullptr;
+        return 0;
     }
 
     // 查询刚插入的 ID
@@ -71,10 +80,21 @@ User *ObjectManager::CreateUser(const std::string &username, const std::string &
     querySql << "SELECT id FROM users WHERE username='" << username << "';";
     std::string idStr = db.QueryValue(querySql.str());
 
-    if (idStr.empty())
-        return nullptr;
+    // 工作线程上抛出的异常会直接终止进程，不用 std::stoull
+    char *end = nullptr;
+    uint64_t userId = std::strtoull(idStr.c_str(), &end, 10);
+    if (idStr.empty() || *end != '\0')
+    {
+        LOG_ERROR("Unexpected user id '" + idStr + "' for " + username);
+        return 0;
+    }
+    return userId;
+}
 
-    uint64_t userId = std::stoull(idStr);
+User *ObjectManager::AddUser(uint64_t userId, const std::string &username, const std::string &password)
+{
+    if (userId == 0 || usernameToUserIdMap.find(username) != usernameToUserIdMap.end())
+        return nullptr;
 
     auto user = std::make_unique<User>(username, password);
     user->id = userId;
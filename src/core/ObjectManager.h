@@ -33,6 +33,11 @@ public:
 
     // --- User 生命周期 API ---
     User *CreateUser(const std::string &username, const std::string &password);
+    // CreateUser 拆成两步，写库可以放到 Reactor 之外执行：
+    // InsertUser 只访问数据库（线程安全，不触及内存中的对象表），返回新用户 ID，失败返回 0；
+    // AddUser 把已落库的用户登记到内存，须在上层逻辑锁内调用
+    static uint64_t InsertUser(const std::string &username, const std::string &password);
+    User *AddUser(uint64_t userId, const std::string &username, const std::string &password);
     User *GetUserByUsername(const std::string &username);
     User *GetUserByUserId(uint64_t userId);
     bool RemoveUser(uint64_t userId);
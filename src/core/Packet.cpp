@@ -1,233 +1,274 @@
 #include "Packet.h"
+#include "PacketView.h"
+#include "CompactCodec.h"
 #include "Logger.h"
 
-#include <memory>
+// [Map数据: [Map字段数量M 4 Byte] + M * [[键长度N 4 Byte][键字符串 N Byte][值类型索引 1 Byte][值数据 N Byte]]
 
-// 定义值类型
+static void WriteEntry(WireWriter &buffer, const std::string &key, const ValueType &value)
+{
+    WirePutKey(buffer, key, static_cast<uint8_t>(value.index()));
+    std::visit([&buffer](const auto &v)
+               { WirePutValue(buffer, v); },
+               value);
+}
 
-template <typename T>
-void WriteBytes(std::vector<uint8_t> &buffer, T value)
+void Packet::Serialize(WireWriter &buffer) const
 {
-    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+    // 序列化 msgType
+    WirePutU32(buffer, static_cast<uint32_t>(msgType));
+
+    // 序列化 params map；msgType 键不存放在 params 中，按键名顺序补在对应位置
+    const std::string msgTypeKey = "msgType";
+    bool hasMsgType = params.count(msgTypeKey) != 0;
+    WirePutU32(buffer, static_cast<uint32_t>(params.size() + (hasMsgType ? 0 : 1)));
 
-    for (size_t i = 0; i < sizeof(T); ++i)
+    bool msgTypeWritten = hasMsgType;
+    for (const auto &pair : params)
     {
-        buffer.push_back(bytes[i]);
+        if (!msgTypeWritten && msgTypeKey < pair.first)
+        {
+            WriteEntry(buffer, msgTypeKey, static_cast<uint32_t>(msgType));
+            msgTypeWritten = true;
+        }
+        WriteEntry(buffer, pair.first, pair.second);
     }
+    if (!msgTypeWritten)
+        WriteEntry(buffer, msgTypeKey, static_cast<uint32_t>(msgType));
 }
 
-template <typename T>
-T ReadBytes(const std::vector<uint8_t> &buffer, size_t &offset)
+std::vector<uint8_t> Packet::Serialize() const
 {
-    if (offset + sizeof(T) > buffer.size())
-    {
-        // throw std::runtime_error("Buffer underflow during read_bytes");
-    }
-
-    T value;
-    uint8_t *bytes = reinterpret_cast<uint8_t *>(&value);
+    // 先求长度，一次分配到位
+    WireWriter counter;
+    Serialize(counter);
+    std::vector<uint8_t> buffer(counter.size);
+    WireWriter writer{buffer.data()};
+    Serialize(writer);
+    return buffer;
+}
 
-    // 按字节从小到大读取 (小端序)
-    for (size_t i = 0; i < sizeof(T); ++i)
+const MapType &Packet::Params() const
+{
+    if (!paramsReady)
     {
-        bytes[i] = buffer[offset + i];
+        params = View().ToParams();
+        paramsReady = true;
     }
-    offset += sizeof(T);
-    return value;
+    return params;
 }
 
-// [Map数据: [Map字段数量M 4 Byte] + M * [[键长度N 4 Byte][键字符串 N Byte][值类型索引 1 Byte][值数据 N Byte]]
+Packet::Packet() : sessionId(0), msgType(MsgType::None)
+{
+}
 
-std::vector<uint8_t> Packet::Serialize() const
+Packet::Packet(uint64_t sessionId, MsgType type) : sessionId(sessionId), msgType(type)
 {
-    std::vector<uint8_t> buffer;
+}
 
-    // 序列化 msgType
-    WriteBytes<uint32_t>(buffer, static_cast<uint32_t>(msgType));
+const std::vector<uint8_t> &Packet::Bytes() const
+{
+    if (shared)
+        return shared->standard;
+    if (body.empty())
+        body = Serialize();
+    return body;
+}
 
-    // 序列化 params map
-    WriteBytes<uint32_t>(buffer, static_cast<uint32_t>(params.size()));
+std::vector<uint8_t> Packet::ToBytes(WireFormat format) const
+{
+    if (shared)
+        return format == WireFormat::Compact ? shared->compact : shared->standard;
+    if (format == WireFormat::Standard && !body.empty())
+        return body;
+    std::vector<uint8_t> bytes(EncodedSize(format));
+    WriteTo(bytes.data(), format);
+    return bytes;
+}
 
-    for (const auto &pair : params)
+size_t Packet::EncodedSize(WireFormat format) const
+{
+    if (shared)
+        return format == WireFormat::Compact ? shared->compact.size() : shared->standard.size();
+    WireWriter counter;
+    if (format == WireFormat::Standard)
     {
-        WriteBytes<uint32_t>(buffer, static_cast<uint32_t>(pair.first.length()));
-
-        for (char c : pair.first)
-        {
-            buffer.push_back(static_cast<uint8_t>(c));
-        }
-
-        uint8_t index = static_cast<uint8_t>(pair.second.index());
-        buffer.push_back(index);
-
-        std::visit([this, &buffer, index](const auto &value)
-                   {
-            if constexpr (std::is_same_v<std::decay_t<decltype(value)>, int>) {
-                WriteBytes<uint32_t>(buffer, value);
-            } else if constexpr (std::is_same_v<std::decay_t<decltype(value)>, uint8_t>) {
-                buffer.push_back(value);
-            } else if constexpr (std::is_same_v<std::decay_t<decltype(value)>, uint32_t>) {
-                WriteBytes<uint32_t>(buffer, value);
-            } else if constexpr (std::is_same_v<std::decay_t<decltype(value)>, uint64_t>) {
-                WriteBytes<uint64_t>(buffer, value);
-            } else if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string>) {
-                WriteBytes<uint32_t>(buffer, static_cast<uint32_t>(value.length()));
-                for (char c : value) {
-                    buffer.push_back(static_cast<uint8_t>(c));
-                }
-            } else if constexpr (std::is_same_v<std::decay_t<decltype(value)>, bool>) {
-                buffer.push_back(value ? 1 : 0);
-            } else if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::vector<uint8_t>>) {
-                WriteBytes<uint32_t>(buffer, static_cast<uint32_t>(value.size()));
-                for (uint8_t byte : value) {
-                    buffer.push_back(byte);
-                }
-            } },
-                   pair.second);
+        if (!body.empty())
+            return body.size();
+        Serialize(counter);
+        return counter.size;
     }
-
-    return buffer;
+    const std::vector<uint8_t> &bytes = Bytes();
+    CompactEncode(bytes.data(), bytes.size(), counter); // body 总是合法的标准格式
+    return counter.size;
 }
 
-bool Packet::Deserialize(const std::vector<uint8_t> &buffer)
+void Packet::WriteTo(uint8_t *out, WireFormat format) const
 {
-    size_t offset = 0;
+    WireWriter writer{out};
+    if (shared)
+    {
+        const std::vector<uint8_t> &bytes = format == WireFormat::Compact ? shared->compact : shared->standard;
+        WireAppend(writer, bytes.data(), bytes.size());
+        return;
+    }
+    if (format == WireFormat::Standard)
+    {
+        if (!body.empty())
+            WireAppend(writer, body.data(), body.size());
+        else
+            Serialize(writer);
+        return;
+    }
+    const std::vector<uint8_t> &bytes = Bytes();
+    CompactEncode(bytes.data(), bytes.size(), writer);
+}
 
-    // 反序列化 msgType
-    msgType = static_cast<MsgType>(ReadBytes<uint32_t>(buffer, offset));
+bool Packet::FromData(uint64_t sessionId, const std::vector<uint8_t> &data, WireFormat format)
+{
+    return FromData(sessionId, std::vector<uint8_t>(data), format);
+}
 
-    uint32_t num_elements = ReadBytes<uint32_t>(buffer, offset);
+bool Packet::FromData(uint64_t sessionId, std::vector<uint8_t> &&data, WireFormat format)
+{
+    this->sessionId = sessionId;
 
-    for (uint32_t i = 0; i < num_elements; ++i)
+    if (format == WireFormat::Compact)
     {
-        uint32_t key_len = ReadBytes<uint32_t>(buffer, offset);
-
-        if (offset + key_len > buffer.size())
-        {
-            LOG_WARN("Deserialize failed");
-            return false;
-        }
-        std::string key(reinterpret_cast<const char *>(buffer.data() + offset), key_len);
-        offset += key_len;
-
-        if (offset + 1 > buffer.size())
+        std::vector<uint8_t> standard;
+        if (!CompactDecode(data.data(), data.size(), standard))
         {
-            LOG_WARN("Deserialize failed");
+            LOG_WARN("Compact decode failed");
             return false;
         }
-        uint8_t index = buffer[offset++];
-
-        ValueType value;
-        switch (index)
-        {
-        case 0: // int
-            if (offset + 4 > buffer.size())
-            {
-                LOG_WARN("Deserialize failed");
-                return false;
-            }
-            value = ReadBytes<uint32_t>(buffer, offset);
-            break;
-        case 1: // uint8_t
-            if (offset + 1 > buffer.size())
-            {
-                LOG_WARN("Deserialize failed");
-                return false;
-            }
-            value = buffer[offset++];
-            break;
-        case 2: // uint32_t
-            if (offset + 4 > buffer.size())
-            {
-                LOG_WARN("Deserialize failed");
-                return false;
-            }
-            value = ReadBytes<uint32_t>(buffer, offset);
-            break;
-        case 3: // uint64_t
-            if (offset + 8 > buffer.size())
-            {
-                LOG_WARN("Deserialize failed");
-                return false;
-            }
-            value = ReadBytes<uint64_t>(buffer, offset);
-            break;
-        case 4: // std::string
-        {
-            uint32_t str_len = ReadBytes<uint32_t>(buffer, offset);
-            if (offset + str_len > buffer.size())
-            {
-                LOG_WARN("Deserialize failed");
-                return false;
-            }
-            value = std::string(reinterpret_cast<const char *>(buffer.data() + offset), str_len);
-            offset += str_len;
-            break;
-        }
-        case 5: // bool
-            if (offset + 1 > buffer.size())
-            {
-                LOG_WARN("Deserialize failed");
-                return false;
-            }
-            value = (buffer[offset++] != 0);
-            break;
-        case 6: // std::vector<uint8_t>
-        {
-            uint32_t vec_len = ReadBytes<uint32_t>(buffer, offset);
-            if (offset + vec_len > buffer.size())
-            {
-                LOG_WARN("Deserialize failed");
-                return false;
-            }
-            std::vector<uint8_t> vec(buffer.data() + offset, buffer.data() + offset + vec_len);
-            value = vec;
-            offset += vec_len;
-            break;
-        }
-        default:
-            break;
-        }
-
-        params[key] = value;
+        data = std::move(standard);
     }
 
-    return true;
-}
+    // 只校验结构，不分配内存
+    PacketView view;
+    if (!view.Parse(sessionId, data.data(), data.size()))
+    {
+        LOG_WARN("Deserialize failed");
+        return false;
+    }
 
-Packet::Packet()
-{
+    msgType = view.msgType;
+    body = std::move(data);
+    shared.reset();
     params.clear();
-    msgType = (MsgType)GetParam<uint32_t>("msgType", MsgType::None);
-    AddParam("msgType", static_cast<uint32_t>(msgType));
+    paramsReady = false;
+    return true;
 }
 
-Packet::Packet(uint64_t sessionId, MsgType type) : sessionId(sessionId), msgType(type)
+PacketView Packet::View() const
 {
-    AddParam("msgType", static_cast<uint32_t>(msgType));
+    const std::vector<uint8_t> &bytes = Bytes();
+    PacketView view;
+    view.Parse(sessionId, bytes.data(), bytes.size());
+    return view;
 }
 
-Packet::~Packet() {}
-
-std::vector<uint8_t> Packet::ToBytes() const
+MapType Packet::GetParams() const
 {
-    return Serialize();
+    return Params();
 }
 
-bool Packet::FromData(uint64_t sessionId, const std::vector<uint8_t> &data)
+int Packet::SetParams(const MapType &newParams)
 {
-    this->sessionId = sessionId;
-    return Deserialize(data);
+    body.clear();
+    shared.reset();
+    params = newParams;
+    params.erase("msgType");
+    paramsReady = true;
+    return 0;
 }
 
 int Packet::AddParam(const std::string &key, const ValueType &value)
 {
+    // 之后以 params 为准
+    Params();
+    body.clear();
+    shared.reset();
     params[key] = value;
     return 0;
 }
 
 int Packet::ClearParams()
 {
+    body.clear();
+    shared.reset();
     params.clear();
+    paramsReady = true;
     return 0;
 }
+
+void Packet::Share()
+{
+    if (shared)
+        return;
+    auto payload = std::make_shared<SharedPayload>();
+    payload->standard = body.empty() ? Serialize() : std::move(body);
+    CompactEncode(payload->standard.data(), payload->standard.size(), payload->compact);
+    // 两种表示都释放，副本只复制引用计数；字段在读取时再由共享负载解析
+    body = std::vector<uint8_t>();
+    params.clear();
+    paramsReady = false;
+    shared = std::move(payload);
+}
+
+Delivery DeliveryOf(MsgType msgType)
+{
+    switch (msgType)
+    {
+    case MsgType::updateUsersToLobby:
+    case MsgType::updateRoomsToLobby:
+        return Delivery::Coalesce;
+    case MsgType::ChatMessage:
+        return Delivery::Droppable;
+    default:
+        return Delivery::Critical;
+    }
+}
+
+size_t BatchEncodedSize(const Packet *packets, size_t count, WireFormat format)
+{
+    size_t size = 4;
+    for (size_t i = 0; i < count; i++)
+        size += 4 + packets[i].EncodedSize(format);
+    return size;
+}
+
+void WriteBatch(const Packet *packets, size_t count, uint8_t *out, WireFormat format)
+{
+    WireWriter writer{out};
+    WirePutU32(writer, (uint32_t)count);
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t len = packets[i].EncodedSize(format);
+        WirePutU32(writer, (uint32_t)len);
+        packets[i].WriteTo(writer.data + writer.size, format);
+        writer.size += len;
+    }
+}
+
+bool ReadBatch(uint64_t sessionId, const std::vector<uint8_t> &data, std::vector<Packet> &packets, WireFormat format)
+{
+    packets.clear();
+    size_t offset = 0;
+    uint32_t count = 0;
+    // 每个包至少带 4 字节长度，包数不可能超过剩余字节数的四分之一
+    if (!WireGetU32(data.data(), data.size(), offset, count) || count > (data.size() - offset) / 4)
+        return false;
+    packets.resize(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t len = 0;
+        if (!WireGetU32(data.data(), data.size(), offset, len) || len > data.size() - offset)
+            return false;
+        std::vector<uint8_t> bytes(data.begin() + offset, data.begin() + offset + len);
+        offset += len;
+        if (!packets[i].FromData(sessionId, std::move(bytes), format))
+            return false;
+    }
+    return offset == data.size();
+}
@@ -6,6 +6,7 @@
 #include <variant>
 #include <string>
 #include <map>
+#include <memory>
 
 #define BU99ER_SIZE 4096
 
@@ -71,33 +72,85 @@ enum MsgType : uint32_t
     Error = 9999,
 };
 
+// 出站积压时的投递策略（慢客户端背压）
+enum class Delivery : uint8_t
+{
+    Critical, // 必须送达：请求响应与对局消息（MakeMove、GameEnded 等）
+    Coalesce, // 全量状态推送，只保留最新一份（大厅用户 / 房间列表）
+    Droppable // 可丢弃（聊天）
+};
+
+Delivery DeliveryOf(MsgType msgType);
+
+// 负载的线路格式，握手时协商（见 Server::OnFrame 的 Pending 与 CompactCodec.h）
+enum class WireFormat : uint8_t
+{
+    Standard, // 定长整数、键名原样携带
+    Compact   // 键字典 + varint
+};
+
+class PacketView;
+struct WireWriter;
+
+// Share() 之后的只读负载：两种线路格式各编码一次，由该 Packet 的所有副本共用
+struct SharedPayload
+{
+    std::vector<uint8_t> standard;
+    std::vector<uint8_t> compact;
+};
+
+/**
+ * @brief 上层收发的消息
+ *
+ * 线路格式：[msgType 4B][字段数 4B] + 字段 * [[键长度 4B][键][值类型索引 1B][值]]，字段按键名字节序排列，
+ * 其中总含一个 msgType 字段。两种表示：
+ * - body：线路格式的字节。收到的数据原样保存，类型化消息（见 Message.h）直接编码到这里，都不经过 map，
+ *   读取时用 View() 在原地建立索引（见 PacketView.h）；
+ * - params：动态字段表，AddParam / GetParam 时才由 body 解析出来。
+ * 广播前调用 Share() 把负载冻结为引用计数的只读缓冲区，之后复制 Packet（如逐个改写 sessionId）
+ * 只增加引用计数，各会话发送时直接复制已编码的字节，只有帧头与加密按会话进行。
+ */
 class Packet
 {
 private:
-    // template <typename T>
-    // void WriteBytes(std::vector<uint8_t> &buffer, T value);
-    // template <typename T>
-    // T ReadBytes(const std::vector<uint8_t> &buffer, size_t &offset);
+    mutable std::vector<uint8_t> body; // 非空时为权威表示
+    mutable MapType params;            // body 为空时为权威表示，否则是按需解析的缓存
+    mutable bool paramsReady = true;   // params 是否与 body 一致
+    std::shared_ptr<const SharedPayload> shared; // 非空时为权威表示，params 只作按需解析的缓存
+
+    void Serialize(WireWriter &out) const; // 由 params 编码，空游标时只求长度
     std::vector<uint8_t> Serialize() const;
-    bool Deserialize(const std::vector<uint8_t> &buffer);
+    const MapType &Params() const;
+    const std::vector<uint8_t> &Bytes() const; // 标准格式的字节，只有 params 时先序列化为 body
 
 public:
     uint64_t sessionId;
     MsgType msgType;
-    MapType params;
 
     Packet();
     Packet(uint64_t sessionId, MsgType msgType);
-    ~Packet();
 
-    bool FromData(uint64_t sessionId, const std::vector<uint8_t> &data);
+    // 只校验结构并保存原始字节，字段在使用时再解析；紧凑格式先转换为标准格式
+    bool FromData(uint64_t sessionId, const std::vector<uint8_t> &data, WireFormat format = WireFormat::Standard);
+    bool FromData(uint64_t sessionId, std::vector<uint8_t> &&data, WireFormat format = WireFormat::Standard);
+
+    // 类型化消息（定义见 Message.h）：Of 直接编码为 body，As 直接由 body 解码；requestId 非零时附带 requestId 键
+    template <typename M>
+    static Packet Of(uint64_t sessionId, MsgType msgType, const M &msg, uint32_t requestId = 0);
+    template <typename M>
+    bool As(M &msg) const;
+
+    // 指向 body（或共享负载）的只读视图，不复制字段；只有 params 时先序列化为 body（两者保持一致）。
+    // 视图在 Packet 被修改或销毁前有效
+    PacketView View() const;
 
     // 解包 API
     template <typename T>
     T GetParam(const std::string &key, const T &defaultValue = T()) const
     {
-        auto it = params.find(key);
-        if (it == params.end())
+        const MapType &fields = Params();
+        auto it = fields.find(key);
+        if (it == fields.end())
         {
             return defaultValue;
         }
@@ -111,15 +164,28 @@ public:
         return defaultValue;
     }
 
-    // bool CheckParam(const std::string &key) const;
-
     MapType GetParams() const;
 
     // 组包 API
-    // int SetParams(const MapType &params);
+    int SetParams(const MapType &params);
     int AddParam(const std::string &key, const ValueType &value);
     int ClearParams();
-    std::vector<uint8_t> ToBytes() const;
+    // 冻结当前内容并预先编码两种格式，供扇出时共用；之后再修改字段会脱离共享负载
+    void Share();
+    std::vector<uint8_t> ToBytes(WireFormat format = WireFormat::Standard) const;
+
+    // 两遍编码：EncodedSize 给出确切长度，WriteTo 写入调用方预留好的缓冲区（如出站队列），不分配内存。
+    // 只有 params 的 Packet 选用紧凑格式时先序列化为 body 一次
+    size_t EncodedSize(WireFormat format = WireFormat::Standard) const;
+    void WriteTo(uint8_t *out, WireFormat format = WireFormat::Standard) const;
 };
 
+// 批量帧（Frame::Status::Batch）的负载：[包数 4B] + N * [[长度 4B][Packet 线路字节]]，
+// 每个 Packet 按会话协商的线路格式编码。同样两遍编码：先求长度，再写入预留好的缓冲区
+size_t BatchEncodedSize(const Packet *packets, size_t count, WireFormat format = WireFormat::Standard);
+void WriteBatch(const Packet *packets, size_t count, uint8_t *out, WireFormat format = WireFormat::Standard);
+// 逐个校验并解析，任一包非法或长度与负载不符时整批拒绝
+bool ReadBatch(uint64_t sessionId, const std::vector<uint8_t> &data, std::vector<Packet> &packets,
+               WireFormat format = WireFormat::Standard);
+
 #endif // PROTOCOL_H
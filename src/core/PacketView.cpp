@@ -0,0 +1,151 @@
+#include "PacketView.h"
+
+bool PacketView::Parse(uint64_t sessionId, const uint8_t *data, size_t len)
+{
+    this->sessionId = sessionId;
+    this->data = data;
+    this->len = len;
+    count = 0;
+
+    size_t offset = 0;
+    uint32_t type = 0, num = 0;
+    // 每个字段至少占数个字节，字段数不可能超过剩余长度，先挡住伪造的超大计数
+    if (!WireGetU32(data, len, offset, type) || !WireGetU32(data, len, offset, num) || num > len - offset)
+        return false;
+    overflow.clear();
+    if (num > INLINE_VIEW_FIELDS)
+        overflow.resize(num - INLINE_VIEW_FIELDS);
+    for (uint32_t i = 0; i < num; i++)
+    {
+        Field &field = i < INLINE_VIEW_FIELDS ? fields[i] : overflow[i - INLINE_VIEW_FIELDS];
+        if (!WireGetKey(data, len, offset, field.key) || offset >= len)
+            return false;
+        field.index = data[offset++];
+        field.offset = (uint32_t)offset;
+        if (!WireSkipValue(field.index, data, len, offset))
+            return false;
+    }
+    count = num;
+    msgType = static_cast<MsgType>(type);
+    return true;
+}
+
+const PacketView::Field *PacketView::Find(std::string_view key) const
+{
+    // 与 std::map 反序列化一致，重复的键以最后一个为准
+    for (size_t i = count; i > 0; i--)
+    {
+        const Field &field = At(i - 1);
+        if (field.key == key)
+            return &field;
+    }
+    return nullptr;
+}
+
+bool PacketView::Read(const Field &field, uint8_t &value) const
+{
+    size_t offset = field.offset;
+    return field.index == WireIndex<uint8_t>() && WireGetValue(field.index, data, len, offset, value);
+}
+
+bool PacketView::Read(const Field &field, uint32_t &value) const
+{
+    size_t offset = field.offset;
+    return (field.index == WireIndex<int>() || field.index == WireIndex<uint32_t>()) &&
+           WireGetValue(field.index, data, len, offset, value);
+}
+
+bool PacketView::Read(const Field &field, uint64_t &value) const
+{
+    size_t offset = field.offset;
+    return field.index == WireIndex<uint64_t>() && WireGetValue(field.index, data, len, offset, value);
+}
+
+bool PacketView::Read(const Field &field, bool &value) const
+{
+    size_t offset = field.offset;
+    return field.index == WireIndex<bool>() && WireGetValue(field.index, data, len, offset, value);
+}
+
+bool PacketView::Read(const Field &field, std::string_view &value) const
+{
+    size_t offset = field.offset;
+    uint32_t size = 0;
+    if (field.index != WireIndex<std::string>() || !WireGetU32(data, len, offset, size))
+        return false;
+    value = std::string_view(reinterpret_cast<const char *>(data + offset), size);
+    return true;
+}
+
+bool PacketView::Read(const Field &field, ByteSpan &value) const
+{
+    size_t offset = field.offset;
+    uint32_t size = 0;
+    if (field.index != WireIndex<std::vector<uint8_t>>() || !WireGetU32(data, len, offset, size))
+        return false;
+    value = ByteSpan{data + offset, size};
+    return true;
+}
+
+MapType PacketView::ToParams() const
+{
+    MapType params;
+    for (size_t i = 0; i < count; i++)
+    {
+        const Field &field = At(i);
+        if (field.key == "msgType")
+            continue;
+
+        ValueType value;
+        switch (field.index)
+        {
+        case 0: // int，沿用原有行为读作 uint32_t
+        case 2: // uint32_t
+        {
+            uint32_t v = 0;
+            Read(field, v);
+            value = v;
+            break;
+        }
+        case 1: // uint8_t
+        {
+            uint8_t v = 0;
+            Read(field, v);
+            value = v;
+            break;
+        }
+        case 3: // uint64_t
+        {
+            uint64_t v = 0;
+            Read(field, v);
+            value = v;
+            break;
+        }
+        case 4: // std::string
+        {
+            std::string_view v;
+            Read(field, v);
+            value = std::string(v);
+            break;
+        }
+        case 5: // bool
+        {
+            bool v = false;
+            Read(field, v);
+            value = v;
+            break;
+        }
+        case 6: // std::vector<uint8_t>
+        {
+            ByteSpan v;
+            Read(field, v);
+            value = std::vector<uint8_t>(v.data, v.data + v.size);
+            break;
+        }
+        default:
+            break;
+        }
+        params[std::string(field.key)] = std::move(value);
+    }
+    return params;
+}
@@ -0,0 +1,93 @@
+#ifndef PACKET_VIEW_H
+#define PACKET_VIEW_H
+
+#include "Message.h"
+
+#include <string_view>
+#include <vector>
+
+#define INLINE_VIEW_FIELDS 32 // 内联记录的字段数（正常消息不超过 5 个字段），更多的字段溢出到堆上，字段数不设上限
+
+// 指向序列化数据内部的字节区间
+struct ByteSpan
+{
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+};
+
+/**
+ * @brief 序列化数据包的只读视图
+ *
+ * Parse 一次遍历校验结构，并把每个字段的键与值位置记在内联数组中（超出部分记在 overflow）；之后按键取值、
+ * 解码类型化消息都直接读原始字节，字符串以 std::string_view、字节数组以 ByteSpan 返回，全程不分配内存。
+ * 视图不持有数据，底层缓冲区（帧负载或 Packet::body）须在使用期间保持有效且不被修改。
+ */
+class PacketView
+{
+public:
+    struct Field
+    {
+        std::string_view key;
+        uint32_t offset = 0; // 值在数据中的起始位置
+        uint8_t index = 0;   // 值类型索引
+    };
+
+    uint64_t sessionId = 0;
+    MsgType msgType = MsgType::None;
+
+    PacketView() = default;
+
+    bool Parse(uint64_t sessionId, const uint8_t *data, size_t len);
+
+    const uint8_t *Data() const { return data; }
+    size_t Size() const { return len; }
+    size_t Count() const { return count; }
+    const Field &At(size_t i) const { return i < INLINE_VIEW_FIELDS ? fields[i] : overflow[i - INLINE_VIEW_FIELDS]; }
+    const Field *Find(std::string_view key) const;
+
+    // T 可为 uint8_t / uint32_t / uint64_t / bool / std::string_view / ByteSpan；
+    // 字段不存在或类型不符时返回默认值（uint32_t 兼容 int 索引，与 Packet::GetParam 一致）
+    template <typename T>
+    T Get(std::string_view key, const T &defaultValue = T()) const
+    {
+        const Field *field = Find(key);
+        T value = defaultValue;
+        if (!field || !Read(*field, value))
+            return defaultValue;
+        return value;
+    }
+
+    // 按索引逐字段解码，未知键跳过
+    template <typename M>
+    bool As(M &msg) const
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            const Field &field = At(i);
+            size_t offset = field.offset;
+            if (!DecodeField(field.key, field.index, data, len, offset, msg,
+                             std::make_index_sequence<MessageLayout<M>::count>()))
+                return false;
+        }
+        return true;
+    }
+
+    MapType ToParams() const; // 复制为动态字段表（不含 msgType 键），供开放格式的消息使用
+    uint32_t RequestId() const { return Get<uint32_t>(REQUEST_ID_KEY); } // 未携带时为 0
+
+private:
+    const uint8_t *data = nullptr;
+    size_t len = 0;
+    size_t count = 0;
+    Field fields[INLINE_VIEW_FIELDS];
+    std::vector<Field> overflow; // 第 INLINE_VIEW_FIELDS 个之后的字段，只有超长的数据包才分配
+
+    bool Read(const Field &field, uint8_t &value) const;
+    bool Read(const Field &field, uint32_t &value) const;
+    bool Read(const Field &field, uint64_t &value) const;
+    bool Read(const Field &field, bool &value) const;
+    bool Read(const Field &field, std::string_view &value) const;
+    bool Read(const Field &field, ByteSpan &value) const;
+};
+
+#endif // PACKET_VIEW_H
@@ -1,6 +1,7 @@
 #include "Database.h"
 #include "Logger.h"
 #include <sstream>
+#include <mutex>
 extern "C"
 {
 #include "sqlite3.h"
@@ -54,6 +55,7 @@ bool Database::Initialize(const std::string &dbPath)
 
 bool Database::Close()
 {
+    std::lock_guard<std::mutex> lock(mutex);
     if (!initialized || db == nullptr)
         return true;
 
@@ -79,6 +81,7 @@ bool Database::Execute(const std::string &sql)
 
     LOG_TRACE("Executing SQL: " + sql);
 
+    std::lock_guard<std::mutex> lock(mutex);
     char *errMsg = nullptr;
     int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg);
 
@@ -103,6 +106,7 @@ std::vector<std::vector<std::string>> Database::Query(const std::string &sql)
         return result;
     }
 
+    std::lock_guard<std::mutex> lock(mutex);
     sqlite3_stmt *stmt = nullptr;
     int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
 
@@ -140,6 +144,7 @@ std::vector<std::string> Database::QueryRow(const std::string &sql)
         return row;
     }
 
+    std::lock_guard<std::mutex> lock(mutex);
     sqlite3_stmt *stmt = nullptr;
     int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
 
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <cstdint>
 
 // 前向声明
@@ -15,6 +16,9 @@ class Database
 private:
     sqlite3 *db;
     bool initialized;
+    // 所有线程共用一个连接：注册等写库请求在工作线程上执行，不持有上层逻辑锁，
+    // 每次访问连接（执行、预编译、取错误信息）都须持有此锁
+    std::mutex mutex;
 
     // 私有构造函数（单例模式）
     Database();
@@ -10,11 +10,55 @@
 #include <cstdint>
 #include <limits>
 #include <chrono>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <sstream>
 
 #define PORT 8080
+#define HANDOFF_PATH "gomoku.handoff.sock" // 热重启交接路径（相对工作目录）
+#define IDENTITY_PATH "gomoku.identity"    // 服务器长期身份种子，首次启动时生成；热重启前后须一致
 
-int main()
+// 载入身份种子，不存在时生成并保存；客户端凭日志中的公钥验证握手
+static bool LoadIdentity(Server &server)
 {
+    std::vector<uint8_t> seed(IDENTITY_SEED_SIZE);
+    std::ifstream in(IDENTITY_PATH, std::ios::binary);
+    if (!in.read(reinterpret_cast<char *>(seed.data()), seed.size()))
+    {
+        seed = GenerateRandomBytes(IDENTITY_SEED_SIZE);
+        std::ofstream out(IDENTITY_PATH, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char *>(seed.data()), seed.size()))
+        {
+            LOG_ERROR("Failed to write identity to " IDENTITY_PATH);
+            return false;
+        }
+        // 私钥种子只允许本用户读写
+        std::error_code ec;
+        std::filesystem::permissions(IDENTITY_PATH, std::filesystem::perms::owner_read | std::filesystem::perms::owner_write, ec);
+        LOG_INFO("Generated new server identity in " IDENTITY_PATH);
+    }
+    if (!server.SetIdentity(seed))
+    {
+        LOG_ERROR("Invalid server identity in " IDENTITY_PATH);
+        return false;
+    }
+
+    std::ostringstream hex;
+    for (uint8_t byte : server.GetIdentityKey())
+        hex << std::hex << std::setw(2) << std::setfill('0') << (int)byte;
+    LOG_INFO("Server identity public key: " + hex.str());
+    return true;
+}
+
+// 用法：GomokuBackend [reactor线程数] [--hot-restart]
+// --hot-restart：从正在运行的旧进程接管监听 Socket 与全部连接，旧进程交接后退出
+int main(int argc, char **argv)
+{
+    // 退出信号交给 Server 的 signalfd 处理，必须在任何线程创建之前屏蔽
+    Server::BlockShutdownSignals();
     Logger::init("./gomoku.log", LogLevel::DEBUG, true);
     LOG_DEBUG("============= Initializing Gomoku-backend =============");
 
@@ -26,15 +70,60 @@ int main()
     }
     ObjectManager objMgr;
     Server server;
+    server.SetPort(PORT);
+    server.SetHandleSignals(true);
+    server.SetHandshakeThreads(2); // 握手运算与注册写库不占用 Reactor 线程
+    bool hotRestart = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--hot-restart") == 0)
+            hotRestart = true;
+        else
+            server.SetThreadCount(std::atoi(argv[i]));
+    }
+    server.SetHandoffPath(HANDOFF_PATH, hotRestart);
+    // 没有 Ed25519 的平台上 Server::Init 会报错并关闭加密，身份密钥无从使用
+    if (KeyAgreementSupported() && !LoadIdentity(server))
+    {
+        Logger::shutdown();
+        return 1;
+    }
     Handler msgHandler(objMgr, [&server](const Packet &packet)
                        { server.SendPacket(packet); });
     Notifier broadcaster(objMgr);
 
     server.SetOnPacketCallback([&msgHandler](const Packet &packet)
                                { msgHandler.HandlePacket(packet); });
+    msgHandler.SetAsyncCallback([&server](uint64_t sessionId, std::function<void()> work, std::function<void()> done)
+                                { server.RunAsync(sessionId, std::move(work), std::move(done)); });
     broadcaster.SetSendPacketCallback([&server](const Packet &packet)
                                       { server.SendPacket(packet); });
 
+    // 热重启时随会话交接登录用户（sessionId -> userId 映射）；房间、座位与对局只在内存中，不迁移。
+    // 因此只有未登录或停留在大厅的会话能无感知地跨过重启，房间内的玩家在新进程中回到大厅，
+    // 对局中途重启会丢失该局。需要保留对局时应在无进行中对局时再重启
+    server.SetHandoffCallbacks(
+        [&objMgr](uint64_t sessionId)
+        {
+            std::vector<uint8_t> state;
+            uint64_t userId = objMgr.GetUserIdBySessionId(sessionId);
+            if (userId != 0)
+                state.assign(reinterpret_cast<const uint8_t *>(&userId), reinterpret_cast<const uint8_t *>(&userId) + sizeof(userId));
+            uint64_t roomId = userId != 0 ? objMgr.GetRoomIdByUserId(userId) : 0;
+            if (roomId != 0)
+                LOG_WARN("Hot restart: user " + std::to_string(userId) + " leaves room " + std::to_string(roomId) +
+                         ", room and game state are not handed off");
+            return state;
+        },
+        [&objMgr](uint64_t sessionId, const std::vector<uint8_t> &state)
+        {
+            uint64_t userId = 0;
+            if (state.size() != sizeof(userId))
+                return;
+            std::memcpy(&userId, state.data(), sizeof(userId));
+            objMgr.MapSessionToUser(sessionId, userId);
+        });
+
     LOG_DEBUG("=======================================================");
 
     if (server.Init() != 0)
@@ -45,6 +134,11 @@ int main()
     }
     server.Run();
     server.Stop();
+
+    // 所有 Reactor 已退出，不会再有 Handler 写库；关闭数据库完成最后的落盘
+    uint64_t start = GetTimeMS();
+    db.Close();
+    LOG_INFO("Database closed in " + std::to_string(GetTimeMS() - start) + " ms");
     Logger::shutdown();
     return 0;
 }
@@ -0,0 +1,134 @@
+#include "AdmissionControl.h"
+
+#define INITIAL_CAPACITY 256 // 必须为 2 的幂
+
+AdmissionControl::AdmissionControl()
+    : maxConnections(0), maxPerAddress(0), connections(0),
+      entries(INITIAL_CAPACITY, Entry{0, 0}), mask(INITIAL_CAPACITY - 1), used(0)
+{
+}
+
+void AdmissionControl::SetLimits(size_t maxConnections, uint32_t maxPerAddress)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->maxConnections = maxConnections;
+    this->maxPerAddress = maxPerAddress;
+}
+
+AdmissionControl::Result AdmissionControl::Admit(uint32_t addr)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (maxConnections != 0 && connections >= maxConnections)
+        return TooManyConnections;
+
+    Entry *entry = Find(addr);
+    if (maxPerAddress != 0 && entry && entry->count >= maxPerAddress)
+        return TooManyFromAddress;
+    if (!entry)
+        entry = &Insert(addr);
+
+    entry->count++;
+    connections++;
+    return Admitted;
+}
+
+void AdmissionControl::Adopt(uint32_t addr)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry *entry = Find(addr);
+    if (!entry)
+        entry = &Insert(addr);
+    entry->count++;
+    connections++;
+}
+
+void AdmissionControl::Release(uint32_t addr)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry *entry = Find(addr);
+    if (!entry)
+        return;
+    connections--;
+    if (--entry->count == 0)
+        Erase(entry);
+}
+
+void AdmissionControl::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.assign(INITIAL_CAPACITY, Entry{0, 0});
+    mask = INITIAL_CAPACITY - 1;
+    used = 0;
+    connections = 0;
+}
+
+size_t AdmissionControl::Connections()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return connections;
+}
+
+uint32_t AdmissionControl::ConnectionsFrom(uint32_t addr)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry *entry = Find(addr);
+    return entry ? entry->count : 0;
+}
+
+AdmissionControl::Entry *AdmissionControl::Find(uint32_t addr)
+{
+    for (size_t i = Home(addr); entries[i].count != 0; i = (i + 1) & mask)
+    {
+        if (entries[i].addr == addr)
+            return &entries[i];
+    }
+    return nullptr;
+}
+
+AdmissionControl::Entry &AdmissionControl::Insert(uint32_t addr)
+{
+    // 装载因子不超过 1/2
+    if ((used + 1) * 2 > entries.size())
+        Grow();
+
+    size_t i = Home(addr);
+    while (entries[i].count != 0)
+        i = (i + 1) & mask;
+    entries[i] = {addr, 0};
+    used++;
+    return entries[i];
+}
+
+void AdmissionControl::Erase(Entry *entry)
+{
+    // 后移回填，保持探测链连续，不留墓碑
+    size_t hole = entry - entries.data();
+    for (size_t j = (hole + 1) & mask; entries[j].count != 0; j = (j + 1) & mask)
+    {
+        size_t home = Home(entries[j].addr);
+        if (((j - home) & mask) >= ((j - hole) & mask))
+        {
+            entries[hole] = entries[j];
+            hole = j;
+        }
+    }
+    entries[hole] = {0, 0};
+    used--;
+}
+
+void AdmissionControl::Grow()
+{
+    std::vector<Entry> old;
+    old.swap(entries);
+    entries.assign(old.size() * 2, Entry{0, 0});
+    mask = entries.size() - 1;
+    for (const Entry &e : old)
+    {
+        if (e.count == 0)
+            continue;
+        size_t i = Home(e.addr);
+        while (entries[i].count != 0)
+            i = (i + 1) & mask;
+        entries[i] = e;
+    }
+}
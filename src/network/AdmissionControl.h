@@ -0,0 +1,63 @@
+#ifndef ADMISSION_CONTROL_H
+#define ADMISSION_CONTROL_H
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief 连接准入控制：全局连接上限 + 每个来源 IP 的并发连接上限
+ *
+ * accept 之后、注册到 Poller 与创建 SessionContext 之前调用 Admit，
+ * 拒绝时只需关闭 fd，不做任何密钥计算。各 Reactor 共享一个实例（同一 IP 的连接
+ * 会被 SO_REUSEPORT 分散到不同 Reactor），只在建连 / 断开时加锁。
+ * 来源 IP 计数存放在开放寻址的紧凑表中（每项 8 字节），计数归零即删除。
+ */
+class AdmissionControl
+{
+public:
+    enum Result
+    {
+        Admitted,
+        TooManyConnections, // 超过全局连接上限
+        TooManyFromAddress, // 超过单 IP 并发上限
+    };
+
+    AdmissionControl();
+
+    // 0 表示不限制
+    void SetLimits(size_t maxConnections, uint32_t maxPerAddress);
+
+    Result Admit(uint32_t addr); // addr 为网络字节序的 IPv4 地址
+    void Release(uint32_t addr);
+    void Adopt(uint32_t addr); // 计入已存在的连接（热重启接管），不受上限约束
+    void Clear();
+
+    size_t Connections();
+    uint32_t ConnectionsFrom(uint32_t addr);
+
+private:
+    struct Entry
+    {
+        uint32_t addr;
+        uint32_t count; // 0 表示空桶
+    };
+
+    std::mutex mutex;
+    size_t maxConnections;
+    uint32_t maxPerAddress;
+    size_t connections;
+
+    std::vector<Entry> entries;
+    size_t mask;
+    size_t used;
+
+    size_t Home(uint32_t addr) const { return (size_t)((addr * 2654435761u) >> 8) & mask; }
+    Entry *Find(uint32_t addr);
+    Entry &Insert(uint32_t addr);
+    void Erase(Entry *entry);
+    void Grow();
+};
+
+#endif // ADMISSION_CONTROL_H
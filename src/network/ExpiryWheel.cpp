@@ -0,0 +1,111 @@
+#include "ExpiryWheel.h"
+
+#define DETACHED -2 // 已从桶中取出，正在等待到期回调
+
+ExpiryWheel::ExpiryWheel() : tickMs(1000), cursor(0), heads(1, -1), count(0) {}
+
+void ExpiryWheel::Init(uint64_t tickMs, size_t buckets)
+{
+    this->tickMs = tickMs == 0 ? 1 : tickMs;
+    heads.assign(buckets == 0 ? 1 : buckets, -1);
+    links.clear();
+    cursor = 0;
+    count = 0;
+}
+
+void ExpiryWheel::Schedule(int fd, uint64_t deadline)
+{
+    if (fd < 0)
+        return;
+    if ((size_t)fd >= links.size())
+        links.resize((size_t)fd + 1);
+    Unlink(fd);
+
+    // 已经扫过的 tick 不会再被扫描，截止时间早于游标的挂到游标所在的桶（下一次推进时处理）
+    uint64_t tick = deadline / tickMs;
+    if (cursor == 0)
+        cursor = tick;
+    else if (tick < cursor)
+        tick = cursor;
+    int bucket = (int)(tick % heads.size());
+
+    Link &link = links[fd];
+    link.deadline = deadline;
+    link.bucket = bucket;
+    link.prev = -1;
+    link.next = heads[bucket];
+    if (link.next >= 0)
+        links[link.next].prev = fd;
+    heads[bucket] = fd;
+    count++;
+}
+
+void ExpiryWheel::Cancel(int fd)
+{
+    if (fd < 0 || (size_t)fd >= links.size())
+        return;
+    Unlink(fd);
+}
+
+void ExpiryWheel::Unlink(int fd)
+{
+    Link &link = links[fd];
+    if (link.bucket == -1)
+        return;
+    if (link.bucket >= 0)
+    {
+        if (link.prev >= 0)
+            links[link.prev].next = link.next;
+        else
+            heads[link.bucket] = link.next;
+        if (link.next >= 0)
+            links[link.next].prev = link.prev;
+    }
+    link.prev = link.next = link.bucket = -1;
+    count--;
+}
+
+void ExpiryWheel::Advance(uint64_t now, const std::function<uint64_t(int)> &onDue)
+{
+    uint64_t target = now / tickMs;
+    if (cursor == 0)
+        cursor = target;
+    if (target < cursor)
+        return;
+    // 长时间未推进时最多扫一圈，每个桶里的条目都会按截止时间重新判断
+    if (target - cursor >= heads.size())
+        cursor = target + 1 - heads.size();
+
+    std::vector<int> due;
+    while (cursor <= target)
+    {
+        // 先前移游标，回调中重新挂入的条目落在后续的桶里
+        int bucket = (int)(cursor % heads.size());
+        cursor++;
+        // 先整桶摘下，回调中的 Schedule / Cancel 不会影响遍历
+        for (int fd = heads[bucket]; fd >= 0; fd = links[fd].next)
+        {
+            links[fd].bucket = DETACHED;
+            due.push_back(fd);
+        }
+        heads[bucket] = -1;
+
+        for (int fd : due)
+        {
+            Link &link = links[fd];
+            if (link.bucket != DETACHED)
+                continue; // 回调中已被取消或重新挂入
+            link.prev = link.next = link.bucket = -1;
+            count--;
+            if (link.deadline > now)
+            {
+                Schedule(fd, link.deadline); // 超出一圈的截止时间
+                continue;
+            }
+            uint64_t next = onDue(fd);
+            if (next != 0)
+                Schedule(fd, next);
+        }
+        due.clear();
+    }
+}
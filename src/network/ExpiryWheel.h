@@ -0,0 +1,53 @@
+#ifndef EXPIRY_WHEEL_H
+#define EXPIRY_WHEEL_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+/**
+ * @brief Reactor 线程私有的超时时间轮，按 fd 索引
+ *
+ * 每个 fd 至多挂在一个桶里（侵入式双向链表，链接存放在按 fd 下标的数组中），
+ * Schedule / Cancel 均为 O(1)。会话活跃时不必触碰时间轮：调用方只更新自己的最后活跃时间，
+ * 桶到期时由回调判断是否真的超时，未超时则返回新的截止时间重新挂入（惰性续期）。
+ * 超出轮一圈的截止时间同样在到期检查时重新挂入，因此桶数只影响精度与扫描次数。
+ */
+class ExpiryWheel
+{
+public:
+    ExpiryWheel();
+
+    // tickMs 为精度，buckets 为桶数；会清空已有条目
+    void Init(uint64_t tickMs, size_t buckets);
+
+    void Schedule(int fd, uint64_t deadline); // 已挂入则移动到新的截止时间
+    void Cancel(int fd);
+
+    // 推进到 now，对每个到期的 fd 调用 onDue，返回新的截止时间则重新挂入，返回 0 表示移除
+    void Advance(uint64_t now, const std::function<uint64_t(int)> &onDue);
+
+    bool Empty() const { return count == 0; }
+    size_t Size() const { return count; }
+    uint64_t TickMs() const { return tickMs; }
+
+private:
+    struct Link
+    {
+        int prev = -1;
+        int next = -1;
+        int bucket = -1; // -1 表示未挂入
+        uint64_t deadline = 0;
+    };
+
+    uint64_t tickMs;
+    uint64_t cursor; // 下一个待处理的 tick 编号
+    std::vector<int> heads;
+    std::vector<Link> links;
+    size_t count;
+
+    void Unlink(int fd);
+};
+
+#endif // EXPIRY_WHEEL_H
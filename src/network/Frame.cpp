@@ -3,9 +3,6 @@
 #include <iostream>
 #include <cstring>
 
-#define BUFFER_SIZE 4096
-#define MAX_FRAME_SIZE 1024
-
 Frame::Frame(Status status, uint64_t sessionId, std::array<uint8_t, 16> iv, std::vector<uint8_t> data)
 {
     head.magic = MAGIC_NUMBER;
@@ -16,61 +13,29 @@ Frame::Frame(Status status, uint64_t sessionId, std::array<uint8_t, 16> iv, std:
     this->data = data;
 }
 
-bool Frame::ReadHeader(std::vector<uint8_t> &buffer)
+bool Frame::ReadHeader(const uint8_t *buffer, size_t len)
 {
-    if (buffer.size() < sizeof(Header) || buffer.size() > MAX_FRAME_SIZE)
+    if (len < sizeof(Header))
         return false;
     uint32_t magic = 0;
-    std::copy_n(buffer.begin(), 4, reinterpret_cast<uint8_t *>(&magic));
+    std::memcpy(&magic, buffer, 4);
     if (magic != MAGIC_NUMBER)
         return false;
 
-    std::copy_n(buffer.data(), sizeof(Header), reinterpret_cast<uint8_t *>(&head));
-    return true;
+    std::memcpy(&head, buffer, sizeof(Header));
+    return head.length >= sizeof(Header) && head.length <= MAX_FRAME_SIZE;
 }
 
-bool Frame::ReadBytes(std::vector<uint8_t> &buffer)
+bool Frame::ReadBytes(const uint8_t *buffer, size_t len)
 {
-    if (!ReadHeader(buffer))
+    if (!ReadHeader(buffer, len))
         return false;
-    if (head.length > buffer.size() || head.length > MAX_FRAME_SIZE || head.length < sizeof(Header))
+    if (head.length > len)
         return false;
-    if (head.length == sizeof(Header))
-        return true;
-    data.resize(head.length - sizeof(Header));
-    std::copy_n(buffer.data() + sizeof(Header), head.length - sizeof(Header), data.data());
+    data.assign(buffer + sizeof(Header), buffer + head.length);
     return true;
 }
 
-bool Frame::ReadStream(std::vector<uint8_t> &buffer)
-{
-    while (buffer.size() >= 4)
-    {
-        // 头部校验
-        if (!ReadHeader(buffer))
-        {
-            buffer.erase(buffer.begin());
-            continue;
-        }
-        // 检测半包
-        if (buffer.size() < head.length)
-        {
-            return false;
-        }
-        // 尝试读取数据
-        if (!ReadBytes(buffer))
-        {
-            buffer.erase(buffer.begin());
-            continue;
-        }
-        // 成功读取一个完整的包
-        buffer.erase(buffer.begin(), buffer.begin() + head.length);
-        return true;
-    }
-
-    return false; // 剩余数据不足一个 Header
-}
-
 bool Frame::ParseKey(std::vector<uint8_t> &key, int len)
 {
     if (data.size() < len)
@@ -80,12 +45,27 @@ bool Frame::ParseKey(std::vector<uint8_t> &key, int len)
     return true;
 }
 
+std::array<uint8_t, 12> Frame::AuthData() const
+{
+    std::array<uint8_t, 12> aad;
+    uint32_t status = head.status;
+    uint64_t sessionId = head.sessionId;
+    std::memcpy(aad.data(), &status, 4);
+    std::memcpy(aad.data() + 4, &sessionId, 8);
+    return aad;
+}
+
 std::vector<uint8_t> Frame::ToBytes()
 {
-    std::vector<uint8_t> buffer(MAX_FRAME_SIZE);
-    head.length = sizeof(Header) + data.size();
-    std::copy_n(reinterpret_cast<uint8_t *>(&head), sizeof(Header), buffer.data());
-    std::copy_n(data.data(), data.size(), buffer.data() + sizeof(Header));
-    buffer.resize(head.length);
+    std::vector<uint8_t> buffer(Size());
+    WriteTo(buffer.data());
     return buffer;
 }
+
+void Frame::WriteTo(uint8_t *out)
+{
+    head.length = (uint32_t)Size();
+    std::memcpy(out, &head, sizeof(Header));
+    if (!data.empty())
+        std::memcpy(out + sizeof(Header), data.data(), data.size());
+}
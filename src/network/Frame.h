@@ -6,6 +6,7 @@
 #include <cstdint>
 
 #define MAGIC_NUMBER 0x12345678
+#define MAX_FRAME_SIZE 1024 // 含帧头的最大帧长度
 
 // [加密位 1bit]
 // 包头
@@ -27,6 +28,10 @@ public:
         NoSession,      // 无效会话
         InvalidRequest, // 无效包
         Error,          // 错误
+        Resumed,        // 会话已恢复（断线重连）
+        Ping,           // 轻量心跳：[客户端时间戳 8B][回显的服务端时间戳 8B]，不加密
+        Pong,           // 心跳应答：[回显的客户端时间戳 8B][服务端时间戳 8B]
+        Batch,          // 批量：一帧携带多个 Packet（格式见 Packet.h 的 WriteBatch），按序处理，应答同样合并为 Batch 帧
     };
     struct Header
     {
@@ -40,10 +45,13 @@ public:
     Header head;
     std::vector<uint8_t> data;
     Frame(Status status = Status::Active, uint64_t sessionId = 0, std::array<uint8_t, 16> iv = {}, std::vector<uint8_t> data = {});
-    bool ReadStream(std::vector<uint8_t> &buffer);
-    bool ReadHeader(std::vector<uint8_t> &buffer);
-    bool ReadBytes(std::vector<uint8_t> &buffer);
+    bool ReadHeader(const uint8_t *buffer, size_t len);
+    bool ReadBytes(const uint8_t *buffer, size_t len);
     std::vector<uint8_t> ToBytes();
+    size_t Size() const { return sizeof(Header) + data.size(); }
+    void WriteTo(uint8_t *out); // 写入 Size() 字节的帧头与负载，不分配内存
+    // 加密负载的附加认证数据（status + sessionId），帧头被篡改或转发到其他会话时校验失败
+    std::array<uint8_t, 12> AuthData() const;
     bool ParseKey(std::vector<uint8_t> &key, int len);
 };
 
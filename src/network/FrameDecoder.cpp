@@ -0,0 +1,87 @@
+#include "FrameDecoder.h"
+
+#include <cstring>
+#include <algorithm>
+
+// 魔数按内存字节序排列（帧头按主机字节序整体拷贝）
+static const uint32_t kMagic = MAGIC_NUMBER;
+static const uint8_t *const kMagicBytes = reinterpret_cast<const uint8_t *>(&kMagic);
+
+// 返回第一个可能是魔数起点的偏移；末尾不足 4 字节但与魔数前缀一致的也视为候选
+static size_t FindMagic(const uint8_t *data, size_t len)
+{
+    size_t offset = 0;
+    while (offset < len)
+    {
+        const void *hit = std::memchr(data + offset, kMagicBytes[0], len - offset);
+        if (!hit)
+            return len;
+        offset = static_cast<const uint8_t *>(hit) - data;
+        size_t avail = std::min(len - offset, sizeof(kMagic));
+        if (std::memcmp(data + offset, kMagicBytes, avail) == 0)
+            return offset;
+        offset++;
+    }
+    return len;
+}
+
+void FrameDecoder::Feed(const uint8_t *data, size_t len)
+{
+    buffer.Reserve(len);
+    std::memcpy(buffer.WritePtr(), data, len);
+    buffer.Commit(len);
+}
+
+void FrameDecoder::Skip(size_t n)
+{
+    buffer.Consume(n);
+    skipped += n;
+}
+
+bool FrameDecoder::Next(Frame &frame)
+{
+    while (true)
+    {
+        switch (state)
+        {
+        case State::SeekMagic:
+        {
+            size_t offset = FindMagic(buffer.ReadPtr(), buffer.Readable());
+            if (offset > 0)
+                Skip(offset);
+            if (buffer.Readable() < sizeof(kMagic))
+                return false;
+            state = State::Header;
+            break;
+        }
+        case State::Header:
+            if (buffer.Readable() < sizeof(Frame::Header))
+                return false;
+            std::memcpy(&head, buffer.ReadPtr(), sizeof(Frame::Header));
+            // 长度非法说明不是真正的帧头，跳过该魔数继续扫描，负载一个字节也不缓存
+            if (head.length < sizeof(Frame::Header) || head.length > MAX_FRAME_SIZE)
+            {
+                Skip(1);
+                state = State::SeekMagic;
+                break;
+            }
+            state = State::Payload;
+            break;
+        case State::Payload:
+            if (buffer.Readable() < head.length)
+                return false;
+            frame.head = head;
+            frame.data.assign(buffer.ReadPtr() + sizeof(Frame::Header), buffer.ReadPtr() + head.length);
+            buffer.Consume(head.length);
+            state = State::SeekMagic;
+            return true;
+        }
+    }
+}
+
+void FrameDecoder::Reset()
+{
+    buffer.Release();
+    state = State::SeekMagic;
+    skipped = 0;
+}
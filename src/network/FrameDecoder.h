@@ -0,0 +1,51 @@
+#ifndef FRAME_DECODER_H
+#define FRAME_DECODER_H
+
+#include "Frame.h"
+#include "RecvBuffer.h"
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief 增量帧解码器（每连接一个）
+ *
+ * 持有连接的接收缓冲区，并跨 recv 记住解析进度：
+ *   SeekMagic -> 用 memchr 扫描魔数首字节，一次跳过整段垃圾数据
+ *   Header    -> 帧头凑齐后立即校验 length，非法则丢弃该候选，不等待负载
+ *   Payload   -> 帧头已校验，只等负载字节到齐
+ * 损坏的数据流整体为 O(n)，每个字节至多被检查常数次。
+ */
+class FrameDecoder
+{
+public:
+    enum class State
+    {
+        SeekMagic,
+        Header,
+        Payload,
+    };
+
+    FrameDecoder() = default;
+
+    RecvBuffer &Buffer() { return buffer; }
+    void Feed(const uint8_t *data, size_t len); // 直接追加数据（测试与离线解码用）
+
+    // 解出下一个完整帧，数据不足时返回 false 并保留进度
+    bool Next(Frame &frame);
+
+    void Reset(); // 断开时释放缓冲区并复位状态
+
+    State GetState() const { return state; }
+    uint64_t SkippedBytes() const { return skipped; } // 重同步时丢弃的字节数
+
+private:
+    RecvBuffer buffer;
+    State state = State::SeekMagic;
+    Frame::Header head{};
+    uint64_t skipped = 0;
+
+    void Skip(size_t n);
+};
+
+#endif // FRAME_DECODER_H
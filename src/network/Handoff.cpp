@@ -0,0 +1,338 @@
+#include "Handoff.h"
+
+#ifdef _WIN32
+
+// Windows 没有 SCM_RIGHTS，热重启不可用
+bool SendHandoff(int, const HandoffState &) { return false; }
+bool RecvHandoff(int, HandoffState &) { return false; }
+int ListenHandoff(const std::string &) { return -1; }
+int ConnectHandoff(const std::string &) { return -1; }
+bool HandoffPeerAllowed(int, uint32_t) { return false; }
+
+#else
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+#include <algorithm>
+
+#define HANDOFF_MAGIC 0x46484F47 // "GOHF"
+#define HANDOFF_VERSION 5
+#define MAX_FDS_PER_MSG 200      // 低于内核 SCM_MAX_FD (253)
+#define MAX_STATE_SIZE (1u << 30)
+
+// --- 状态块编解码 ---
+
+template <typename T>
+static void Put(std::vector<uint8_t> &out, T value)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+static void PutBytes(std::vector<uint8_t> &out, const std::vector<uint8_t> &bytes)
+{
+    Put<uint32_t>(out, (uint32_t)bytes.size());
+    out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+struct Reader
+{
+    const std::vector<uint8_t> &in;
+    size_t offset = 0;
+    bool ok = true;
+
+    template <typename T>
+    T Get()
+    {
+        T value{};
+        if (!ok || offset + sizeof(T) > in.size())
+        {
+            ok = false;
+            return value;
+        }
+        std::memcpy(&value, in.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    std::vector<uint8_t> GetBytes()
+    {
+        uint32_t len = Get<uint32_t>();
+        if (!ok || offset + len > in.size())
+        {
+            ok = false;
+            return {};
+        }
+        std::vector<uint8_t> bytes(in.begin() + offset, in.begin() + offset + len);
+        offset += len;
+        return bytes;
+    }
+};
+
+static std::vector<uint8_t> Encode(const HandoffState &state)
+{
+    std::vector<uint8_t> out;
+    Put<uint32_t>(out, HANDOFF_MAGIC);
+    Put<uint32_t>(out, HANDOFF_VERSION);
+    Put<uint32_t>(out, state.reactorCount);
+    Put<uint32_t>(out, (uint32_t)state.listenFds.size());
+    Put<uint32_t>(out, (uint32_t)state.sessions.size());
+    for (const HandoffSession &s : state.sessions)
+    {
+        Put<uint32_t>(out, s.reactor);
+        Put<uint32_t>(out, s.peerAddr);
+        Put<uint64_t>(out, s.sessionId);
+        Put<uint64_t>(out, s.idleMs);
+        Put<uint8_t>(out, s.active ? 1 : 0);
+        Put<uint32_t>(out, s.resumeCounter);
+        Put<uint8_t>(out, s.wireFormat);
+        Put<uint64_t>(out, s.replayTop);
+        Put<uint64_t>(out, s.replayBitmap);
+        PutBytes(out, s.sk);
+        PutBytes(out, s.pk);
+        PutBytes(out, s.pk2);
+        PutBytes(out, s.iv);
+        PutBytes(out, s.sharedKey);
+        PutBytes(out, s.resumeKey);
+        PutBytes(out, s.sig);
+        PutBytes(out, s.inbound);
+        PutBytes(out, s.outbound);
+        PutBytes(out, s.appState);
+    }
+    return out;
+}
+
+static bool Decode(const std::vector<uint8_t> &in, HandoffState &state, uint32_t &listenCount)
+{
+    Reader r{in};
+    if (r.Get<uint32_t>() != HANDOFF_MAGIC || r.Get<uint32_t>() != HANDOFF_VERSION)
+        return false;
+    state.reactorCount = r.Get<uint32_t>();
+    listenCount = r.Get<uint32_t>();
+    uint32_t sessionCount = r.Get<uint32_t>();
+    if (!r.ok || sessionCount > in.size())
+        return false;
+
+    state.sessions.resize(sessionCount);
+    for (HandoffSession &s : state.sessions)
+    {
+        s.reactor = r.Get<uint32_t>();
+        s.peerAddr = r.Get<uint32_t>();
+        s.sessionId = r.Get<uint64_t>();
+        s.idleMs = r.Get<uint64_t>();
+        s.active = r.Get<uint8_t>() != 0;
+        s.resumeCounter = r.Get<uint32_t>();
+        s.wireFormat = r.Get<uint8_t>();
+        s.replayTop = r.Get<uint64_t>();
+        s.replayBitmap = r.Get<uint64_t>();
+        s.sk = r.GetBytes();
+        s.pk = r.GetBytes();
+        s.pk2 = r.GetBytes();
+        s.iv = r.GetBytes();
+        s.sharedKey = r.GetBytes();
+        s.resumeKey = r.GetBytes();
+        s.sig = r.GetBytes();
+        s.inbound = r.GetBytes();
+        s.outbound = r.GetBytes();
+        s.appState = r.GetBytes();
+    }
+    return r.ok;
+}
+
+// --- 字节流与 fd 传输 ---
+
+static bool WriteAll(int sock, const uint8_t *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = send(sock, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool ReadAll(int sock, uint8_t *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = recv(sock, data, len, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool SendFds(int sock, const int *fds, size_t count)
+{
+    uint8_t marker = 0;
+    iovec iov{&marker, 1};
+    std::vector<uint8_t> control(CMSG_SPACE(sizeof(int) * count));
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * count);
+    std::memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * count);
+
+    while (true)
+    {
+        ssize_t n = sendmsg(sock, &msg, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        return n == 1;
+    }
+}
+
+// 接收一条携带 fd 的消息，追加到 fds
+static bool RecvFds(int sock, std::vector<int> &fds)
+{
+    uint8_t marker;
+    iovec iov{&marker, 1};
+    std::vector<uint8_t> control(CMSG_SPACE(sizeof(int) * MAX_FDS_PER_MSG));
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    ssize_t n;
+    do
+        n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    while (n < 0 && errno == EINTR);
+    if (n != 1 || (msg.msg_flags & MSG_CTRUNC))
+        return false;
+
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+            continue;
+        size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const int *data = reinterpret_cast<const int *>(CMSG_DATA(cmsg));
+        fds.insert(fds.end(), data, data + count);
+    }
+    return true;
+}
+
+bool SendHandoff(int sock, const HandoffState &state)
+{
+    std::vector<uint8_t> blob = Encode(state);
+    uint64_t size = blob.size();
+    if (!WriteAll(sock, reinterpret_cast<const uint8_t *>(&size), sizeof(size)) ||
+        !WriteAll(sock, blob.data(), blob.size()))
+        return false;
+
+    std::vector<int> fds(state.listenFds);
+    for (const HandoffSession &s : state.sessions)
+        fds.push_back(s.fd);
+    for (size_t offset = 0; offset < fds.size(); offset += MAX_FDS_PER_MSG)
+    {
+        if (!SendFds(sock, fds.data() + offset, std::min(fds.size() - offset, (size_t)MAX_FDS_PER_MSG)))
+            return false;
+    }
+
+    // 等待对端确认全部接管后再返回，发送方随后才能关闭自己的副本
+    uint8_t ack = 0;
+    return ReadAll(sock, &ack, 1) && ack == 1;
+}
+
+bool RecvHandoff(int sock, HandoffState &state)
+{
+    uint64_t size = 0;
+    if (!ReadAll(sock, reinterpret_cast<uint8_t *>(&size), sizeof(size)) || size > MAX_STATE_SIZE)
+        return false;
+    std::vector<uint8_t> blob(size);
+    uint32_t listenCount = 0;
+    if (!ReadAll(sock, blob.data(), blob.size()) || !Decode(blob, state, listenCount))
+        return false;
+
+    size_t expected = listenCount + state.sessions.size();
+    std::vector<int> fds;
+    while (fds.size() < expected)
+    {
+        if (!RecvFds(sock, fds))
+        {
+            for (int fd : fds)
+                close(fd);
+            return false;
+        }
+    }
+
+    state.listenFds.assign(fds.begin(), fds.begin() + listenCount);
+    for (size_t i = 0; i < state.sessions.size(); i++)
+        state.sessions[i].fd = fds[listenCount + i];
+
+    uint8_t ack = 1;
+    return WriteAll(sock, &ack, 1);
+}
+
+int ListenHandoff(const std::string &path)
+{
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path))
+        return -1;
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sock < 0)
+        return -1;
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+
+    // 上一个进程交接后不会删除路径，由新进程接管
+    // 绑定后、listen 前收紧权限：此前的 connect 只会被拒绝，不存在可被其他用户连上的窗口
+    unlink(path.c_str());
+    if (bind(sock, (sockaddr *)&addr, sizeof(addr)) != 0 || chmod(path.c_str(), S_IRUSR | S_IWUSR) != 0 ||
+        listen(sock, 1) != 0)
+    {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+int ConnectHandoff(const std::string &path)
+{
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path))
+        return -1;
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0)
+        return -1;
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    if (connect(sock, (sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+bool HandoffPeerAllowed(int sock, uint32_t uid)
+{
+    ucred cred{};
+    socklen_t len = sizeof(cred);
+    if (getsockopt(sock, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0 || len != sizeof(cred))
+        return false;
+    return cred.uid == uid;
+}
+
+#endif
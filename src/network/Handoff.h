@@ -0,0 +1,55 @@
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+/**
+ * @brief 热重启交接：旧进程把监听 Socket、客户端 Socket 与会话状态交给新进程
+ *
+ * 交接通过 Unix 域 Socket 完成：先发送长度前缀的状态块，再用 SCM_RIGHTS 按同样的顺序
+ * 发送全部 fd（先监听 Socket，后客户端 Socket）。客户端连接本身不断开，
+ * 收发中途的字节（未解完的入站数据、未写出的出站数据）随状态一起交接。
+ * 上层状态只有 appState 一个不透明字段，房间、对局等未放入其中的状态不会迁移。
+ * 仅支持 Linux / POSIX。
+ */
+struct HandoffSession
+{
+    int fd = -1;
+    uint32_t reactor = 0;   // 所属 Reactor（与 sessionId 低 8 位一致）
+    uint32_t peerAddr = 0;  // 来源 IPv4 地址（网络字节序）
+    uint64_t sessionId = 0; // 0 表示连接尚未建立会话
+    uint64_t idleMs = 0;    // 距最后活跃的时长
+
+    // SessionContext 状态
+    bool active = false;
+    uint32_t resumeCounter = 0;
+    uint8_t wireFormat = 0;
+    uint64_t replayTop = 0, replayBitmap = 0; // 入站重放窗口，新进程接着校验
+    std::vector<uint8_t> sk, pk, pk2, iv, sharedKey, resumeKey, sig;
+
+    std::vector<uint8_t> inbound;  // 接收缓冲区中尚未组成完整帧的字节
+    std::vector<uint8_t> outbound; // 出站队列中尚未写出的字节
+    std::vector<uint8_t> appState; // 上层附带的会话状态（如 userId），对网络层不透明
+};
+
+struct HandoffState
+{
+    uint32_t reactorCount = 0;
+    std::vector<int> listenFds; // 按 Reactor 编号排列
+    std::vector<HandoffSession> sessions;
+};
+
+// 发送 / 接收完整的交接状态，成功后 fd 的所有权转移给接收方（发送方仍需关闭自己的副本）
+bool SendHandoff(int sock, const HandoffState &state);
+bool RecvHandoff(int sock, HandoffState &state);
+
+// 控制 Socket：旧进程监听，新进程连接。路径权限为 0600，只有同一用户能连接
+int ListenHandoff(const std::string &path);
+int ConnectHandoff(const std::string &path);
+
+// 交接会交出全部 fd 与会话密钥，收发前用 SO_PEERCRED 确认对端进程属于 uid
+bool HandoffPeerAllowed(int sock, uint32_t uid);
+
+#endif // HANDOFF_H
@@ -0,0 +1,181 @@
+#include "Poller.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+#define MAX_EVENTS 256
+
+#ifdef _WIN32
+// --- Windows 实现：select ---
+
+Poller::Poller() {}
+
+Poller::~Poller()
+{
+    Close();
+}
+
+bool Poller::Init()
+{
+    entries.clear();
+    return true;
+}
+
+void Poller::Close()
+{
+    entries.clear();
+}
+
+bool Poller::Add(SOCKET_TYPE sock, uint32_t events)
+{
+    if (entries.size() >= FD_SETSIZE)
+        return false;
+    entries.push_back({sock, events});
+    return true;
+}
+
+bool Poller::Modify(SOCKET_TYPE sock, uint32_t events)
+{
+    for (auto &entry : entries)
+    {
+        if (entry.sock == sock)
+        {
+            entry.events = events;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Poller::Remove(SOCKET_TYPE sock)
+{
+    auto it = std::find_if(entries.begin(), entries.end(), [sock](const Entry &e)
+                           { return e.sock == sock; });
+    if (it == entries.end())
+        return false;
+    *it = entries.back();
+    entries.pop_back();
+    return true;
+}
+
+int Poller::Wait(std::vector<Event> &events, int timeoutMs)
+{
+    events.clear();
+
+    fd_set read_fds, write_fds;
+    FD_ZERO(&read_fds);
+    FD_ZERO(&write_fds);
+    for (const auto &entry : entries)
+    {
+        if (entry.events & Readable)
+            FD_SET(entry.sock, &read_fds);
+        if (entry.events & Writable)
+            FD_SET(entry.sock, &write_fds);
+    }
+
+    timeval tv = {timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+    int n = select(0, &read_fds, &write_fds, NULL, timeoutMs < 0 ? NULL : &tv);
+    if (n <= 0)
+        return n;
+
+    for (const auto &entry : entries)
+    {
+        uint32_t ready = 0;
+        if (FD_ISSET(entry.sock, &read_fds))
+            ready |= Readable;
+        if (FD_ISSET(entry.sock, &write_fds))
+            ready |= Writable;
+        if (ready)
+            events.push_back({entry.sock, ready});
+    }
+    return (int)events.size();
+}
+
+#else
+// --- Linux 实现：边缘触发 epoll ---
+
+#include <sys/epoll.h>
+
+static uint32_t ToEpoll(uint32_t events)
+{
+    uint32_t ev = EPOLLET | EPOLLRDHUP;
+    if (events & Poller::Readable)
+        ev |= EPOLLIN;
+    if (events & Poller::Writable)
+        ev |= EPOLLOUT;
+    return ev;
+}
+
+Poller::Poller() : epfd(-1) {}
+
+Poller::~Poller()
+{
+    Close();
+}
+
+bool Poller::Init()
+{
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd == -1)
+    {
+        LOG_ERROR("epoll_create1 failed: " + std::to_string(errno));
+        return false;
+    }
+    raw.resize(sizeof(epoll_event) * MAX_EVENTS);
+    return true;
+}
+
+void Poller::Close()
+{
+    if (epfd != -1)
+    {
+        close(epfd);
+        epfd = -1;
+    }
+}
+
+bool Poller::Add(SOCKET_TYPE sock, uint32_t events)
+{
+    epoll_event ev{};
+    ev.events = ToEpoll(events);
+    ev.data.fd = sock;
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, sock, &ev) == 0;
+}
+
+bool Poller::Modify(SOCKET_TYPE sock, uint32_t events)
+{
+    epoll_event ev{};
+    ev.events = ToEpoll(events);
+    ev.data.fd = sock;
+    return epoll_ctl(epfd, EPOLL_CTL_MOD, sock, &ev) == 0;
+}
+
+bool Poller::Remove(SOCKET_TYPE sock)
+{
+    return epoll_ctl(epfd, EPOLL_CTL_DEL, sock, nullptr) == 0;
+}
+
+int Poller::Wait(std::vector<Event> &events, int timeoutMs)
+{
+    events.clear();
+
+    auto *evs = reinterpret_cast<epoll_event *>(raw.data());
+    int n = epoll_wait(epfd, evs, MAX_EVENTS, timeoutMs);
+    if (n < 0)
+        return errno == EINTR ? 0 : -1;
+
+    for (int i = 0; i < n; i++)
+    {
+        uint32_t ready = 0;
+        if (evs[i].events & EPOLLIN)
+            ready |= Readable;
+        if (evs[i].events & EPOLLOUT)
+            ready |= Writable;
+        if (evs[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+            ready |= Closed | Readable; // 交给读路径处理，recv 返回 0/-1 后断开
+        events.push_back({evs[i].data.fd, ready});
+    }
+    return n;
+}
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef POLLER_H
+#define POLLER_H
+
+#include "Socket.h"
+
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief I/O 多路复用封装
+ *
+ * Linux 下使用边缘触发的 epoll，每次唤醒只返回就绪的 Socket；
+ * Windows 下退化为 select（水平触发），调用方按“读到 EAGAIN 为止”处理即可两者通用。
+ */
+class Poller
+{
+public:
+    enum Mask : uint32_t
+    {
+        Readable = 1 << 0, // 可读 / 有新连接
+        Writable = 1 << 1, // 可写
+        Closed = 1 << 2,   // 对端关闭或出错
+    };
+
+    struct Event
+    {
+        SOCKET_TYPE sock;
+        uint32_t events;
+    };
+
+    Poller();
+    ~Poller();
+
+    Poller(const Poller &) = delete;
+    Poller &operator=(const Poller &) = delete;
+
+    bool Init();
+    void Close();
+
+    bool Add(SOCKET_TYPE sock, uint32_t events);
+    bool Modify(SOCKET_TYPE sock, uint32_t events);
+    bool Remove(SOCKET_TYPE sock);
+
+    // 等待事件；timeoutMs < 0 表示无限等待。返回就绪数量，出错返回 -1
+    int Wait(std::vector<Event> &events, int timeoutMs);
+
+private:
+#ifdef _WIN32
+    struct Entry
+    {
+        SOCKET_TYPE sock;
+        uint32_t events;
+    };
+    std::vector<Entry> entries;
+#else
+    int epfd;
+    std::vector<uint8_t> raw; // epoll_event 缓冲区，避免在头文件中引入 sys/epoll.h
+#endif
+};
+
+#endif // POLLER_H
@@ -0,0 +1,37 @@
+#include "RecvBuffer.h"
+
+#include <cstring>
+#include <algorithm>
+
+void RecvBuffer::Reserve(size_t minWritable)
+{
+    if (Writable() >= minWritable)
+        return;
+
+    // 已读出的前缀不少于未读数据时才把未读数据搬到开头：搬移量不超过此前读出的字节数，均摊为线性。
+    // 否则（如出站队列部分写出后又不断追加）按倍数扩容，避免每次预留都搬移整段积压
+    size_t unread = Readable();
+    if (readPos > 0 && readPos >= unread)
+    {
+        if (unread > 0)
+            std::memmove(storage.data(), storage.data() + readPos, unread);
+        readPos = 0;
+        writePos = unread;
+    }
+    if (Writable() < minWritable)
+        storage.resize(std::max(writePos + minWritable, storage.size() * 2));
+}
+
+void RecvBuffer::Consume(size_t n)
+{
+    readPos += n;
+    // 读空时游标归零，下一次 recv 从头写入，无需搬移
+    if (readPos >= writePos)
+        readPos = writePos = 0;
+}
+
+void RecvBuffer::Release()
+{
+    std::vector<uint8_t>().swap(storage);
+    readPos = writePos = 0;
+}
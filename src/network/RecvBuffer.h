@@ -0,0 +1,40 @@
+#ifndef RECV_BUFFER_H
+#define RECV_BUFFER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief 单连接的接收缓冲区
+ *
+ * recv 直接写入 [writePos, capacity)，解帧通过读游标 readPos 前进，不做头部 erase。
+ * 写空间不足且已读出的前缀不少于未读数据时，才把未读的尾部（接收端通常不足一帧）搬到开头，
+ * 否则按倍数扩容；搬移总量不超过读出的总量。帧始终连续存放，可以原地解析。
+ */
+class RecvBuffer
+{
+public:
+    RecvBuffer() = default;
+
+    // 写入端：保证至少 minWritable 字节可写后直接 recv 到 WritePtr()
+    void Reserve(size_t minWritable);
+    uint8_t *WritePtr() { return storage.data() + writePos; }
+    size_t Writable() const { return storage.size() - writePos; }
+    void Commit(size_t n) { writePos += n; }
+
+    // 读取端
+    const uint8_t *ReadPtr() const { return storage.data() + readPos; }
+    size_t Readable() const { return writePos - readPos; }
+    void Consume(size_t n);
+
+    // 断开时释放内存
+    void Release();
+
+private:
+    std::vector<uint8_t> storage;
+    size_t readPos = 0;
+    size_t writePos = 0;
+};
+
+#endif // RECV_BUFFER_H
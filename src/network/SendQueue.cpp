@@ -0,0 +1,82 @@
+#include "SendQueue.h"
+
+#include <cstring>
+
+SendQueue::SendQueue() : frameHead(0), committed(0), sent(0) {}
+
+uint8_t *SendQueue::Reserve(size_t len)
+{
+    buffer.Reserve(len);
+    return buffer.WritePtr();
+}
+
+void SendQueue::Commit(size_t len)
+{
+    if (len == 0)
+        return;
+    buffer.Commit(len);
+    committed += len;
+    frameEnds.push_back(committed);
+}
+
+void SendQueue::Append(const uint8_t *data, size_t len)
+{
+    if (len == 0)
+        return;
+    std::memcpy(Reserve(len), data, len);
+    Commit(len);
+}
+
+SendQueue::FlushResult SendQueue::Flush(SOCKET_TYPE sock, size_t &syscalls)
+{
+    while (!Empty())
+    {
+        syscalls++;
+        int ret = send(sock, reinterpret_cast<const char *>(buffer.ReadPtr()), (int)buffer.Readable(), SEND_FLAGS);
+        if (ret < 0)
+        {
+            int err = GET_LAST_ERROR();
+#ifndef _WIN32
+            if (err == EINTR)
+                continue;
+            if (err == EAGAIN)
+                return WouldBlock;
+#endif
+            return err == WOULD_BLOCK_ERROR ? WouldBlock : Failed;
+        }
+        Consume((size_t)ret);
+    }
+    return Drained;
+}
+
+void SendQueue::CopyTo(std::vector<uint8_t> &out) const
+{
+    out.insert(out.end(), buffer.ReadPtr(), buffer.ReadPtr() + buffer.Readable());
+}
+
+void SendQueue::Consume(size_t n)
+{
+    buffer.Consume(n);
+    sent += n;
+    while (frameHead < frameEnds.size() && frameEnds[frameHead] <= sent)
+        frameHead++;
+    // 全部写出时归零；长期积压时把已写出的记录挪走，容量都保留复用
+    if (frameHead == frameEnds.size())
+    {
+        frameEnds.clear();
+        frameHead = 0;
+    }
+    else if (frameHead >= 64 && frameHead * 2 >= frameEnds.size())
+    {
+        frameEnds.erase(frameEnds.begin(), frameEnds.begin() + frameHead);
+        frameHead = 0;
+    }
+}
+
+void SendQueue::Clear()
+{
+    buffer.Consume(buffer.Readable());
+    frameEnds.clear();
+    frameHead = 0;
+    sent = committed;
+}
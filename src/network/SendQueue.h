@@ -0,0 +1,58 @@
+#ifndef SEND_QUEUE_H
+#define SEND_QUEUE_H
+
+#include "Socket.h"
+#include "RecvBuffer.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief 单连接的出站字节队列
+ *
+ * 非阻塞 Socket 上 send 可能只写出一部分，剩余字节按顺序留在队列中，
+ * 待 Socket 可写（EPOLLOUT）时继续发送。队列非空时新数据只能追加，保证帧不乱序。
+ * 字节与接收缓冲区一样连续存放、以游标前进：帧由 Reserve / Commit 直接编码进队列，
+ * 容量在连接存续期间复用，稳定后入队不分配内存；Flush 时一次 send 写出全部积压。
+ */
+class SendQueue
+{
+public:
+    enum FlushResult
+    {
+        Drained,    // 已全部写出
+        WouldBlock, // 内核缓冲区已满，需等待可写
+        Failed,     // 连接出错，应断开
+    };
+
+    bool armed = false;     // 已关注可写事件，等待 EPOLLOUT
+    bool scheduled = false; // 已登记到本轮事件循环末尾的批量发送
+
+    SendQueue();
+
+    // 原地写入一帧：Reserve 返回可写 len 字节的位置，写完后 Commit 入队；未 Commit 的预留不会被发送
+    uint8_t *Reserve(size_t len);
+    void Commit(size_t len);
+    void Append(const uint8_t *data, size_t len);
+
+    // syscalls 累加本次实际发起的发送系统调用次数
+    FlushResult Flush(SOCKET_TYPE sock, size_t &syscalls);
+    void Clear();
+    void CopyTo(std::vector<uint8_t> &out) const; // 按顺序追加尚未写出的字节（热重启交接用）
+
+    bool Empty() const { return buffer.Readable() == 0; }
+    size_t Size() const { return buffer.Readable(); }           // 队列中尚未写出的字节数
+    size_t Chunks() const { return frameEnds.size() - frameHead; } // 队列中尚未完整写出的帧数
+
+private:
+    RecvBuffer buffer;
+    std::vector<uint64_t> frameEnds; // 各帧末尾在累计字节流中的位置，只用于统计写出的帧数
+    size_t frameHead;                // frameEnds 中第一个尚未完整写出的帧
+    uint64_t committed;              // 累计入队的字节数
+    uint64_t sent;                   // 累计写出的字节数
+
+    void Consume(size_t n);
+};
+
+#endif // SEND_QUEUE_H
@@ -2,28 +2,40 @@
 #include "Logger.h"
 #include <algorithm>
 #include <ctime>
+#include <cstring>
+#include <iterator>
+
+#ifndef _WIN32
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <signal.h>
+#endif
 
 #define BUFFER_SIZE 4096
 #define DEFAULT_PORT 8080
 #define HEARTBEAT_INTERVAL_MS 30000 // 30 秒心跳间隔
-
-// 定义跨平台的 错误码获取函数、I/O 阻塞错误码、关闭函数
-#ifdef _WIN32
-// Windows 平台
-
-#define GET_LAST_ERROR() WSAGetLastError()
-#define WOULD_BLOCK_ERROR WSAEWOULDBLOCK
-#define CLOSE_SOCKET(s) closesocket(s)
-#define SLEEP(ms) Sleep(ms)
-
-#else
-// Linux/POSIX 平台
-
-#define GET_LAST_ERROR() errno
-#define WOULD_BLOCK_ERROR EWOULDBLOCK
-#define CLOSE_SOCKET(s) close(s)
-#define SLEEP(ms) usleep((ms) * 1000)
-#endif
+#define EXPIRY_TICK_MS 1000         // 超时检测精度上限
+#define DEFAULT_RESUME_WINDOW_MS 60000 // 断线后会话保留 60 秒
+#define PING_SIZE 16                   // Ping / Pong 负载：两个 8 字节时间戳
+#define MAX_REACTORS 256            // sessionId 低 8 位编码 Reactor 编号
+#define MAX_HANDSHAKE_THREADS 64
+#define DEFAULT_MAX_IN_FLIGHT 16 // 单会话未完成的异步请求数
+#define MAX_HANDSHAKE_JOBS 4096  // 握手线程池排队上限，超出时应答 Error，由客户端重试
+
+// 单会话出站积压水位（字节）
+#define DEFAULT_LOW_WATERMARK (32 * 1024)
+#define DEFAULT_HIGH_WATERMARK (128 * 1024)
+#define DEFAULT_HARD_LIMIT (1024 * 1024)
+
+// 连接准入
+#define DEFAULT_BACKLOG 1024
+#define DEFAULT_ACCEPT_BATCH 64
+#define DEFAULT_MAX_CONNECTIONS 100000
+#define DEFAULT_MAX_PER_ADDRESS 0 // 默认不限制单 IP（NAT 后的大量玩家共用出口地址）
+
+// 优雅退出
+#define DEFAULT_DRAIN_TIMEOUT_MS 5000
+#define DRAIN_POLL_MS 10 // 排空期间检查出站队列的间隔
 
 // 实现跨平台的网络初始化、清理、设置非阻塞函数
 #ifdef _WIN32
@@ -71,11 +83,34 @@ bool Server::SetNonBlocking(SOCKET_TYPE sock)
 Server::Server()
 {
     port = DEFAULT_PORT;
-    max_fd = 0;
-    listen_sock = (SOCKET_TYPE)INVALID_SOCKET;
-    client_sockets.clear();
-    sockToId.clear();
-    idToSession.clear();
+    threadCount = 1;
+    lowWatermark = DEFAULT_LOW_WATERMARK;
+    highWatermark = DEFAULT_HIGH_WATERMARK;
+    hardLimit = DEFAULT_HARD_LIMIT;
+    sessionTimeout = HEARTBEAT_INTERVAL_MS;
+    resumeWindow = DEFAULT_RESUME_WINDOW_MS;
+    encryption = true;
+    keyAgreement = true;
+    compactEncoding = true;
+    identity = std::make_unique<SigningKey>();
+    handshakeThreads = 0;
+    maxInFlight = DEFAULT_MAX_IN_FLIGHT;
+    backlog = DEFAULT_BACKLOG;
+    acceptBatch = DEFAULT_ACCEPT_BATCH;
+    admission.SetLimits(DEFAULT_MAX_CONNECTIONS, DEFAULT_MAX_PER_ADDRESS);
+    running = false;
+    looping = false;
+    draining = false;
+    drainingReactors = 0;
+    drainStart = 0;
+    drainDeadline = 0;
+    drainTimeout = DEFAULT_DRAIN_TIMEOUT_MS;
+    handleSignals = false;
+    signal_fd = (SOCKET_TYPE)INVALID_SOCKET;
+    takeover = false;
+    handoff_sock = (SOCKET_TYPE)INVALID_SOCKET;
+    handoff_conn = (SOCKET_TYPE)INVALID_SOCKET;
+    reactors.clear();
     onPacketCb = nullptr;
 }
 
@@ -84,6 +119,140 @@ Server::~Server()
     this->Stop();
 }
 
+void Server::SetPort(int port)
+{
+    this->port = port;
+}
+
+void Server::SetThreadCount(int count)
+{
+#ifdef _WIN32
+    // Windows 不支持 SO_REUSEPORT 负载均衡，固定单 Reactor
+    (void)count;
+    threadCount = 1;
+#else
+    threadCount = std::max(1, std::min(count, MAX_REACTORS));
+#endif
+}
+
+void Server::SetBackpressure(size_t low, size_t high, size_t hard)
+{
+    // 保证 low <= high <= hard
+    lowWatermark = low;
+    highWatermark = std::max(high, low);
+    hardLimit = std::max(hard, highWatermark);
+}
+
+void Server::SetBacklog(int backlog)
+{
+    this->backlog = std::max(1, backlog);
+}
+
+void Server::SetAcceptBatch(int count)
+{
+    acceptBatch = std::max(1, count);
+}
+
+void Server::SetConnectionLimits(size_t maxConnections, uint32_t maxPerAddress)
+{
+    admission.SetLimits(maxConnections, maxPerAddress);
+}
+
+void Server::SetSessionTimeout(uint64_t ms)
+{
+    sessionTimeout = std::max<uint64_t>(1, ms);
+}
+
+void Server::SetResumeWindow(uint64_t ms)
+{
+    resumeWindow = ms;
+}
+
+void Server::SetEncryption(bool enable)
+{
+    encryption = enable;
+}
+
+void Server::SetCompactEncoding(bool enable)
+{
+    compactEncoding = enable;
+}
+
+bool Server::SetIdentity(const std::vector<uint8_t> &seed)
+{
+    auto key = std::make_unique<SigningKey>(seed);
+    if (!key->Valid())
+        return false;
+    identity = std::move(key);
+    return true;
+}
+
+const std::vector<uint8_t> &Server::GetIdentityKey() const
+{
+    return identity->PublicKey();
+}
+
+void Server::SetHandshakeThreads(int count)
+{
+    handshakeThreads = std::max(0, std::min(count, MAX_HANDSHAKE_THREADS));
+}
+
+void Server::SetMaxInFlight(size_t count)
+{
+    maxInFlight = std::max<size_t>(1, count);
+}
+
+void Server::SetDrainTimeout(uint64_t ms)
+{
+    drainTimeout = ms;
+}
+
+void Server::SetHandleSignals(bool enable)
+{
+    handleSignals = enable;
+}
+
+void Server::SetHandoffPath(const std::string &path, bool takeover)
+{
+    handoffPath = path;
+    this->takeover = takeover && !path.empty();
+}
+
+void Server::SetHandoffCallbacks(std::function<std::vector<uint8_t>(uint64_t)> exportSession,
+                                 std::function<void(uint64_t, const std::vector<uint8_t> &)> importSession)
+{
+    exportSessionCb = exportSession;
+    importSessionCb = importSession;
+}
+
+#ifdef _WIN32
+static std::atomic<Server *> signalTarget{nullptr};
+static std::atomic<int> signalCount{0};
+
+static BOOL WINAPI ConsoleCtrlHandler(DWORD type)
+{
+    Server *server = signalTarget.load();
+    if (!server || (type != CTRL_C_EVENT && type != CTRL_BREAK_EVENT && type != CTRL_CLOSE_EVENT))
+        return FALSE;
+    if (signalCount++ == 0)
+        server->Shutdown();
+    else
+        server->Stop();
+    return TRUE;
+}
+
+void Server::BlockShutdownSignals() {}
+#else
+void Server::BlockShutdownSignals()
+{
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+}
+#endif
+
 void Server::SetOnPacketCallback(std::function<void(const Packet &)> cb)
 {
     onPacketCb = cb;
@@ -100,6 +269,18 @@ SOCKET_TYPE Server::CreateListenSocket()
         return (SOCKET_TYPE)INVALID_SOCKET;
     }
 
+    int opt = 1;
+    setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, (const char *)&opt, sizeof(opt));
+#ifdef SO_REUSEPORT
+    // 多 Reactor 时每个线程绑定同一端口，由内核按四元组哈希分发连接
+    if (threadCount > 1 && setsockopt(listen_sock, SOL_SOCKET, SO_REUSEPORT, (const char *)&opt, sizeof(opt)) == -1)
+    {
+        LOG_ERROR("Error setting SO_REUSEPORT: " + std::to_string(GET_LAST_ERROR()));
+        CLOSE_SOCKET(listen_sock);
+        return (SOCKET_TYPE)INVALID_SOCKET;
+    }
+#endif
+
     server_addr.sin_family = AF_INET;
     server_addr.sin_port = htons(this->port);
     server_addr.sin_addr.s_addr = htonl(INADDR_ANY); // 监听所有接口
@@ -111,7 +292,7 @@ SOCKET_TYPE Server::CreateListenSocket()
         return (SOCKET_TYPE)INVALID_SOCKET;
     }
 
-    if (listen(listen_sock, 10) == -1)
+    if (listen(listen_sock, backlog) == -1)
     {
         LOG_ERROR("Error listening on socket: " + std::to_string(GET_LAST_ERROR()));
         CLOSE_SOCKET(listen_sock);
@@ -122,14 +303,20 @@ SOCKET_TYPE Server::CreateListenSocket()
     return listen_sock;
 }
 
-int Server::HandleNewConnection(SOCKET_TYPE listen_sock)
+int Server::HandleNewConnection(Reactor &r)
 {
-    // 循环 accept 所有挂起的连接
-    while (true)
+    // 每轮最多 accept acceptBatch 个连接，剩余的留到下一轮，期间先处理已有连接的事件
+    r.acceptPending = false;
+    for (int i = 0; i < acceptBatch; i++)
     {
         sockaddr_in client_addr;
         socklen_t addrlen = sizeof(client_addr);
-        SOCKET_TYPE new_sock = accept(listen_sock, (struct sockaddr *)&client_addr, &addrlen);
+#ifdef _WIN32
+        SOCKET_TYPE new_sock = accept(r.listen_sock, (struct sockaddr *)&client_addr, &addrlen);
+#else
+        // accept4 直接得到非阻塞 fd，省去两次 fcntl
+        SOCKET_TYPE new_sock = accept4(r.listen_sock, (struct sockaddr *)&client_addr, &addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#endif
 
         if (new_sock == -1 || new_sock == (SOCKET_TYPE)INVALID_SOCKET)
         {
@@ -139,41 +326,87 @@ int Server::HandleNewConnection(SOCKET_TYPE listen_sock)
             if (!(err == WOULD_BLOCK_ERROR || err == EWOULDBLOCK || err == EAGAIN))
                 LOG_ERROR("Accept error: " + std::to_string(err));
 
-            break;
+            return 0;
+        }
+#ifdef _WIN32
+        SetNonBlocking(new_sock);
+#endif
+
+        // 准入检查在注册 Poller、创建会话之前，拒绝只需关闭 fd
+        uint32_t peerAddr = client_addr.sin_addr.s_addr;
+        AdmissionControl::Result result = admission.Admit(peerAddr);
+        if (result != AdmissionControl::Admitted)
+        {
+            r.rejected.fetch_add(1, std::memory_order_relaxed);
+            LOG_DEBUG(std::string("Connection rejected: ") +
+                      (result == AdmissionControl::TooManyConnections ? "server full" : "too many connections from address"));
+            CLOSE_SOCKET(new_sock);
+            continue;
         }
-        Connect(new_sock);
+        r.accepted.fetch_add(1, std::memory_order_relaxed);
+        Connect(r, new_sock, peerAddr);
     }
 
+    r.acceptPending = true;
     return 0;
 }
 
-int Server::HandleClient(SOCKET_TYPE sock)
+int Server::HandleClient(Reactor &r, SOCKET_TYPE sock)
 {
-    auto &buffer = _session_buffers[sock];
-    char temp_buf[BUFFER_SIZE];
-    int n = recv(sock, temp_buf, sizeof(temp_buf), 0);
+    Slot *slot = SlotOf(r, sock);
+    if (!slot)
+        return 0;
+    FrameDecoder &decoder = slot->decoder;
+    RecvBuffer &buffer = decoder.Buffer();
+    uint64_t skipped = decoder.SkippedBytes();
+    Frame frame;
 
-    if (n <= 0)
+    // 边缘触发：必须一直读到 EAGAIN，否则剩余数据不会再次通知
+    while (true)
     {
+        // 上一个 Batch 帧中暂停的请求先于之后的帧分发，保持请求顺序
+        if (!slot->batched.empty())
+            DispatchBatched(r, sock, *slot);
+        // 每次读取前先解出已缓冲的帧，避免缓冲区在一次唤醒内无限增长
+        while (slot->inFlight < maxInFlight && decoder.Next(frame))
+        {
+            LOG_TRACE("Received frame from client (Sock: " + std::to_string(sock) + "): ");
+            this->OnFrame(r, (int)sock, frame);
+            // 处理过程中连接可能已被清理（槽位被释放），不能继续读
+            if (!slot->open)
+                return 0;
+        }
+        // 未完成的异步请求达到上限：剩余字节留在缓冲区与内核中（客户端随之被 TCP 流控），
+        // 请求完成时由 RunAsync 重新调用本函数，读到 EAGAIN 为止
+        if (slot->inFlight >= maxInFlight)
+            return 0;
+
+        // recv 直接写入会话缓冲区，不经过栈上中转
+        buffer.Reserve(BUFFER_SIZE);
+        int n = recv(sock, reinterpret_cast<char *>(buffer.WritePtr()), (int)buffer.Writable(), 0);
+
         if (n < 0)
         {
             int err = GET_LAST_ERROR();
+            if (err == WOULD_BLOCK_ERROR || err == EAGAIN)
+                break;
             LOG_ERROR("Error receiving data from client (Sock: " + std::to_string(sock) + "): " + std::to_string(err));
-        };
-        this->DisConnect(sock);
-        return 0;
-    }
-
-    LOG_TRACE("Received " + std::to_string(n) + " bytes from client (Sock: " + std::to_string(sock) + "): ");
-    buffer.insert(buffer.end(), temp_buf, temp_buf + n);
+            this->DisConnect(r, sock);
+            return 0;
+        }
+        if (n == 0)
+        {
+            this->DisConnect(r, sock);
+            return 0;
+        }
 
-    Frame frame;
-    while (frame.ReadStream(buffer))
-    {
-        LOG_TRACE("Received frame from client (Sock: " + std::to_string(sock) + "): ");
-        this->OnFrame((int)sock, frame);
+        LOG_TRACE("Received " + std::to_string(n) + " bytes from client (Sock: " + std::to_string(sock) + "): ");
+        buffer.Commit(n);
     }
 
+    if (decoder.SkippedBytes() != skipped)
+        LOG_WARN("Discarded " + std::to_string(decoder.SkippedBytes() - skipped) +
+                 " invalid bytes from client (Sock: " + std::to_string(sock) + ")");
     return 0;
 }
 
@@ -185,237 +418,1657 @@ int Server::Init()
         return 1;
     }
 
-    this->listen_sock = CreateListenSocket();
+    // 没有 X25519 / Ed25519 时无从导出会话密钥：明确报错并以明文模式运行，而不是让每次握手静默失败
+    keyAgreement = KeyAgreementSupported();
+    if (!keyAgreement)
+    {
+        LOG_ERROR("X25519 / Ed25519 are not available on this platform: encryption is disabled, "
+                  "sessions activate without key agreement and session resume is off");
+        encryption = false;
+    }
 
-    if (this->listen_sock == (SOCKET_TYPE)INVALID_SOCKET)
+    // 热重启：先从旧进程接管监听 Socket 与连接，Reactor 数沿用旧进程（sessionId 中编码了 Reactor 编号）
+    HandoffState inherited;
+    if (takeover && !TakeOver(inherited))
     {
         CleanupNetworking();
         return 1;
     }
 
-    this->client_sockets.push_back(this->listen_sock);
-    max_fd = this->listen_sock;
+    for (int i = 0; i < threadCount; i++)
+    {
+        auto r = std::make_unique<Reactor>();
+        r->index = i;
+        if ((size_t)i < inherited.listenFds.size())
+            r->listen_sock = (SOCKET_TYPE)inherited.listenFds[i];
+        if (!InitReactor(*r))
+        {
+            CloseReactor(*r);
+            for (auto &created : reactors)
+                CloseReactor(*created);
+            reactors.clear();
+            for (size_t j = i + 1; j < inherited.listenFds.size(); j++)
+                CLOSE_SOCKET((SOCKET_TYPE)inherited.listenFds[j]);
+            for (auto &session : inherited.sessions)
+                CLOSE_SOCKET((SOCKET_TYPE)session.fd);
+            CleanupNetworking();
+            return 1;
+        }
+        reactors.push_back(std::move(r));
+    }
+
+    for (auto &session : inherited.sessions)
+        AdoptSession(session);
+    if (!inherited.sessions.empty())
+        LOG_INFO("Resumed " + std::to_string(inherited.sessions.size()) + " connection(s) from previous process");
+    if (!handoffPath.empty())
+        ListenForHandoff();
+
+    if (handleSignals)
+    {
+#ifdef _WIN32
+        signalTarget = this;
+        SetConsoleCtrlHandler(ConsoleCtrlHandler, TRUE);
+#else
+        // 信号须已被 BlockShutdownSignals 屏蔽，否则仍按默认动作终止进程
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGINT);
+        sigaddset(&mask, SIGTERM);
+        signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+        if (signal_fd == -1)
+            LOG_ERROR("signalfd failed: " + std::to_string(errno));
+        else
+            reactors[0]->poller.Add(signal_fd, Poller::Readable);
+#endif
+    }
 
     return 0;
 }
 
 int Server::Run()
 {
-    timeval timeout = {0, 0};
+    if (reactors.empty())
+        return 1;
 
-    LOG_INFO("Server Running on port " + std::to_string(this->port));
+    LOG_INFO("Server Running on port " + std::to_string(this->port) +
+             " with " + std::to_string(reactors.size()) + " reactor(s)");
 
-    while (true)
+    running = true;
+    looping = true;
+    StartHandshakeWorkers();
+    for (size_t i = 1; i < reactors.size(); i++)
     {
-        fd_set read_fds;
-        FD_ZERO(&read_fds);
+        Reactor *r = reactors[i].get();
+        r->thread = std::thread([this, r]()
+                                { RunReactor(*r); });
+    }
+    RunReactor(*reactors[0]);
 
-        for (SOCKET_TYPE sock : client_sockets)
-        {
-            FD_SET(sock, &read_fds);
-        }
+    // Reactor 0 退出即整体停止
+    running = false;
+    for (auto &r : reactors)
+        Wake(*r);
+    for (auto &r : reactors)
+    {
+        if (r->thread.joinable())
+            r->thread.join();
+    }
+    // 进行中的握手运算与异步请求完成后结果留在各 Reactor 的任务队列里，统一执行完再交接或释放
+    StopHandshakeWorkers();
+    DrainMailboxes();
+
+    // 新进程已连接：交出全部连接后再释放资源，关闭的只是本进程持有的副本
+    if (handoff_conn != (SOCKET_TYPE)INVALID_SOCKET)
+        HandOff();
+
+    looping = false;
+    if (draining)
+        LOG_INFO("Drain finished in " + std::to_string(GetTimeMS() - drainStart) + " ms");
+    this->Stop();
+    return 0;
+}
 
-        int activity = select((int)max_fd + 1, &read_fds, NULL, NULL, &timeout);
+int Server::Stop()
+{
+    // 外部调用与 Run 退出时的调用可能并发，资源只回收一次
+    std::lock_guard<std::mutex> lock(stopMutex);
+    running = false;
+    for (auto &r : reactors)
+        Wake(*r);
+
+    // 事件循环仍在运行时只发出停止信号，资源由 Run 退出时回收
+    if (looping)
+        return 0;
 
-        if (activity < 0)
+    if (!reactors.empty())
+    {
+        for (auto &r : reactors)
+            CloseReactor(*r);
+        reactors.clear();
+#ifdef _WIN32
+        if (signalTarget == this)
         {
-            LOG_ERROR("Select error: " + std::to_string(GET_LAST_ERROR()));
-            break;
+            SetConsoleCtrlHandler(ConsoleCtrlHandler, FALSE);
+            signalTarget = nullptr;
         }
-
-        if (FD_ISSET(this->listen_sock, &read_fds))
+#else
+        if (signal_fd != (SOCKET_TYPE)INVALID_SOCKET)
         {
-            HandleNewConnection(this->listen_sock);
-            activity--;
+            close(signal_fd);
+            signal_fd = (SOCKET_TYPE)INVALID_SOCKET;
         }
-
-        std::vector<SOCKET_TYPE> current_clients = client_sockets;
-        for (SOCKET_TYPE sock : current_clients)
+        // 未发生交接时清理路径；交接后路径已属于新进程
+        if (handoff_sock != (SOCKET_TYPE)INVALID_SOCKET)
         {
-            if (sock != this->listen_sock && FD_ISSET(sock, &read_fds))
-            {
-                HandleClient(sock);
-                activity--;
-            }
+            close(handoff_sock);
+            handoff_sock = (SOCKET_TYPE)INVALID_SOCKET;
+            unlink(handoffPath.c_str());
         }
-        SLEEP(10);
+#endif
+        CleanupNetworking();
     }
-
-    this->Stop();
     return 0;
 }
 
-int Server::Stop()
+int Server::Shutdown()
 {
-    for (SOCKET_TYPE sock : client_sockets)
+    if (!looping)
+        return this->Stop();
+    bool expected = false;
+    if (!draining.compare_exchange_strong(expected, true))
+        return 0;
+
+    drainStart = GetTimeMS();
+    drainDeadline = drainStart + drainTimeout;
+    drainingReactors = reactors.size();
+    LOG_INFO("Draining: stop accepting, flushing outbound queues (timeout " + std::to_string(drainTimeout) + " ms)");
+    for (auto &r : reactors)
     {
-        CLOSE_SOCKET(sock);
+        Reactor *rp = r.get();
+        Post(*rp, [this, rp]()
+             { BeginDrain(*rp); });
     }
-    CleanupNetworking();
     return 0;
 }
 
-int Server::Connect(SOCKET_TYPE sock)
+void Server::OnSignal()
 {
-    SetNonBlocking(sock);
-    this->client_sockets.push_back(sock);
-    this->max_fd = std::max(this->max_fd, sock);
-    LOG_TRACE("New connection accepted (Sock: " + std::to_string(sock) + ")");
-    LOG_TRACE("Total connected clients: " + std::to_string(client_sockets.size()));
-    return 0;
+#ifndef _WIN32
+    signalfd_siginfo info;
+    while (read(signal_fd, &info, sizeof(info)) == sizeof(info))
+    {
+        LOG_INFO("Received signal " + std::to_string(info.ssi_signo));
+        // 第一次信号优雅退出，排空期间再次收到则立即退出
+        if (!draining)
+            Shutdown();
+        else
+            Stop();
+    }
+#endif
 }
 
-int Server::DisConnect(SOCKET_TYPE sock)
+void Server::BeginDrain(Reactor &r)
 {
-    _session_buffers.erase(sock);
-    CLOSE_SOCKET(sock);
-    auto it = std::find(this->client_sockets.begin(), this->client_sockets.end(), sock);
-    if (it != this->client_sockets.end())
+    r.draining = true;
+    r.acceptPending = false;
+    if (r.listen_sock != (SOCKET_TYPE)INVALID_SOCKET)
     {
-        this->client_sockets.erase(it);
+        r.poller.Remove(r.listen_sock);
+        CLOSE_SOCKET(r.listen_sock);
+        r.listen_sock = (SOCKET_TYPE)INVALID_SOCKET;
     }
-    LOG_INFO("Connection closed (Sock: " + std::to_string(sock) + ")");
-    LOG_DEBUG("Remaining connected clients: " + std::to_string(client_sockets.size()));
-    return 0;
+    DrainStep(r);
 }
 
-int Server::Send(SOCKET_TYPE sock, Frame frame)
+void Server::DrainStep(Reactor &r)
 {
-    std::vector<uint8_t> buffer = frame.ToBytes();
-    send(sock, reinterpret_cast<const char *>(buffer.data()), (int)buffer.size(), 0);
-    return 0;
+    // 出站队列已写空的连接立即关闭；仍在等待可写的继续发送，直到时限
+    for (size_t sock = 0; sock < r.slots.size(); sock++)
+    {
+        Slot &slot = r.slots[sock];
+        if (slot.open && slot.queue.Empty())
+            DisConnect(r, (SOCKET_TYPE)sock);
+    }
+
+    uint64_t now = GetTimeMS();
+    if (r.connections > 0 && now < drainDeadline)
+    {
+        AddLoopTimer(r, DRAIN_POLL_MS, [this, &r]()
+                     { DrainStep(r); });
+        return;
+    }
+
+    size_t forced = r.connections;
+    size_t dropped = 0;
+    for (size_t sock = 0; sock < r.slots.size() && r.connections > 0; sock++)
+    {
+        if (!r.slots[sock].open)
+            continue;
+        dropped += r.slots[sock].queue.Size();
+        DisConnect(r, (SOCKET_TYPE)sock);
+    }
+    if (forced > 0)
+        LOG_WARN("Reactor " + std::to_string(r.index) + " drain timed out, " + std::to_string(forced) +
+                 " connection(s) closed with " + std::to_string(dropped) + " bytes unsent");
+    LOG_INFO("Reactor " + std::to_string(r.index) + " drained in " + std::to_string(now - drainStart) + " ms");
+
+    // 最后一个完成的 Reactor 结束事件循环
+    if (--drainingReactors == 0)
+    {
+        running = false;
+        for (auto &other : reactors)
+            Wake(*other);
+    }
 }
 
-// --------------- 会话管理实现 -----------------
+// --------------- 热重启交接 -----------------
 
-uint64_t Server::GenerateSessionId()
+bool Server::ListenForHandoff()
 {
-    std::vector<uint8_t> vec = GenerateRandomBytes(8);
-    uint64_t sessionId = 0;
-    for (auto byte : vec)
-        sessionId = (sessionId << 8) | byte;
-    return sessionId;
+    handoff_sock = (SOCKET_TYPE)ListenHandoff(handoffPath);
+    if (handoff_sock == (SOCKET_TYPE)INVALID_SOCKET)
+    {
+        LOG_ERROR("Failed to listen on handoff socket " + handoffPath);
+        return false;
+    }
+    reactors[0]->poller.Add(handoff_sock, Poller::Readable);
+    LOG_INFO("Hot restart enabled on " + handoffPath);
+    return true;
 }
 
-uint64_t Server::NewSession(int sock)
+void Server::OnHandoffRequest()
 {
-    uint64_t sessionId = GenerateSessionId();
-    idToSession[sessionId] = std::make_unique<SessionContext>(sock, sessionId);
-    sockToId[sock] = sessionId;
+#ifndef _WIN32
+    // 阻塞模式的连接：交接在全部 Reactor 退出后进行，同步收发即可
+    SOCKET_TYPE conn = accept4(handoff_sock, nullptr, nullptr, SOCK_CLOEXEC);
+    if (conn == -1)
+        return;
+    if (!HandoffPeerAllowed(conn, geteuid()))
+    {
+        LOG_WARN("Hot restart request rejected: peer is not owned by the server user");
+        close(conn);
+        return;
+    }
+    if (draining || handoff_conn != (SOCKET_TYPE)INVALID_SOCKET)
+    {
+        LOG_WARN("Hot restart request rejected: server is already shutting down");
+        close(conn);
+        return;
+    }
 
-    // 添加超时清理任务（延迟30个槽位，每个槽位1秒）
-    TimeTools::StaticAddTimeWheelTask(30, [this, sessionId]()
-                                      {
-                     auto it = idToSession.find(sessionId);
-                     if (it == idToSession.end()) return;
-                     auto *session = it->second.get();
-                     if (GetTimeMS() - session->lastHeartbeat > HEARTBEAT_INTERVAL_MS) {
-                         CleanUp(sessionId);
-                     } });
-    return sessionId;
+    // 停止所有事件循环，Run 在线程汇合后执行交接
+    LOG_INFO("Hot restart requested, stopping reactors for handoff");
+    handoff_conn = conn;
+    running = false;
+    for (auto &r : reactors)
+        Wake(*r);
+#endif
 }
 
-int Server::HeartBeat(uint64_t sessionId)
+void Server::HandOff()
 {
-    auto it = idToSession.find(sessionId);
-    if (it == idToSession.end())
-        return -1;
-    auto session = it->second.get();
-    session->lastHeartbeat = GetTimeMS();
-    return 0;
-}
+    uint64_t start = GetTimeMS();
+    SOCKET_TYPE conn = handoff_conn;
+    handoff_conn = (SOCKET_TYPE)INVALID_SOCKET;
+    // 不删除路径：新进程接管后会在同一路径上重新监听
+    reactors[0]->poller.Remove(handoff_sock);
+    CLOSE_SOCKET(handoff_sock);
+    handoff_sock = (SOCKET_TYPE)INVALID_SOCKET;
+
+    // 排空已开始时监听 Socket 可能已关闭，放弃交接，新进程的接收随之失败
+    if (draining)
+    {
+        LOG_WARN("Hot restart aborted: server is draining");
+        CLOSE_SOCKET(conn);
+        return;
+    }
 
-int Server::CleanUp(uint64_t sessionId)
-{
-    auto node = idToSession.extract(sessionId);
-    if (node.empty())
-        return -1;
+    HandoffState state;
+    state.reactorCount = (uint32_t)reactors.size();
+    {
+        std::lock_guard<std::mutex> lock(logicMutex);
+        uint64_t now = GetTimeMS();
+        for (auto &rp : reactors)
+        {
+            Reactor &r = *rp;
+            // 已投递的发送在 Run 中先于交接执行（不持有逻辑锁），已写入出站队列，随队列一起交接
+            state.listenFds.push_back((int)r.listen_sock);
 
-    auto &session = node.mapped();
-    // 关闭连接并通知上层
-    DisConnect((SOCKET_TYPE)session->sock);
-    sockToId.erase(session->sock);
+            for (size_t sock = 0; sock < r.slots.size(); sock++)
+            {
+                Slot &slot = r.slots[sock];
+                if (!slot.open || slot.closing)
+                    continue;
+
+                HandoffSession session;
+                session.fd = (int)sock;
+                session.reactor = (uint32_t)r.index;
+                session.peerAddr = slot.peerAddr;
+                session.sessionId = slot.sessionId;
+                session.idleMs = now > slot.lastActive ? now - slot.lastActive : 0;
+                if (slot.session)
+                {
+                    SessionContext &ctx = *slot.session;
+                    session.active = ctx.isActive;
+                    session.resumeCounter = ctx.resumeCounter;
+                    session.wireFormat = ctx.wireFormat;
+                    session.replayTop = ctx.replayTop;
+                    session.replayBitmap = ctx.replayBitmap;
+                    session.sk = ctx.sk;
+                    session.pk = ctx.pk;
+                    session.pk2 = ctx.pk2;
+                    session.iv = ctx.iv;
+                    session.sharedKey = ctx.sharedKey;
+                    session.resumeKey = ctx.resumeKey;
+                    session.sig = ctx.sig;
+                    if (exportSessionCb)
+                        session.appState = exportSessionCb(slot.sessionId);
+                }
+
+                RecvBuffer &buffer = slot.decoder.Buffer();
+                session.inbound.assign(buffer.ReadPtr(), buffer.ReadPtr() + buffer.Readable());
+                // 积压期间合并的推送追加在队尾，新进程写出积压后客户端即得到最新状态
+                for (const Packet &packet : slot.parked)
+                    EncodePacket(slot, packet);
+                slot.queue.CopyTo(session.outbound);
+                state.sessions.push_back(std::move(session));
+            }
+        }
+    }
 
-    return 0;
+    bool ok = SendHandoff((int)conn, state);
+    CLOSE_SOCKET(conn);
+    if (!ok)
+    {
+        LOG_ERROR("Hot restart failed, connections will be closed");
+        return;
+    }
+    LOG_INFO("Handed off " + std::to_string(state.sessions.size()) + " connection(s) in " +
+             std::to_string(GetTimeMS() - start) + " ms");
 }
 
-int Server::SendStatus(int sock, uint64_t sessionId, Frame::Status status, std::vector<uint8_t> data)
+bool Server::TakeOver(HandoffState &state)
 {
-    Frame frame(status, sessionId, {}, data);
-    LOG_INFO("Sending status " + std::to_string(status) + " to client (Sock: " + std::to_string(sock) + ")");
-    this->Send((SOCKET_TYPE)sock, frame);
-    return 0;
+    int sock = ConnectHandoff(handoffPath);
+    if (sock == -1)
+    {
+        // 旧进程不存在时没有任何状态被转移，按全新启动处理
+        LOG_WARN("No running server on handoff socket " + handoffPath + ", starting fresh");
+        return true;
+    }
+#ifndef _WIN32
+    if (!HandoffPeerAllowed(sock, geteuid()))
+    {
+        LOG_ERROR("Handoff socket " + handoffPath + " is held by another user, refusing to take over");
+        CLOSE_SOCKET((SOCKET_TYPE)sock);
+        return false;
+    }
+#endif
+
+    uint64_t start = GetTimeMS();
+    bool ok = RecvHandoff(sock, state);
+    CLOSE_SOCKET((SOCKET_TYPE)sock);
+    if (!ok)
+    {
+        LOG_ERROR("Failed to receive handoff state from previous process");
+        return false;
+    }
+
+    if ((int)state.reactorCount != threadCount)
+        LOG_INFO("Using " + std::to_string(state.reactorCount) + " reactor(s) inherited from previous process");
+    threadCount = std::max(1, std::min((int)state.reactorCount, MAX_REACTORS));
+    LOG_INFO("Received " + std::to_string(state.listenFds.size()) + " listen socket(s) and " +
+             std::to_string(state.sessions.size()) + " connection(s) in " + std::to_string(GetTimeMS() - start) + " ms");
+    return true;
 }
 
-int Server::OnFrame(int sock, Frame frame)
+void Server::AdoptSession(HandoffSession &session)
 {
-    auto it = sockToId.find(sock);
-    uint64_t sessionId;
-    Packet packet;
+    SOCKET_TYPE sock = (SOCKET_TYPE)session.fd;
+    size_t index = session.sessionId != 0 ? (size_t)(session.sessionId & 0xFF) : session.reactor;
+    if (index >= reactors.size())
+    {
+        LOG_WARN("Dropping handed-off connection with unknown reactor " + std::to_string(index));
+        CLOSE_SOCKET(sock);
+        return;
+    }
+    Reactor &r = *reactors[index];
 
-    if (it == sockToId.end())
-        sessionId = NewSession(sock);
-    else
-        sessionId = it->second;
+    admission.Adopt(session.peerAddr);
+    if (Connect(r, sock, session.peerAddr) != 0)
+        return;
+    Slot &slot = r.slots[sock];
+    uint64_t now = GetTimeMS();
+    slot.lastActive = now - std::min(session.idleMs, now);
+    r.expiry.Schedule((int)sock, slot.lastActive + sessionTimeout);
 
-    auto p = idToSession[sessionId].get();
+    if (session.sessionId != 0)
+    {
+        slot.context = std::make_unique<SessionContext>((int)sock, session.sessionId);
+        SessionContext &ctx = *slot.context;
+        ctx.isActive = session.active;
+        ctx.resumeCounter = session.resumeCounter;
+        ctx.wireFormat = session.wireFormat;
+        ctx.replayTop = session.replayTop;
+        ctx.replayBitmap = session.replayBitmap;
+        ctx.sk = std::move(session.sk);
+        ctx.pk = std::move(session.pk);
+        ctx.pk2 = std::move(session.pk2);
+        ctx.iv = std::move(session.iv);
+        if (ctx.iv.size() != FRAME_IV_SIZE)
+            ctx.InitNonce(true);
+        ctx.sharedKey = std::move(session.sharedKey);
+        ctx.resumeKey = std::move(session.resumeKey);
+        ctx.sig = std::move(session.sig);
+        ctx.lastHeartbeat = slot.lastActive;
+        if (ctx.isActive)
+            ctx.InitCipher();
+        slot.session = slot.context.get();
+        slot.sessionId = session.sessionId;
+        r.sessionIndex.Insert(session.sessionId, (int)sock);
+        if (importSessionCb)
+            importSessionCb(session.sessionId, session.appState);
+    }
 
-    switch (frame.head.status)
+    // 未凑齐的半帧留在解码器里，后续字节到达后继续拼接
+    if (!session.inbound.empty())
+        slot.decoder.Feed(session.inbound.data(), session.inbound.size());
+    // 旧进程未写出的字节原样续写，注册可写事件后由事件循环发送
+    if (!session.outbound.empty())
     {
-    case Frame::Status::Hello:
-        LOG_TRACE("Received Hello from client (Sock: " + std::to_string(sock) + ")");
-        if (it == sockToId.end())
-            SendStatus(sock, sessionId, Frame::Status::NewSession, p->Get_Pk_Sig());
-        else
-            SendStatus(sock, sessionId, Frame::Status::NewSession, p->Get_Pk_Sig());
-        break;
-    case Frame::Status::Pending:
-        LOG_TRACE("Received Pending from client (Sock: " + std::to_string(sock) + ")");
-        if (p->isActive)
-        {
-            SendStatus(sock, sessionId, Frame::Status::Activated);
-            return 0;
-        }
-        p->pk2.assign(frame.data.begin(), frame.data.begin() + 32);
-        if (!p->CalculateSharedKey())
-            SendStatus(sock, sessionId, Frame::Status::Error);
-        else
-            SendStatus(sock, sessionId, Frame::Status::Activated);
-        break;
-    case Frame::Status::Active:
-        LOG_TRACE("Received Active from client (Sock: " + std::to_string(sock) + ")");
-        if (!p->isActive)
-            SendStatus(sock, sessionId, Frame::Status::Inactive);
-        else if (!p->Decrypt(frame.data))
-            SendStatus(sock, sessionId, Frame::Status::Error);
-        else if (!packet.FromData(sessionId, frame.data))
-            SendStatus(sock, sessionId, Frame::Status::Error);
-        else
-        {
-            HeartBeat(sessionId);
-            // 通过回调通知上层
-            if (onPacketCb)
-                onPacketCb(packet);
-        }
-        break;
-    default:
-        LOG_WARN("Received Unknown frame from client (Sock: " + std::to_string(sock) + ")");
-        SendStatus(sock, sessionId, Frame::Status::InvalidRequest);
-        break;
+        slot.queue.Append(session.outbound.data(), session.outbound.size());
+        slot.queue.armed = true;
+        slot.congested = slot.queue.Size() >= highWatermark;
+        r.poller.Modify(sock, Poller::Readable | Poller::Writable);
+        ReportDepth(r, sock);
     }
-    return 0;
 }
 
-int Server::SendPacket(Packet packet)
+// --------------- Reactor 生命周期 -----------------
+
+bool Server::InitReactor(Reactor &r)
 {
-    auto it = idToSession.find(packet.sessionId);
-    if (it == idToSession.end())
-        return -1;
-    int sock = it->second->sock;
-    std::array<uint8_t, 16> iv;
-    std::vector<uint8_t> vec = GenerateRandomBytes(16);
-    std::copy(vec.begin(), vec.end(), iv.begin());
-    Frame frame(Frame::Status::Active, packet.sessionId, iv, packet.ToBytes());
-    this->Send((SOCKET_TYPE)sock, frame);
+    if (!r.poller.Init())
+        return false;
+
+    // 精度取超时时长的 1/8（最多 1 秒），一圈覆盖整个超时时长
+    uint64_t tick = std::min<uint64_t>(EXPIRY_TICK_MS, std::max<uint64_t>(1, sessionTimeout / 8));
+    r.expiry.Init(tick, (size_t)(sessionTimeout / tick) + 2);
+
+    // 热重启时监听 Socket 由旧进程交接而来，不重新 bind
+    if (r.listen_sock == (SOCKET_TYPE)INVALID_SOCKET)
+        r.listen_sock = CreateListenSocket();
+    if (r.listen_sock == (SOCKET_TYPE)INVALID_SOCKET)
+        return false;
+    r.poller.Add(r.listen_sock, Poller::Readable);
+
+#ifndef _WIN32
+    r.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (r.wake_fd == -1)
+    {
+        LOG_ERROR("eventfd failed: " + std::to_string(errno));
+        return false;
+    }
+    r.poller.Add(r.wake_fd, Poller::Readable);
+#endif
+    return true;
+}
+
+void Server::RunReactor(Reactor &r)
+{
+    std::vector<Poller::Event> events;
+    current = &r;
+
+    while (running)
+    {
+        // 无定时任务时无限阻塞，有则最多等到最近的到期时间；上一轮 accept 未完成时不阻塞
+        bool resumeAccept = r.acceptPending;
+        int n = r.poller.Wait(events, resumeAccept ? 0 : NextTimeout(r));
+
+        if (n < 0)
+        {
+            LOG_ERROR("Poll error: " + std::to_string(GET_LAST_ERROR()));
+            break;
+        }
+
+        for (const auto &ev : events)
+        {
+            if (ev.sock == r.listen_sock)
+            {
+                HandleNewConnection(r);
+                resumeAccept = false;
+            }
+            else if (ev.sock == r.wake_fd)
+                DrainMailbox(r);
+            else if (ev.sock == signal_fd)
+                OnSignal();
+            else if (ev.sock == handoff_sock)
+                OnHandoffRequest();
+            else
+            {
+                if (ev.events & Poller::Readable)
+                    HandleClient(r, ev.sock);
+                if (ev.events & Poller::Writable)
+                    FlushQueue(r, ev.sock);
+            }
+        }
+
+        // 边缘触发不会再次通知尚未 accept 的连接，需主动继续
+        if (resumeAccept)
+            HandleNewConnection(r);
+
+        RunLoopTimers(r);
+
+        // 本轮产生的所有出站帧按连接合并，一次系统调用写出
+        FlushPending(r);
+    }
+
+    current = nullptr;
+}
+
+void Server::CloseReactor(Reactor &r)
+{
+    for (size_t sock = 0; sock < r.slots.size(); sock++)
+    {
+        if (!r.slots[sock].open)
+            continue;
+        admission.Release(r.slots[sock].peerAddr);
+        CLOSE_SOCKET((SOCKET_TYPE)sock);
+    }
+    r.slots.clear();
+    r.connections = 0;
+    if (r.listen_sock != (SOCKET_TYPE)INVALID_SOCKET)
+    {
+        CLOSE_SOCKET(r.listen_sock);
+        r.listen_sock = (SOCKET_TYPE)INVALID_SOCKET;
+    }
+#ifndef _WIN32
+    if (r.wake_fd != (SOCKET_TYPE)INVALID_SOCKET)
+    {
+        close(r.wake_fd);
+        r.wake_fd = (SOCKET_TYPE)INVALID_SOCKET;
+    }
+#endif
+    r.poller.Close();
+}
+
+void Server::Post(Reactor &r, std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(r.mailboxMutex);
+        r.mailbox.push_back(std::move(task));
+    }
+    Wake(r);
+}
+
+void Server::Wake(Reactor &r)
+{
+#ifndef _WIN32
+    if (r.wake_fd != (SOCKET_TYPE)INVALID_SOCKET)
+    {
+        uint64_t one = 1;
+        ssize_t ret = write(r.wake_fd, &one, sizeof(one));
+        (void)ret;
+    }
+#endif
+}
+
+void Server::DrainMailbox(Reactor &r)
+{
+#ifndef _WIN32
+    uint64_t count;
+    while (read(r.wake_fd, &count, sizeof(count)) > 0)
+    {
+    }
+#endif
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(r.mailboxMutex);
+        tasks.swap(r.mailbox);
+    }
+    for (auto &task : tasks)
+    {
+        if (task)
+            task();
+    }
+}
+
+void Server::DrainMailboxes()
+{
+    // 任务可能向其他 Reactor 投递（如跨 Reactor 发送），反复排空直到全部为空；
+    // 执行期间以该 Reactor 的身份运行，使发送直接写入出站队列而不再投递
+    bool pending = true;
+    while (pending)
+    {
+        pending = false;
+        for (auto &rp : reactors)
+        {
+            current = rp.get();
+            DrainMailbox(*rp);
+        }
+        current = nullptr;
+        for (auto &rp : reactors)
+        {
+            std::lock_guard<std::mutex> lock(rp->mailboxMutex);
+            pending |= !rp->mailbox.empty();
+        }
+    }
+}
+
+// --------------- 事件循环定时器 -----------------
+
+void Server::AddLoopTimer(Reactor &r, uint64_t delayMs, std::function<void()> task)
+{
+    r.loopTimers.push({GetTimeMS() + delayMs, std::move(task)});
+}
+
+int Server::NextTimeout(Reactor &r)
+{
+#ifdef _WIN32
+    // select 无法被 eventfd 唤醒，定期醒来处理投递任务与停止信号
+    const int maxWait = 50;
+#else
+    const int maxWait = -1;
+#endif
+    if (r.loopTimers.empty())
+        return maxWait;
+    uint64_t now = GetTimeMS();
+    uint64_t deadline = r.loopTimers.top().deadline;
+    int wait = deadline <= now ? 0 : (int)(deadline - now);
+    return maxWait < 0 ? wait : std::min(wait, maxWait);
+}
+
+void Server::RunLoopTimers(Reactor &r)
+{
+#ifdef _WIN32
+    DrainMailbox(r);
+#endif
+    uint64_t now = GetTimeMS();
+    while (!r.loopTimers.empty() && r.loopTimers.top().deadline <= now)
+    {
+        auto task = std::move(const_cast<Reactor::LoopTimer &>(r.loopTimers.top()).task);
+        r.loopTimers.pop();
+        if (task)
+            task();
+    }
+}
+
+int Server::Connect(Reactor &r, SOCKET_TYPE sock, uint32_t peerAddr)
+{
+    if (!r.poller.Add(sock, Poller::Readable))
+    {
+        LOG_ERROR("Failed to register socket to poller (Sock: " + std::to_string(sock) + ")");
+        admission.Release(peerAddr);
+        CLOSE_SOCKET(sock);
+        return -1;
+    }
+    if ((size_t)sock >= r.slots.size())
+        r.slots.resize((size_t)sock + 1);
+    r.slots[sock].open = true;
+    r.slots[sock].peerAddr = peerAddr;
+    r.slots[sock].lastActive = GetTimeMS();
+    // 未完成握手的空连接同样受超时约束
+    r.expiry.Schedule((int)sock, r.slots[sock].lastActive + sessionTimeout);
+    ArmExpiry(r);
+    r.connections++;
+    LOG_TRACE("New connection accepted (Sock: " + std::to_string(sock) + ", Reactor: " + std::to_string(r.index) + ")");
+    LOG_TRACE("Total connected clients: " + std::to_string(r.connections));
+    return 0;
+}
+
+int Server::DisConnect(Reactor &r, SOCKET_TYPE sock)
+{
+    Slot *slot = SlotOf(r, sock);
+    if (!slot)
+        return -1;
+
+    // 已完成握手的会话在恢复窗口内保留，客户端重连时无需重新协商密钥
+    if (slot->context && slot->context->isActive && resumeWindow > 0 && !r.draining)
+        DetachSession(r, std::move(slot->context));
+    admission.Release(slot->peerAddr);
+    ReleaseSlot(r, sock);
+    CLOSE_SOCKET(sock);
+    LOG_INFO("Connection closed (Sock: " + std::to_string(sock) + ")");
+    LOG_DEBUG("Remaining connected clients: " + std::to_string(r.connections));
+    return 0;
+}
+
+void Server::ReleaseSlot(Reactor &r, SOCKET_TYPE sock)
+{
+    // 释放槽位与 Poller 注册，fd 由调用方关闭或转交
+    Slot &slot = r.slots[sock];
+    if (slot.sessionId != 0)
+    {
+        r.sessionIndex.Erase(slot.sessionId);
+        std::lock_guard<std::mutex> lock(r.depthMutex);
+        r.outboundDepth.erase(slot.sessionId);
+        r.rtt.erase(slot.sessionId);
+    }
+    r.expiry.Cancel((int)sock);
+    uint32_t generation = slot.generation + 1;
+    slot = Slot();
+    slot.generation = generation;
+    r.connections--;
+    r.poller.Remove(sock);
+}
+
+int Server::Send(Reactor &r, SOCKET_TYPE sock, Frame frame)
+{
+    Slot *slot = SlotOf(r, sock);
+    if (!slot || slot->closing)
+        return -1;
+    size_t len = frame.Size();
+    frame.WriteTo(slot->queue.Reserve(len));
+    slot->queue.Commit(len);
+    return Enqueued(r, sock, *slot);
+}
+
+int Server::Enqueued(Reactor &r, SOCKET_TYPE sock, Slot &slot)
+{
+    auto &queue = slot.queue;
+
+    // 客户端长期不读，积压超过硬上限：丢弃队列并断开，不再无限缓存
+    if (queue.Size() > hardLimit)
+    {
+        LOG_WARN("Outbound queue exceeded hard limit (" + std::to_string(queue.Size()) +
+                 " bytes), disconnecting slow client (Sock: " + std::to_string(sock) + ")");
+        queue.Clear();
+        slot.closing = true;
+        r.slowDisconnects.fetch_add(1, std::memory_order_relaxed);
+        ReportDepth(r, sock);
+        // 与发送失败相同，shutdown 后由读事件统一断开
+        shutdown(sock, SHUT_BOTH);
+        return -1;
+    }
+    if (queue.Size() >= highWatermark && !slot.congested)
+    {
+        LOG_DEBUG("Outbound queue above high watermark, shedding non-critical pushes (Sock: " + std::to_string(sock) + ")");
+        slot.congested = true;
+    }
+
+    // 已有积压时正在等待可写事件，只追加以保证顺序
+    if (queue.armed)
+    {
+        ReportDepth(r, sock);
+        return 0;
+    }
+    // 同一轮循环内发往该连接的帧在循环末尾统一写出
+    if (!queue.scheduled)
+    {
+        queue.scheduled = true;
+        r.pendingFlush.push_back(sock);
+    }
+    return 0;
+}
+
+void Server::FlushPending(Reactor &r)
+{
+    std::vector<SOCKET_TYPE> socks;
+    // 积压回落时补发的合并推送会登记新的待发连接，循环到没有为止
+    while (!r.pendingFlush.empty())
+    {
+        socks.swap(r.pendingFlush);
+        for (SOCKET_TYPE sock : socks)
+        {
+            // 同一连接在本轮内被关闭又复用时可能重复登记，以 scheduled 去重
+            Slot *slot = SlotOf(r, sock);
+            if (!slot || !slot->queue.scheduled)
+                continue;
+            slot->queue.scheduled = false;
+            if (!slot->queue.armed)
+                FlushQueue(r, sock);
+        }
+        socks.clear();
+    }
+
+    // 复用容量，避免每轮重新分配
+    r.pendingFlush.swap(socks);
+}
+
+int Server::FlushQueue(Reactor &r, SOCKET_TYPE sock)
+{
+    Slot *slot = SlotOf(r, sock);
+    if (!slot)
+        return 0;
+    auto &queue = slot->queue;
+
+    size_t frames = queue.Chunks();
+    size_t syscalls = 0;
+    SendQueue::FlushResult result = queue.Flush(sock, syscalls);
+    r.framesSent.fetch_add(frames - queue.Chunks(), std::memory_order_relaxed);
+    r.sendCalls.fetch_add(syscalls, std::memory_order_relaxed);
+    r.flushes.fetch_add(1, std::memory_order_relaxed);
+
+    switch (result)
+    {
+    case SendQueue::Drained:
+        // 快路径（一次写完）不触碰 epoll 与积压表；积压清空后取消可写关注
+        if (queue.armed)
+        {
+            queue.armed = false;
+            r.poller.Modify(sock, Poller::Readable);
+            ReportDepth(r, sock);
+        }
+        if (slot->congested)
+            ReleaseParked(r, sock);
+        return 0;
+    case SendQueue::WouldBlock:
+        LOG_TRACE("Send buffer full, " + std::to_string(queue.Size()) + " bytes queued (Sock: " + std::to_string(sock) + ")");
+        if (!queue.armed)
+        {
+            queue.armed = true;
+            r.poller.Modify(sock, Poller::Readable | Poller::Writable);
+        }
+        ReportDepth(r, sock);
+        if (slot->congested)
+            ReleaseParked(r, sock);
+        return 0;
+    case SendQueue::Failed:
+    default:
+        // 不在此处关闭，避免在读路径中途释放缓冲区；shutdown 后由读事件统一断开
+        LOG_ERROR("Error sending data to client (Sock: " + std::to_string(sock) + "): " + std::to_string(GET_LAST_ERROR()));
+        queue.Clear();
+        ReportDepth(r, sock);
+        shutdown(sock, SHUT_BOTH);
+        return -1;
+    }
+}
+
+void Server::ReportDepth(Reactor &r, SOCKET_TYPE sock)
+{
+    Slot *slot = SlotOf(r, sock);
+    if (!slot || slot->sessionId == 0)
+        return;
+    std::lock_guard<std::mutex> lock(r.depthMutex);
+    // 没有积压且从未丢弃过推送的会话不占用快照表
+    if (slot->queue.Empty() && slot->dropped == 0 && slot->coalesced == 0)
+        r.outboundDepth.erase(slot->sessionId);
+    else
+        r.outboundDepth[slot->sessionId] = {slot->queue.Size(), slot->dropped, slot->coalesced};
+}
+
+bool Server::ShedPacket(Reactor &r, Slot &slot, const Packet &packet)
+{
+    if (!slot.congested)
+        return false;
+
+    switch (DeliveryOf(packet.msgType))
+    {
+    case Delivery::Droppable:
+        slot.dropped++;
+        r.dropped.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case Delivery::Coalesce:
+    {
+        // 同类型的全量推送只保留最新一份，积压回落后再发出
+        auto it = std::find_if(slot.parked.begin(), slot.parked.end(), [&packet](const Packet &p)
+                               { return p.msgType == packet.msgType; });
+        if (it == slot.parked.end())
+        {
+            slot.parked.push_back(packet);
+            return true;
+        }
+        *it = packet;
+        slot.coalesced++;
+        r.coalesced.fetch_add(1, std::memory_order_relaxed);
+        break;
+    }
+    case Delivery::Critical:
+    default:
+        return false;
+    }
+
+    ReportDepth(r, (SOCKET_TYPE)slot.session->sock);
+    return true;
+}
+
+void Server::ReleaseParked(Reactor &r, SOCKET_TYPE sock)
+{
+    Slot *slot = SlotOf(r, sock);
+    if (!slot || slot->queue.Size() > lowWatermark)
+        return;
+
+    // 积压回落到低水位以下，恢复非关键推送并补发合并后的最新状态
+    LOG_DEBUG("Outbound queue below low watermark, resuming pushes (Sock: " + std::to_string(sock) + ")");
+    slot->congested = false;
+    std::vector<Packet> parked;
+    parked.swap(slot->parked);
+    for (const Packet &packet : parked)
+        SendPacketLocal(r, packet);
+}
+
+Server::NetStats Server::GetStats()
+{
+    NetStats stats;
+    for (auto &r : reactors)
+    {
+        stats.framesSent += r->framesSent.load(std::memory_order_relaxed);
+        stats.sendCalls += r->sendCalls.load(std::memory_order_relaxed);
+        stats.flushes += r->flushes.load(std::memory_order_relaxed);
+        stats.dropped += r->dropped.load(std::memory_order_relaxed);
+        stats.coalesced += r->coalesced.load(std::memory_order_relaxed);
+        stats.slowDisconnects += r->slowDisconnects.load(std::memory_order_relaxed);
+        stats.accepted += r->accepted.load(std::memory_order_relaxed);
+        stats.rejected += r->rejected.load(std::memory_order_relaxed);
+        stats.expired += r->expired.load(std::memory_order_relaxed);
+        stats.resumed += r->resumed.load(std::memory_order_relaxed);
+        stats.migrated += r->migrated.load(std::memory_order_relaxed);
+        stats.handshakes += r->handshakes.load(std::memory_order_relaxed);
+    }
+    stats.syscallsSaved = stats.framesSent > stats.sendCalls ? stats.framesSent - stats.sendCalls : 0;
+    return stats;
+}
+
+size_t Server::GetOutboundDepth(uint64_t sessionId)
+{
+    return GetOutboundStats(sessionId).depth;
+}
+
+Server::OutboundStats Server::GetOutboundStats(uint64_t sessionId)
+{
+    Reactor *r = ReactorOf(sessionId);
+    if (!r)
+        return {};
+    std::lock_guard<std::mutex> lock(r->depthMutex);
+    auto it = r->outboundDepth.find(sessionId);
+    return it == r->outboundDepth.end() ? OutboundStats() : it->second;
+}
+
+Server::RttStats Server::GetRtt(uint64_t sessionId)
+{
+    Reactor *r = ReactorOf(sessionId);
+    if (!r)
+        return {};
+    std::lock_guard<std::mutex> lock(r->depthMutex);
+    auto it = r->rtt.find(sessionId);
+    return it == r->rtt.end() ? RttStats() : it->second;
+}
+
+// --------------- 会话管理实现 -----------------
+
+uint64_t Server::GenerateSessionId(Reactor &r)
+{
+    uint64_t sessionId = 0;
+    do
+    {
+        sessionId = RandomU64();
+        // 低 8 位写入所属 Reactor，SendPacket 据此路由，无需全局表
+        sessionId = (sessionId & ~uint64_t(0xFF)) | uint64_t(r.index);
+        // 0 在索引中表示空桶，不能使用
+    } while ((sessionId >> 8) == 0 || r.sessionIndex.Find(sessionId) != -1 || r.detached.count(sessionId) != 0);
+    return sessionId;
+}
+
+Server::Reactor *Server::ReactorOf(uint64_t sessionId)
+{
+    size_t index = sessionId & 0xFF;
+    if (index >= reactors.size())
+        return nullptr;
+    return reactors[index].get();
+}
+
+Server::Slot *Server::SlotOf(Reactor &r, SOCKET_TYPE sock)
+{
+    if (sock == (SOCKET_TYPE)INVALID_SOCKET || (size_t)sock >= r.slots.size() || !r.slots[sock].open)
+        return nullptr;
+    return &r.slots[sock];
+}
+
+Server::Slot *Server::SessionSlot(Reactor &r, uint64_t sessionId)
+{
+    int sock = r.sessionIndex.Find(sessionId);
+    if (sock < 0)
+        return nullptr;
+    Slot *slot = SlotOf(r, (SOCKET_TYPE)sock);
+    return slot && slot->sessionId == sessionId ? slot : nullptr;
+}
+
+uint64_t Server::NewSession(Reactor &r, int sock)
+{
+    Slot &slot = r.slots[sock];
+    uint64_t sessionId = GenerateSessionId(r);
+    slot.context = std::make_unique<SessionContext>(sock, sessionId);
+    slot.session = slot.context.get();
+    slot.sessionId = sessionId;
+    r.sessionIndex.Insert(sessionId, sock);
+
+    return sessionId;
+}
+
+int Server::HeartBeat(Reactor &r, uint64_t sessionId)
+{
+    Slot *slot = SessionSlot(r, sessionId);
+    if (!slot)
+        return -1;
+    // 只记录时间，时间轮到期时再按该时间惰性续期
+    slot->lastActive = GetTimeMS();
+    return 0;
+}
+
+void Server::ArmExpiry(Reactor &r)
+{
+    if (r.expiryArmed || r.expiry.Empty())
+        return;
+    r.expiryArmed = true;
+    AddLoopTimer(r, r.expiry.TickMs(), [this, &r]()
+                 { ExpireSessions(r); });
+}
+
+void Server::ExpireSessions(Reactor &r)
+{
+    r.expiryArmed = false;
+    uint64_t now = GetTimeMS();
+    r.expiry.Advance(now, [this, &r, now](int sock) -> uint64_t
+                     {
+        Slot *slot = SlotOf(r, (SOCKET_TYPE)sock);
+        if (!slot)
+            return 0;
+        uint64_t deadline = slot->lastActive + sessionTimeout;
+        if (deadline > now)
+            return deadline; // 期间有过心跳，续期
+        LOG_INFO("Session timed out (Sock: " + std::to_string(sock) + ")");
+        r.expired.fetch_add(1, std::memory_order_relaxed);
+        DisConnect(r, (SOCKET_TYPE)sock);
+        return 0; });
+    ArmExpiry(r);
+}
+
+int Server::CleanUp(Reactor &r, uint64_t sessionId)
+{
+    int sock = r.sessionIndex.Find(sessionId);
+    if (sock < 0)
+        return -1;
+
+    // 关闭连接，会话随槽位一起释放
+    DisConnect(r, (SOCKET_TYPE)sock);
+    return 0;
+}
+
+int Server::SendStatus(Reactor &r, int sock, uint64_t sessionId, Frame::Status status, std::vector<uint8_t> data)
+{
+    Frame frame(status, sessionId, {}, data);
+    LOG_INFO("Sending status " + std::to_string(status) + " to client (Sock: " + std::to_string(sock) + ")");
+    this->Send(r, (SOCKET_TYPE)sock, frame);
+    return 0;
+}
+
+int Server::OnFrame(Reactor &r, int sock, Frame &frame)
+{
+    // 调用方保证 sock 对应已打开的槽位
+    Slot &slot = r.slots[sock];
+    Packet packet;
+
+    // 轻量心跳不解密、不反序列化、不进入上层回调，也不为空连接创建会话
+    if (frame.head.status == Frame::Status::Ping)
+        return OnPing(r, sock, frame);
+
+    bool isNew = slot.session == nullptr;
+    // 断线重连：新连接的首个 Hello 携带旧 sessionId 与证明时直接恢复，失败则按新会话处理
+    if (isNew && frame.head.status == Frame::Status::Hello && frame.head.sessionId != 0 && ResumeSession(r, sock, frame))
+        return 0;
+    uint64_t sessionId = isNew ? NewSession(r, sock) : slot.sessionId;
+    auto p = slot.session;
+
+    switch (frame.head.status)
+    {
+    case Frame::Status::Hello:
+        LOG_TRACE("Received Hello from client (Sock: " + std::to_string(sock) + ")");
+        // 临时密钥尚未就绪（新会话或上次生成失败）时生成；仍在计算时 OfferKey 忽略重复的 Hello
+        if (isNew || p->sig.empty())
+            OfferKey(r, sock);
+        else
+            SendStatus(r, sock, sessionId, Frame::Status::NewSession, p->Get_Pk_Sig());
+        break;
+    case Frame::Status::Pending:
+        LOG_TRACE("Received Pending from client (Sock: " + std::to_string(sock) + ")");
+        // 负载：[客户端临时公钥][期望的线路格式 1B，可选]；Activated 应答带回采用的格式，不认识的格式按标准格式处理
+        if (p->isActive)
+        {
+            SendStatus(r, sock, sessionId, Frame::Status::Activated, {p->wireFormat});
+            return 0;
+        }
+        if (!keyAgreement)
+        {
+            // 明文模式：负载只有可选的线路格式字节
+            bool compact = compactEncoding && frame.data.size() == 1 && frame.data[0] == (uint8_t)WireFormat::Compact;
+            p->wireFormat = (uint8_t)(compact ? WireFormat::Compact : WireFormat::Standard);
+            p->isActive = true;
+            SendStatus(r, sock, sessionId, Frame::Status::Activated, {p->wireFormat});
+            return 0;
+        }
+        if (p->sig.empty() || (frame.data.size() != X25519_KEY_SIZE && frame.data.size() != X25519_KEY_SIZE + 1))
+            SendStatus(r, sock, sessionId, Frame::Status::Error);
+        else
+        {
+            WireFormat format = WireFormat::Standard;
+            if (compactEncoding && frame.data.size() > X25519_KEY_SIZE &&
+                frame.data[X25519_KEY_SIZE] == (uint8_t)WireFormat::Compact)
+                format = WireFormat::Compact;
+            frame.data.resize(X25519_KEY_SIZE);
+            AcceptKey(r, sock, std::move(frame.data), format);
+        }
+        break;
+    case Frame::Status::Active:
+    case Frame::Status::Batch:
+        LOG_TRACE("Received " + std::string(frame.head.status == Frame::Status::Batch ? "Batch" : "Active") +
+                  " from client (Sock: " + std::to_string(sock) + ")");
+        if (!p->isActive)
+            SendStatus(r, sock, sessionId, Frame::Status::Inactive);
+        else if (encryption && !p->Decrypt(frame.data, frame.head.iv.data(), frame.AuthData().data(), 12))
+        {
+            // 认证失败、反射或重放的帧在反序列化之前丢弃，不会重复执行落子等操作
+            LOG_WARN("Rejected unauthenticated or replayed frame (Sock: " + std::to_string(sock) + ")");
+            SendStatus(r, sock, sessionId, Frame::Status::Error);
+        }
+        else if (frame.head.status == Frame::Status::Batch)
+            return OnBatch(r, sock, frame.data);
+        else if (!packet.FromData(sessionId, std::move(frame.data), (WireFormat)p->wireFormat))
+            SendStatus(r, sock, sessionId, Frame::Status::Error);
+        else
+        {
+            slot.lastActive = GetTimeMS();
+            // 通过回调通知上层（上层非线程安全，多 Reactor 时串行执行）
+            if (onPacketCb)
+            {
+                std::lock_guard<std::mutex> lock(logicMutex);
+                onPacketCb(packet);
+            }
+        }
+        break;
+    default:
+        LOG_WARN("Received Unknown frame from client (Sock: " + std::to_string(sock) + ")");
+        SendStatus(r, sock, sessionId, Frame::Status::InvalidRequest);
+        break;
+    }
     return 0;
 }
+
+int Server::OnBatch(Reactor &r, int sock, std::vector<uint8_t> &data)
+{
+    Slot &slot = r.slots[sock];
+    SessionContext *session = slot.session;
+    std::vector<Packet> packets;
+    if (!ReadBatch(slot.sessionId, data, packets, (WireFormat)session->wireFormat))
+    {
+        // 整批拒绝，不执行其中任何一个请求
+        SendStatus(r, sock, slot.sessionId, Frame::Status::Error);
+        return 0;
+    }
+    slot.lastActive = GetTimeMS();
+    slot.batched.insert(slot.batched.end(), std::make_move_iterator(packets.begin()), std::make_move_iterator(packets.end()));
+    DispatchBatched(r, (SOCKET_TYPE)sock, slot);
+    return 0;
+}
+
+void Server::DispatchBatched(Reactor &r, SOCKET_TYPE sock, Slot &slot)
+{
+    // 按序分发；期间发往本会话的应答与推送先收集起来，全部处理完再合并发出。
+    // 一批中的异步请求同样受 inFlight 上限约束：达到上限时其余请求留待有请求完成后继续，
+    // 此前分发的应答先行发出
+    slot.batching = true;
+    if (onPacketCb)
+    {
+        std::lock_guard<std::mutex> lock(logicMutex);
+        while (!slot.batched.empty() && slot.inFlight < maxInFlight)
+        {
+            Packet packet = std::move(slot.batched.front());
+            slot.batched.pop_front();
+            onPacketCb(packet);
+        }
+    }
+    else
+        slot.batched.clear();
+    slot.batching = false;
+    FlushReplies(r, sock, slot);
+}
+
+int Server::OnPing(Reactor &r, int sock, const Frame &frame)
+{
+    Slot &slot = r.slots[sock];
+    uint64_t now = GetTimeUS();
+    // 只有已完成握手的会话以 Ping 作心跳；未握手的连接照常应答，但不能借此一直占用槽位与准入名额
+    if (slot.session && slot.session->isActive)
+        slot.lastActive = now / 1000;
+
+    uint64_t clientTime = 0, echoed = 0;
+    if (frame.data.size() >= PING_SIZE)
+    {
+        std::memcpy(&clientTime, frame.data.data(), 8);
+        std::memcpy(&echoed, frame.data.data() + 8, 8);
+    }
+
+    // 回显的是本进程上一次 Pong 的时间戳；超过心跳超时的视为无效（伪造或过期）
+    if (slot.sessionId != 0 && echoed != 0 && echoed <= now && now - echoed <= sessionTimeout * 1000)
+    {
+        uint32_t sample = (uint32_t)(now - echoed);
+        std::lock_guard<std::mutex> lock(r.depthMutex);
+        RttStats &stats = r.rtt[slot.sessionId];
+        if (stats.samples == 0)
+            stats.smoothed = stats.min = sample;
+        else
+        {
+            stats.smoothed = (uint32_t)(((uint64_t)stats.smoothed * 7 + sample) / 8);
+            stats.min = std::min(stats.min, sample);
+        }
+        stats.last = sample;
+        stats.samples++;
+    }
+
+    std::vector<uint8_t> pong(PING_SIZE);
+    std::memcpy(pong.data(), &clientTime, 8);
+    std::memcpy(pong.data() + 8, &now, 8);
+    Send(r, (SOCKET_TYPE)sock, Frame(Frame::Status::Pong, slot.sessionId, {}, std::move(pong)));
+    return 0;
+}
+
+void Server::OfferKey(Reactor &r, int sock)
+{
+    Slot &slot = r.slots[sock];
+    uint64_t sessionId = slot.sessionId;
+    uint32_t generation = slot.generation;
+    if (!keyAgreement)
+    {
+        // 明文模式没有临时公钥与签名，应答空负载
+        SendStatus(r, sock, sessionId, Frame::Status::NewSession);
+        return;
+    }
+    // 上一次运算完成时会应答，重复的 Hello 不再排队
+    if (slot.handshakeInFlight)
+        return;
+    slot.handshakeInFlight = true;
+    // 运算在独立的上下文上进行，线程池计算期间不触碰槽位中的会话
+    auto keys = std::make_shared<SessionContext>(sock, sessionId);
+    auto ok = std::make_shared<bool>(false);
+    bool queued = RunHandshake(r, [this, keys, ok]()
+                               { *ok = keys->KeyGen() && keys->Sign(*identity); },
+                               [this, &r, sock, sessionId, generation, keys, ok]()
+                               {
+        // 连接已断开或槽位已被复用
+        Slot *slot = SlotOf(r, (SOCKET_TYPE)sock);
+        if (!slot || slot->generation != generation || slot->sessionId != sessionId)
+            return;
+        slot->handshakeInFlight = false;
+        if (!slot->session->sig.empty())
+            return;
+        if (!*ok)
+        {
+            LOG_ERROR("Key generation failed (Sock: " + std::to_string(sock) + ")");
+            SendStatus(r, sock, sessionId, Frame::Status::Error);
+            return;
+        }
+        SessionContext &ctx = *slot->session;
+        ctx.ShareKeys(*keys);
+        SendStatus(r, sock, sessionId, Frame::Status::NewSession, ctx.Get_Pk_Sig()); });
+    HandshakeQueued(r, sock, sessionId, queued);
+}
+
+void Server::AcceptKey(Reactor &r, int sock, std::vector<uint8_t> clientPk, WireFormat format)
+{
+    Slot &slot = r.slots[sock];
+    uint64_t sessionId = slot.sessionId;
+    uint32_t generation = slot.generation;
+    if (slot.handshakeInFlight)
+        return;
+    slot.handshakeInFlight = true;
+    auto keys = std::make_shared<SessionContext>(sock, sessionId);
+    keys->ShareKeys(*slot.session);
+    keys->pk2 = std::move(clientPk);
+    auto ok = std::make_shared<bool>(false);
+    bool queued = RunHandshake(r, [keys, ok]()
+                               { *ok = keys->DeriveKey(); },
+                               [this, &r, sock, sessionId, generation, keys, ok, format]()
+                               {
+        Slot *slot = SlotOf(r, (SOCKET_TYPE)sock);
+        if (!slot || slot->generation != generation || slot->sessionId != sessionId)
+            return;
+        slot->handshakeInFlight = false;
+        SessionContext &ctx = *slot->session;
+        if (!ctx.isActive && *ok)
+        {
+            ctx.pk2 = std::move(keys->pk2);
+            ctx.sharedKey = std::move(keys->sharedKey);
+            ctx.resumeKey = std::move(keys->resumeKey);
+            ctx.InitNonce(true);
+            ctx.isActive = ctx.InitCipher();
+            ctx.wireFormat = (uint8_t)format;
+        }
+        if (ctx.isActive)
+            SendStatus(r, sock, sessionId, Frame::Status::Activated, {ctx.wireFormat});
+        else
+            SendStatus(r, sock, sessionId, Frame::Status::Error); });
+    HandshakeQueued(r, sock, sessionId, queued);
+}
+
+void Server::HandshakeQueued(Reactor &r, int sock, uint64_t sessionId, bool queued)
+{
+    if (queued)
+    {
+        r.handshakes.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // 线程池积压已达上限：不排队，客户端收到 Error 后可重发 Hello / Pending
+    r.slots[sock].handshakeInFlight = false;
+    LOG_WARN("Handshake queue full, rejecting (Sock: " + std::to_string(sock) + ")");
+    SendStatus(r, sock, sessionId, Frame::Status::Error);
+}
+
+bool Server::RunHandshake(Reactor &r, std::function<void()> compute, std::function<void()> apply, bool bounded)
+{
+    if (handshakeWorkers.empty())
+    {
+        compute();
+        apply();
+        return true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(handshakeMutex);
+        if (bounded && handshakeJobs.size() >= MAX_HANDSHAKE_JOBS)
+            return false;
+        handshakeJobs.push_back([this, &r, compute = std::move(compute), apply = std::move(apply)]() mutable
+                                {
+            compute();
+            Post(r, std::move(apply)); });
+    }
+    handshakeCv.notify_one();
+    return true;
+}
+
+void Server::RunAsync(uint64_t sessionId, std::function<void()> work, std::function<void()> done)
+{
+    // 只在会话所属 Reactor 上（即分发请求的回调内）计数；此时已持有逻辑锁，同步执行时直接调用 done
+    Reactor *r = ReactorOf(sessionId);
+    Slot *slot = r && current == r ? SessionSlot(*r, sessionId) : nullptr;
+    if (handshakeWorkers.empty() || !slot)
+    {
+        work();
+        done();
+        return;
+    }
+
+    slot->inFlight++;
+    SOCKET_TYPE sock = (SOCKET_TYPE)slot->session->sock;
+    uint32_t generation = slot->generation;
+    RunHandshake(*r, std::move(work), [this, r, sock, sessionId, generation, done = std::move(done)]()
+                 {
+        // 连接已断开也要执行 done，上层状态（如已写库的用户）须与数据库一致
+        {
+            std::lock_guard<std::mutex> lock(logicMutex);
+            done();
+        }
+        Slot *slot = SlotOf(*r, sock);
+        if (!slot || slot->generation != generation || slot->sessionId != sessionId)
+            return;
+        bool paused = slot->inFlight >= maxInFlight;
+        slot->inFlight--;
+        if (!paused)
+            return;
+        // 事件循环已停止（交接或退出）时不再读取新请求，未读字节随连接交接；
+        // 已解密的 Batch 剩余请求无法交接，仍在本进程分发
+        if (running)
+            HandleClient(*r, sock);
+        else if (!slot->batched.empty())
+            DispatchBatched(*r, sock, *slot); }, false);
+}
+
+void Server::StartHandshakeWorkers()
+{
+    handshakeStopping = false;
+    for (int i = 0; i < handshakeThreads; i++)
+    {
+        handshakeWorkers.emplace_back([this]()
+                                      {
+            while (true)
+            {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lock(handshakeMutex);
+                    handshakeCv.wait(lock, [this]()
+                                     { return handshakeStopping || !handshakeJobs.empty(); });
+                    if (handshakeJobs.empty())
+                        return;
+                    job = std::move(handshakeJobs.front());
+                    handshakeJobs.pop_front();
+                }
+                job();
+            } });
+    }
+}
+
+void Server::StopHandshakeWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(handshakeMutex);
+        handshakeStopping = true;
+    }
+    handshakeCv.notify_all();
+    for (auto &worker : handshakeWorkers)
+        worker.join();
+    handshakeWorkers.clear();
+}
+
+bool Server::ResumeSession(Reactor &r, int sock, Frame &frame)
+{
+    uint64_t sessionId = frame.head.sessionId;
+    Reactor *owner = ReactorOf(sessionId);
+    // 明文模式没有恢复密钥，知道 sessionId 即可伪造证明，不允许恢复
+    if (resumeWindow == 0 || !keyAgreement || !owner || frame.data.size() != RESUME_PROOF_SIZE)
+        return false;
+    if (owner == &r)
+        return ResumeLocal(r, sock, sessionId, frame.data);
+
+    // 会话归属其他 Reactor：连接连同未解析的字节迁移过去，由属主线程校验
+    Slot &slot = r.slots[sock];
+    uint32_t peerAddr = slot.peerAddr;
+    RecvBuffer &buffer = slot.decoder.Buffer();
+    std::vector<uint8_t> inbound(buffer.ReadPtr(), buffer.ReadPtr() + buffer.Readable());
+    ReleaseSlot(r, (SOCKET_TYPE)sock); // 连接仍然存在，准入计数不归还
+    r.migrated.fetch_add(1, std::memory_order_relaxed);
+    Post(*owner, [this, owner, sock, peerAddr, sessionId, proof = std::move(frame.data), inbound = std::move(inbound)]()
+         {
+        Reactor &o = *owner;
+        if (Connect(o, (SOCKET_TYPE)sock, peerAddr) != 0)
+            return;
+        if (!ResumeLocal(o, sock, sessionId, proof))
+        {
+            NewSession(o, sock);
+            OfferKey(o, sock);
+        }
+        // 原 Reactor 已读出但未处理的字节放回解码器，随后与内核中的剩余数据一起处理
+        if (!inbound.empty())
+        {
+            o.slots[sock].decoder.Feed(inbound.data(), inbound.size());
+            HandleClient(o, (SOCKET_TYPE)sock);
+        } });
+    return true;
+}
+
+bool Server::ResumeLocal(Reactor &r, int sock, uint64_t sessionId, const std::vector<uint8_t> &proof)
+{
+    std::unique_ptr<SessionContext> context;
+    auto it = r.detached.find(sessionId);
+    if (it != r.detached.end())
+    {
+        if (!it->second.context->AcceptResume(proof))
+            return false;
+        context = std::move(it->second.context);
+        r.detached.erase(it);
+    }
+    else
+    {
+        // 旧连接尚未察觉断开（移动网络切换时常见）：证明有效则关闭旧连接并接管会话
+        Slot *old = SessionSlot(r, sessionId);
+        if (!old || !old->session->AcceptResume(proof))
+            return false;
+        context = std::move(old->context);
+        SOCKET_TYPE oldSock = (SOCKET_TYPE)context->sock;
+        admission.Release(old->peerAddr);
+        ReleaseSlot(r, oldSock);
+        CLOSE_SOCKET(oldSock);
+        LOG_INFO("Replaced stale connection (Sock: " + std::to_string(oldSock) + ") on session resume");
+    }
+
+    Slot &slot = r.slots[sock];
+    context->sock = sock;
+    slot.context = std::move(context);
+    slot.session = slot.context.get();
+    slot.sessionId = sessionId;
+    slot.lastActive = GetTimeMS();
+    r.sessionIndex.Insert(sessionId, sock);
+    r.resumed.fetch_add(1, std::memory_order_relaxed);
+    LOG_INFO("Session resumed (Sock: " + std::to_string(sock) + ")");
+    SendStatus(r, sock, sessionId, Frame::Status::Resumed);
+    return true;
+}
+
+void Server::DetachSession(Reactor &r, std::unique_ptr<SessionContext> context)
+{
+    uint64_t sessionId = context->sessionId;
+    uint64_t deadline = GetTimeMS() + resumeWindow;
+    context->sock = -1;
+    r.detached[sessionId] = {std::move(context), deadline};
+    r.detachedOrder.emplace_back(deadline, sessionId);
+    if (!r.detachedArmed)
+    {
+        r.detachedArmed = true;
+        AddLoopTimer(r, resumeWindow, [this, &r]()
+                     { ExpireDetached(r); });
+    }
+}
+
+void Server::ExpireDetached(Reactor &r)
+{
+    r.detachedArmed = false;
+    uint64_t now = GetTimeMS();
+    while (!r.detachedOrder.empty() && r.detachedOrder.front().first <= now)
+    {
+        auto [deadline, sessionId] = r.detachedOrder.front();
+        r.detachedOrder.pop_front();
+        // 期间被恢复又再次断开的会话有更晚的截止时间，以表中记录为准
+        auto it = r.detached.find(sessionId);
+        if (it != r.detached.end() && it->second.deadline == deadline)
+            r.detached.erase(it);
+    }
+    if (!r.detachedOrder.empty())
+    {
+        r.detachedArmed = true;
+        AddLoopTimer(r, r.detachedOrder.front().first - now, [this, &r]()
+                     { ExpireDetached(r); });
+    }
+}
+
+int Server::SendPacket(Packet packet)
+{
+    Reactor *r = ReactorOf(packet.sessionId);
+    if (!r)
+        return -1;
+
+    // 会话归属其他 Reactor 时投递到其线程执行，保证会话表只被属主线程访问
+    if (current == r)
+        return SendPacketLocal(*r, packet);
+    Post(*r, [this, r, packet = std::move(packet)]()
+         { SendPacketLocal(*r, packet); });
+    return 0;
+}
+
+int Server::SendPacketLocal(Reactor &r, const Packet &packet)
+{
+    int sock = r.sessionIndex.Find(packet.sessionId);
+    Slot *slot = sock < 0 ? nullptr : SlotOf(r, (SOCKET_TYPE)sock);
+    if (!slot || slot->closing)
+        return -1;
+    // 积压期间非关键推送在序列化之前就被丢弃或合并
+    if (ShedPacket(r, *slot, packet))
+        return 0;
+    if (slot->batching)
+    {
+        slot->replies.push_back(packet);
+        return 0;
+    }
+    if (!EncodePacket(*slot, packet))
+        return -1;
+    Enqueued(r, (SOCKET_TYPE)sock, *slot);
+    return 0;
+}
+
+bool Server::EncodePacket(Slot &slot, const Packet &packet)
+{
+    return EncodeFrame(slot, Frame::Status::Active, &packet, 1);
+}
+
+bool Server::EncodeFrame(Slot &slot, Frame::Status status, const Packet *packets, size_t count)
+{
+    // 未完成密钥协商的会话不能收到明文推送；不加密时 iv 无意义，保持全零
+    SessionContext *session = slot.session;
+    if (encryption && (!session || !session->isActive))
+    {
+        LOG_WARN("Dropping packet for session without cipher (Sock: " + std::to_string(session ? session->sock : -1) + ")");
+        return false;
+    }
+
+    // 先求出负载的确切长度，帧头、负载与 tag 一次写入队列预留的空间
+    WireFormat format = session ? (WireFormat)session->wireFormat : WireFormat::Standard;
+    bool batch = status == Frame::Status::Batch;
+    size_t payloadLen = batch ? BatchEncodedSize(packets, count, format) : packets[0].EncodedSize(format);
+    size_t len = sizeof(Frame::Header) + payloadLen + (encryption ? AEAD_TAG_SIZE : 0);
+    if (len > MAX_FRAME_SIZE)
+    {
+        // 接收端会把超长帧当作损坏数据重新同步，整条流随之错乱：丢弃该包，改为应答 Error
+        LOG_WARN("Dropping " + std::to_string(len) + "-byte frame above MAX_FRAME_SIZE (Session: " +
+                 std::to_string(slot.sessionId) + ")");
+        Frame error(Frame::Status::Error, slot.sessionId);
+        size_t errorLen = error.Size();
+        error.WriteTo(slot.queue.Reserve(errorLen));
+        slot.queue.Commit(errorLen);
+        return true;
+    }
+    uint8_t *out = slot.queue.Reserve(len);
+    uint8_t *payload = out + sizeof(Frame::Header);
+    if (batch)
+        WriteBatch(packets, count, payload, format);
+    else
+        packets[0].WriteTo(payload, format);
+
+    Frame frame(status, slot.sessionId);
+    if (encryption)
+    {
+        // nonce 取会话计数，负载在队列中原地加密
+        session->NextNonce(frame.head.iv.data());
+        std::array<uint8_t, 12> aad = frame.AuthData();
+        if (!session->Seal(payload, payloadLen, frame.head.iv.data(), aad.data(), aad.size(), payload + payloadLen))
+        {
+            LOG_WARN("Dropping packet for session without cipher (Sock: " + std::to_string(session->sock) + ")");
+            return false;
+        }
+    }
+    frame.head.length = (uint32_t)len;
+    std::memcpy(out, &frame.head, sizeof(Frame::Header));
+    slot.queue.Commit(len);
+    return true;
+}
+
+void Server::FlushReplies(Reactor &r, SOCKET_TYPE sock, Slot &slot)
+{
+    // 按接收端的帧长上限分组，每组一个 Batch 帧；单个超过上限的包独占一组，由 EncodeFrame 改为应答 Error
+    size_t overhead = sizeof(Frame::Header) + 4 + (encryption ? AEAD_TAG_SIZE : 0);
+    WireFormat format = (WireFormat)slot.session->wireFormat;
+    bool queued = false;
+    size_t begin = 0;
+    while (begin < slot.replies.size())
+    {
+        size_t end = begin, len = overhead;
+        while (end < slot.replies.size())
+        {
+            size_t size = 4 + slot.replies[end].EncodedSize(format);
+            if (end > begin && len + size > MAX_FRAME_SIZE)
+                break;
+            len += size;
+            end++;
+        }
+        queued |= EncodeFrame(slot, Frame::Status::Batch, slot.replies.data() + begin, end - begin);
+        begin = end;
+    }
+    slot.replies.clear();
+    if (queued)
+        Enqueued(r, sock, slot);
+}
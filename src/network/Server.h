@@ -5,6 +5,14 @@
 #include "Packet.h"
 #include "TimeTools.hpp"
 #include "Crypto.h"
+#include "Socket.h"
+#include "Poller.h"
+#include "SendQueue.h"
+#include "FrameDecoder.h"
+#include "SessionIndex.h"
+#include "AdmissionControl.h"
+#include "ExpiryWheel.h"
+#include "Handoff.h"
 
 #include <vector>
 #include <cstdint>
@@ -13,76 +21,326 @@
 #include <functional>
 #include <unordered_map>
 #include <chrono>
-
-#ifdef _WIN32
-// Windows 平台
-
-#define WIN32_LEAN_AND_MEAN
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#undef byte
-#pragma comment(lib, "ws2_32.lib")
-using SOCKET_TYPE = SOCKET;
-
-#else
-// Linux 平台
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <unistd.h>
-#include <fcntl.h>
-#include <errno.h>
-using SOCKET_TYPE = int;
-
-#endif
+#include <atomic>
+#include <queue>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <deque>
+#include <condition_variable>
 
 class Server
 {
+public:
+    // 单个会话的出站积压快照
+    struct OutboundStats
+    {
+        size_t depth = 0;       // 队列中尚未写出的字节数
+        uint64_t dropped = 0;   // 积压期间丢弃的推送数
+        uint64_t coalesced = 0; // 积压期间被合并覆盖的推送数
+    };
+
+    // 单个会话的往返时延（微秒），由 Ping 回显的服务端时间戳测得
+    struct RttStats
+    {
+        uint32_t smoothed = 0; // 指数平滑值（1/8 权重，同 TCP SRTT）
+        uint32_t min = 0;      // 最小值
+        uint32_t last = 0;     // 最近一次采样
+        uint64_t samples = 0;  // 采样次数
+    };
+
 private:
-    int port;                                // 服务器运行端口
-    SOCKET_TYPE max_fd;                      // 维护最大的文件描述符，用于select选择
-    SOCKET_TYPE listen_sock;                 // 监听 Socket
-    std::vector<SOCKET_TYPE> client_sockets; // 维护客户端 Socket 列表
-    std::map<SOCKET_TYPE, std::vector<uint8_t>> _session_buffers;
+    /**
+     * @brief 会话槽，按 fd 下标存放在 Reactor::slots 中
+     *
+     * 接收路径由 fd 直接定位槽位，一次数组访问即可拿到会话与缓冲区，不做任何哈希。
+     * 热字段集中在开头，解帧后的会话解析只触碰第一个缓存行。
+     * generation 在每次释放槽位时递增，延迟任务凭 (fd, generation) 判断连接是否已被复用。
+     */
+    struct Slot
+    {
+        uint64_t sessionId = 0;                  // 0 表示尚未建立会话
+        SessionContext *session = nullptr;       // 指向 context，避免热路径解引用 unique_ptr
+        uint64_t lastActive = 0;                 // 最后活跃时间（毫秒），心跳只写这一个字段
+        uint32_t generation = 0;                 // 槽位复用计数
+        bool open = false;                       // fd 已注册到本 Reactor
+        bool congested = false;                  // 出站积压超过高水位，直到回落到低水位
+        bool closing = false;                    // 超过硬上限，已 shutdown，等待读事件断开
+        uint32_t peerAddr = 0;                   // 来源 IPv4 地址（网络字节序），断开时归还准入计数
+        std::unique_ptr<SessionContext> context; // 会话状态（密钥、心跳时间等）
+        FrameDecoder decoder;                    // 接收缓冲区与解帧进度
+        SendQueue queue;                         // 出站队列，非空时关注可写事件
+        std::vector<Packet> parked;              // 积压期间被合并的推送，每种 MsgType 只留最新一份
+        uint64_t dropped = 0;                    // 积压期间丢弃的推送数
+        uint64_t coalesced = 0;                  // 积压期间被合并覆盖的推送数
+        bool batching = false;                   // 正在处理 Batch 帧，发往本会话的包先收集起来
+        std::vector<Packet> replies;             // Batch 帧处理期间收集的应答与推送，处理完合并成 Batch 帧发出
+        size_t inFlight = 0;                     // 已分发、尚未完成的异步请求数，达到上限时暂停读取
+        std::deque<Packet> batched;              // Batch 帧中因达到 inFlight 上限尚未分发的请求，先于后续帧处理
+        bool handshakeInFlight = false;          // 密钥生成或协商已交给线程池，完成前重复的 Hello / Pending 忽略
+    };
+
+    /**
+     * @brief 单个 Reactor 线程拥有的全部状态
+     *
+     * 每个 Reactor 有独立的监听 Socket（SO_REUSEPORT）、Poller 与会话分区，
+     * 连接处理路径上不需要任何全局锁。其他线程只能通过 Post 投递任务。
+     */
+    struct Reactor
+    {
+        int index = 0;
+        SOCKET_TYPE listen_sock = (SOCKET_TYPE)INVALID_SOCKET; // 监听 Socket
+        Poller poller;                                         // epoll（Linux）/ select（Windows）
+        std::thread thread;                                    // Reactor 0 运行在调用 Run 的线程
+        bool acceptPending = false;                            // 本轮 accept 达到上限，下一轮继续
+        bool draining = false;                                 // 已停止 accept，等待出站队列清空
+
+        // Session 分区：sessionId 的低 8 位即 Reactor 编号
+        std::vector<Slot> slots;               // 会话槽，按 fd 下标直接索引
+        size_t connections = 0;                // 已打开的槽位数
+        SessionIndex sessionIndex;             // sessionId -> fd，仅发送路径使用
+        ExpiryWheel expiry;                    // 空闲超时时间轮，按 fd 索引
+        bool expiryArmed = false;              // 已登记下一次时间轮推进
+        std::vector<SOCKET_TYPE> pendingFlush; // 本轮循环内有新帧待发的连接
+
+        // 断线后保留的会话，恢复窗口内可凭 sessionId 与证明重新绑定到新连接
+        struct DetachedSession
+        {
+            std::unique_ptr<SessionContext> context;
+            uint64_t deadline;
+        };
+        std::unordered_map<uint64_t, DetachedSession> detached;
+        std::deque<std::pair<uint64_t, uint64_t>> detachedOrder; // (deadline, sessionId)，窗口固定故按时间有序
+        bool detachedArmed = false;                               // 已登记下一次过期清理
+
+        // 发送统计（其他线程只读）
+        std::atomic<uint64_t> framesSent{0}; // 写出的帧数
+        std::atomic<uint64_t> sendCalls{0};  // 发送系统调用次数
+        std::atomic<uint64_t> flushes{0};    // 批量发送次数
+
+        // 背压统计
+        std::atomic<uint64_t> dropped{0};         // 丢弃的推送数
+        std::atomic<uint64_t> coalesced{0};       // 被合并覆盖的推送数
+        std::atomic<uint64_t> slowDisconnects{0}; // 超过硬上限被断开的连接数
+
+        // 准入统计
+        std::atomic<uint64_t> accepted{0}; // 准入的连接数
+        std::atomic<uint64_t> rejected{0}; // 因全局 / 单 IP 上限被拒绝的连接数
+        std::atomic<uint64_t> expired{0};  // 心跳超时被断开的连接数
+        std::atomic<uint64_t> resumed{0};  // 断线重连后恢复的会话数
+        std::atomic<uint64_t> migrated{0}; // 因会话归属其他 Reactor 而迁出的连接数
+        std::atomic<uint64_t> handshakes{0}; // 提交的握手运算数（密钥生成与协商各计一次）
+
+        // 出站积压快照，仅在慢路径（队列非空或发生过丢弃）更新，供其他线程查询
+        std::mutex depthMutex;
+        std::unordered_map<uint64_t, OutboundStats> outboundDepth;
+        std::unordered_map<uint64_t, RttStats> rtt; // 同受 depthMutex 保护，每次 Ping 更新一次
 
-    // Session 合并后的数据与定时轮
-    // 使用 TimeTools 替代 TimeWheel
-    std::unordered_map<int, uint64_t> sockToId;
-    std::unordered_map<uint64_t, std::unique_ptr<SessionContext>> idToSession;
+        // 事件循环内的定时任务（最小堆），epoll 超时跟随最近的到期时间
+        struct LoopTimer
+        {
+            uint64_t deadline;
+            std::function<void()> task;
+            bool operator>(const LoopTimer &other) const { return deadline > other.deadline; }
+        };
+        std::priority_queue<LoopTimer, std::vector<LoopTimer>, std::greater<LoopTimer>> loopTimers;
+
+        // 跨线程投递的任务队列，由 wake_fd（eventfd）唤醒
+        std::mutex mailboxMutex;
+        std::vector<std::function<void()>> mailbox;
+        SOCKET_TYPE wake_fd = (SOCKET_TYPE)INVALID_SOCKET;
+    };
+
+    int port;                                        // 服务器运行端口
+    size_t lowWatermark;                             // 积压回落到此以下时恢复非关键推送
+    size_t highWatermark;                            // 积压超过此值时丢弃 / 合并非关键推送
+    size_t hardLimit;                                // 积压超过此值时断开连接
+    uint64_t sessionTimeout;                         // 无心跳超过此时长（毫秒）断开连接
+    uint64_t resumeWindow;                           // 断线后会话保留时长（毫秒），0 表示不支持恢复
+    bool encryption;                                 // 已激活会话的 Active 帧负载使用 AES-256-GCM
+    bool keyAgreement;                               // 握手进行 X25519 协商与签名；平台不支持时为 false，会话直接激活
+    bool compactEncoding;                            // 客户端请求时启用紧凑线路格式
+    std::unique_ptr<SigningKey> identity;            // 服务器长期身份，为每个会话的临时公钥签名
+    int handshakeThreads;                            // 握手公钥运算与异步请求的线程数，0 表示在 Reactor 线程上执行
+    size_t maxInFlight;                              // 单会话未完成异步请求上限
+    int backlog;                                     // 监听队列长度
+    int acceptBatch;                                 // 每轮事件循环最多 accept 的连接数
+    AdmissionControl admission;                      // 全局与单 IP 连接上限，各 Reactor 共享
+    int threadCount;                                 // Reactor 线程数
+    std::vector<std::unique_ptr<Reactor>> reactors;  // 各 Reactor 分区
+    std::atomic<bool> running;                       // 事件循环运行标志
+    std::atomic<bool> looping;                       // Run 尚未返回
+    std::mutex stopMutex;                            // 串行化 Stop
+    std::atomic<bool> draining;                      // 已开始优雅退出
+    std::atomic<size_t> drainingReactors;            // 尚未完成排空的 Reactor 数
+    uint64_t drainStart;                             // 排空开始时间（毫秒）
+    uint64_t drainDeadline;                          // 超过此时间强制关闭剩余连接
+    uint64_t drainTimeout;                           // 收到退出信号后的排空时限（毫秒）
+    bool handleSignals;                              // 是否由 Reactor 0 处理 SIGINT / SIGTERM
+    SOCKET_TYPE signal_fd;                           // signalfd（Linux）
+    std::string handoffPath;                         // 热重启交接用的 Unix 域 Socket 路径，空表示不启用
+    bool takeover;                                   // Init 时从旧进程接管连接
+    SOCKET_TYPE handoff_sock;                        // 等待新进程连接的交接监听 Socket（Reactor 0）
+    SOCKET_TYPE handoff_conn;                        // 已连接的新进程，Run 退出前向其交接
+    std::function<std::vector<uint8_t>(uint64_t)> exportSessionCb;                  // 导出会话的上层状态
+    std::function<void(uint64_t, const std::vector<uint8_t> &)> importSessionCb; // 恢复会话的上层状态
+    std::mutex logicMutex;                           // 上层 Handler/ObjectManager 非线程安全，回调串行执行
+
+    // 握手线程池：建连风暴时 X25519 / Ed25519 运算不占用 Reactor，结果经 Post 投递回属主 Reactor
+    std::vector<std::thread> handshakeWorkers;
+    std::mutex handshakeMutex;
+    std::condition_variable handshakeCv;
+    std::deque<std::function<void()>> handshakeJobs;
+    bool handshakeStopping = false;
+    inline static thread_local Reactor *current = nullptr; // 当前线程所属的 Reactor
 
     // 回调函数：当接收到 Packet 时调用
     std::function<void(const Packet &)> onPacketCb;
 
     // 会话管理方法
-    uint64_t GenerateSessionId();
-    uint64_t NewSession(int sock);
-    int HeartBeat(uint64_t sessionId);
-    int CleanUp(uint64_t sessionId);
-    int SendStatus(int sock, uint64_t sessionId, Frame::Status status, std::vector<uint8_t> data = {});
-    int OnFrame(int sock, Frame frame); // 解析数据帧
+    uint64_t GenerateSessionId(Reactor &r);
+    uint64_t NewSession(Reactor &r, int sock);
+    int HeartBeat(Reactor &r, uint64_t sessionId);
+    int CleanUp(Reactor &r, uint64_t sessionId);
+    void ArmExpiry(Reactor &r);
+    void ExpireSessions(Reactor &r);
+    int SendStatus(Reactor &r, int sock, uint64_t sessionId, Frame::Status status, std::vector<uint8_t> data = {});
+    int OnFrame(Reactor &r, int sock, Frame &frame); // 解析数据帧
+    int OnPing(Reactor &r, int sock, const Frame &frame);
+    int OnBatch(Reactor &r, int sock, std::vector<uint8_t> &data); // 已解密的 Batch 负载，逐个分发后合并应答
+    void DispatchBatched(Reactor &r, SOCKET_TYPE sock, Slot &slot); // 按序分发 batched，达到 inFlight 上限时停下
+    void OfferKey(Reactor &r, int sock);                                  // 生成临时密钥并签名，应答 NewSession
+    void AcceptKey(Reactor &r, int sock, std::vector<uint8_t> clientPk, WireFormat format); // 导出会话密钥，应答 Activated
+    // 队列达到上限时不提交并返回 false；bounded 为 false 时不受上限约束（异步请求已受 maxInFlight 限制）
+    bool RunHandshake(Reactor &r, std::function<void()> compute, std::function<void()> apply, bool bounded = true);
+    void HandshakeQueued(Reactor &r, int sock, uint64_t sessionId, bool queued); // 计数，或在队列已满时应答 Error
+    void StartHandshakeWorkers();
+    void StopHandshakeWorkers(); // 已排队的运算全部完成、结果投递后返回
+    bool ResumeSession(Reactor &r, int sock, Frame &frame);
+    bool ResumeLocal(Reactor &r, int sock, uint64_t sessionId, const std::vector<uint8_t> &proof);
+    void DetachSession(Reactor &r, std::unique_ptr<SessionContext> context);
+    void ExpireDetached(Reactor &r);
+    Reactor *ReactorOf(uint64_t sessionId);
+    Slot *SlotOf(Reactor &r, SOCKET_TYPE sock);
+    Slot *SessionSlot(Reactor &r, uint64_t sessionId);
 
     // 辅助函数
     bool InitializeNetworking();
     void CleanupNetworking();
     bool SetNonBlocking(SOCKET_TYPE);
-    int HandleNewConnection(SOCKET_TYPE);
-    int HandleClient(SOCKET_TYPE);
+    int HandleNewConnection(Reactor &r);
+    int HandleClient(Reactor &r, SOCKET_TYPE sock);
     SOCKET_TYPE CreateListenSocket();
-    int Connect(SOCKET_TYPE sock);
-    int DisConnect(SOCKET_TYPE sock);
-    int Send(SOCKET_TYPE sock, Frame frame);
+    int Connect(Reactor &r, SOCKET_TYPE sock, uint32_t peerAddr);
+    int DisConnect(Reactor &r, SOCKET_TYPE sock);
+    void ReleaseSlot(Reactor &r, SOCKET_TYPE sock);
+    int Send(Reactor &r, SOCKET_TYPE sock, Frame frame);
+    int Enqueued(Reactor &r, SOCKET_TYPE sock, Slot &slot); // 入队后的积压检查与发送登记
+    int FlushQueue(Reactor &r, SOCKET_TYPE sock);
+    void FlushPending(Reactor &r);
+    void ReportDepth(Reactor &r, SOCKET_TYPE sock);
+    bool ShedPacket(Reactor &r, Slot &slot, const Packet &packet);
+    void ReleaseParked(Reactor &r, SOCKET_TYPE sock);
+    int SendPacketLocal(Reactor &r, const Packet &packet);
+    bool EncodePacket(Slot &slot, const Packet &packet); // 编码、加密为一帧，直接写入出站队列
+    bool EncodeFrame(Slot &slot, Frame::Status status, const Packet *packets, size_t count); // Active 帧 count 为 1
+    void FlushReplies(Reactor &r, SOCKET_TYPE sock, Slot &slot);       // 收集的应答按帧长上限分组发出
+
+    // Reactor 生命周期与跨线程投递
+    bool InitReactor(Reactor &r);
+    void RunReactor(Reactor &r);
+    void CloseReactor(Reactor &r);
+    void Post(Reactor &r, std::function<void()> task);
+    void Wake(Reactor &r);
+    void DrainMailbox(Reactor &r);
+    void DrainMailboxes(); // 事件循环全部停止后执行剩余投递任务，不持有逻辑锁
+
+    // 优雅退出
+    void BeginDrain(Reactor &r);
+    void DrainStep(Reactor &r);
+    void OnSignal();
+
+    // 热重启交接
+    bool ListenForHandoff();
+    void OnHandoffRequest();
+    void HandOff();
+    bool TakeOver(HandoffState &state);
+    void AdoptSession(HandoffSession &session);
+
+    // 事件循环定时器
+    void AddLoopTimer(Reactor &r, uint64_t delayMs, std::function<void()> task);
+    int NextTimeout(Reactor &r);
+    void RunLoopTimers(Reactor &r);
 
 public:
+    // 网络层统计快照，各 Reactor 汇总
+    struct NetStats
+    {
+        uint64_t framesSent = 0;    // 写出的帧数
+        uint64_t sendCalls = 0;     // 发送系统调用次数
+        uint64_t flushes = 0;       // 批量发送次数
+        uint64_t syscallsSaved = 0; // 相比每帧一次 send 节省的系统调用数
+        uint64_t dropped = 0;         // 背压丢弃的推送数
+        uint64_t coalesced = 0;       // 背压合并覆盖的推送数
+        uint64_t slowDisconnects = 0; // 超过硬上限被断开的连接数
+        uint64_t accepted = 0;        // 准入的连接数
+        uint64_t rejected = 0;        // 因连接上限被拒绝的连接数
+        uint64_t expired = 0;         // 心跳超时被断开的连接数
+        uint64_t resumed = 0;         // 断线重连后恢复的会话数
+        uint64_t migrated = 0;        // 恢复时迁移到属主 Reactor 的连接数
+        uint64_t handshakes = 0;      // 提交的握手运算数（密钥生成与协商各计一次）
+    };
+
     Server();
     ~Server();
 
+    // 需在 Init 之前调用
+    void SetPort(int port);
+    void SetThreadCount(int count); // 多于 1 个时每个线程使用独立的 SO_REUSEPORT 监听 Socket
+    void SetBackpressure(size_t low, size_t high, size_t hard); // 单会话出站积压水位（字节）
+    void SetBacklog(int backlog);                               // 监听队列长度
+    void SetAcceptBatch(int count);                             // 每轮事件循环最多 accept 的连接数，避免建连风暴饿死已有连接
+    void SetConnectionLimits(size_t maxConnections, uint32_t maxPerAddress); // 全局 / 单 IP 并发连接上限，0 表示不限制
+    void SetSessionTimeout(uint64_t ms);                        // 心跳超时时长
+    void SetResumeWindow(uint64_t ms);                          // 断线后会话可恢复的时长，0 表示关闭
+    void SetEncryption(bool enable);                            // Active 帧负载加密（AES-256-GCM，nonce 取帧头 iv 前 12 字节），默认开启
+                                                                // 平台没有 X25519 / Ed25519（Windows）时 Init 报错并强制关闭
+    void SetCompactEncoding(bool enable);                       // 允许客户端在握手时选用紧凑线路格式（见 CompactCodec.h），默认开启
+    bool SetIdentity(const std::vector<uint8_t> &seed);         // 载入长期身份（Ed25519 种子），未设置时随机生成；热重启前后须一致
+    void SetHandshakeThreads(int count);                        // 握手公钥运算与异步请求交给独立线程，0 表示在 Reactor 线程上执行
+    void SetMaxInFlight(size_t count);                          // 单会话未完成异步请求上限，达到后暂停读取该连接直到有请求完成
+    void SetDrainTimeout(uint64_t ms);                          // 优雅退出时等待出站队列清空的时限
+    void SetHandleSignals(bool enable);                         // 收到 SIGINT / SIGTERM 时优雅退出，第二次信号立即退出
+    // 热重启：在 path 上等待新进程连接，连接到来时交出监听 Socket 与全部连接后 Run 返回；
+    // takeover 为 true 时 Init 先从 path 上的旧进程接管，再在同一路径上等待下一次重启
+    void SetHandoffPath(const std::string &path, bool takeover = false);
+    // 交接时随会话一起传递的上层状态（如登录用户）；导出在全部 Reactor 退出后调用，导入在 Init 中调用。
+    // 网络层只交接连接与会话密钥，上层未经此回调导出的状态（房间、对局等）在新进程中不存在
+    void SetHandoffCallbacks(std::function<std::vector<uint8_t>(uint64_t)> exportSession,
+                             std::function<void(uint64_t, const std::vector<uint8_t> &)> importSession);
+
+    // 需在创建任何线程之前调用（含 Logger / TimeTools），使退出信号只经由 signalfd 送达
+    static void BlockShutdownSignals();
+
     int Init();
-    int Run();
+    int Run(); // 阻塞直至 Stop；Reactor 0 运行在调用线程，其余各自启动线程
     int Stop();
+    int Shutdown(); // 优雅退出：停止 accept，出站队列清空（或超时）后关闭连接，Run 随后返回；可从任意线程调用
 
     // 注册回调：当接收到 Packet 时调用此回调
     void SetOnPacketCallback(std::function<void(const Packet &)> cb);
-    int SendPacket(Packet packet); // Packet 序列化并发送
+    int SendPacket(Packet packet); // Packet 序列化并发送，可从任意线程调用
+    // 在回调内把耗时请求（如写库）转为异步：work 在工作线程上执行，done 回到会话所属 Reactor 后在逻辑锁内执行，
+    // 期间同一会话的后续请求照常处理，响应可乱序送达（客户端以 requestId 匹配）。
+    // 未配置工作线程或不在会话所属 Reactor 上调用时两者依次同步执行
+    void RunAsync(uint64_t sessionId, std::function<void()> work, std::function<void()> done);
+
+    // 查询会话出站队列中尚未写出的字节数，可从任意线程调用；持续增长说明客户端读取过慢
+    size_t GetOutboundDepth(uint64_t sessionId);
+    OutboundStats GetOutboundStats(uint64_t sessionId);
+    RttStats GetRtt(uint64_t sessionId); // 无采样时各项为 0
+    const std::vector<uint8_t> &GetIdentityKey() const; // 身份公钥，客户端据此验证 NewSession 中的签名
+    NetStats GetStats();
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,80 @@
+#include "SessionIndex.h"
+
+#define INITIAL_CAPACITY 64 // 必须为 2 的幂
+
+SessionIndex::SessionIndex() : entries(INITIAL_CAPACITY, Entry{0, -1}), mask(INITIAL_CAPACITY - 1), count(0) {}
+
+void SessionIndex::Insert(uint64_t sessionId, int fd)
+{
+    // 装载因子不超过 1/2，保证探测链很短
+    if ((count + 1) * 2 > entries.size())
+        Grow();
+
+    size_t i = Home(sessionId);
+    while (entries[i].sessionId != 0)
+    {
+        if (entries[i].sessionId == sessionId)
+        {
+            entries[i].fd = fd;
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+    entries[i] = {sessionId, fd};
+    count++;
+}
+
+int SessionIndex::Find(uint64_t sessionId) const
+{
+    if (sessionId == 0)
+        return -1;
+    for (size_t i = Home(sessionId); entries[i].sessionId != 0; i = (i + 1) & mask)
+    {
+        if (entries[i].sessionId == sessionId)
+            return (int)entries[i].fd;
+    }
+    return -1;
+}
+
+bool SessionIndex::Erase(uint64_t sessionId)
+{
+    if (sessionId == 0)
+        return false;
+    size_t i = Home(sessionId);
+    while (entries[i].sessionId != sessionId)
+    {
+        if (entries[i].sessionId == 0)
+            return false;
+        i = (i + 1) & mask;
+    }
+
+    // 后移回填：把探测链上后续可以前移的项搬到空位，保持查找不中断
+    size_t hole = i;
+    for (size_t j = (i + 1) & mask; entries[j].sessionId != 0; j = (j + 1) & mask)
+    {
+        size_t home = Home(entries[j].sessionId);
+        // home 不在 (hole, j] 区间内时，该项可以移到 hole
+        if (((j - home) & mask) >= ((j - hole) & mask))
+        {
+            entries[hole] = entries[j];
+            hole = j;
+        }
+    }
+    entries[hole] = {0, -1};
+    count--;
+    return true;
+}
+
+void SessionIndex::Grow()
+{
+    std::vector<Entry> old;
+    old.swap(entries);
+    entries.assign(old.size() * 2, Entry{0, -1});
+    mask = entries.size() - 1;
+    count = 0;
+    for (const Entry &e : old)
+    {
+        if (e.sessionId != 0)
+            Insert(e.sessionId, (int)e.fd);
+    }
+}
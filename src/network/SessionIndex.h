@@ -0,0 +1,42 @@
+#ifndef SESSION_INDEX_H
+#define SESSION_INDEX_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief sessionId -> fd 的紧凑索引（开放寻址，线性探测）
+ *
+ * 仅供发送路径（SendPacket / 定时清理）按 sessionId 找连接；接收路径直接按 fd 访问会话槽。
+ * sessionId 本身是随机数，直接取其高位作为桶号，无需再做哈希。
+ * 每项 16 字节，一个缓存行容纳 4 个桶；删除使用后移回填，不留墓碑。
+ * sessionId 为 0 表示空桶，因此 0 不能作为合法的 sessionId。
+ */
+class SessionIndex
+{
+public:
+    SessionIndex();
+
+    void Insert(uint64_t sessionId, int fd); // 已存在则覆盖
+    int Find(uint64_t sessionId) const;      // 不存在返回 -1
+    bool Erase(uint64_t sessionId);
+
+    size_t Size() const { return count; }
+
+private:
+    struct Entry
+    {
+        uint64_t sessionId;
+        int64_t fd;
+    };
+
+    std::vector<Entry> entries;
+    size_t mask;
+    size_t count;
+
+    size_t Home(uint64_t sessionId) const { return (size_t)(sessionId >> 8) & mask; } // 低 8 位是 Reactor 编号，不参与分桶
+    void Grow();
+};
+
+#endif // SESSION_INDEX_H
@@ -0,0 +1,46 @@
+#ifndef SOCKET_H
+#define SOCKET_H
+
+// 跨平台 Socket 类型与错误码宏，供 Server / Poller 共用
+
+#ifdef _WIN32
+// Windows 平台
+
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#undef byte
+#pragma comment(lib, "ws2_32.lib")
+using SOCKET_TYPE = SOCKET;
+
+#define GET_LAST_ERROR() WSAGetLastError()
+#define WOULD_BLOCK_ERROR WSAEWOULDBLOCK
+#define CLOSE_SOCKET(s) closesocket(s)
+#define SLEEP(ms) Sleep(ms)
+#define SEND_FLAGS 0
+#define SHUT_BOTH SD_BOTH
+
+#else
+// Linux 平台
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+using SOCKET_TYPE = int;
+
+#ifndef INVALID_SOCKET
+#define INVALID_SOCKET (-1)
+#endif
+
+#define GET_LAST_ERROR() errno
+#define WOULD_BLOCK_ERROR EWOULDBLOCK
+#define CLOSE_SOCKET(s) close(s)
+#define SLEEP(ms) usleep((ms) * 1000)
+#define SEND_FLAGS MSG_NOSIGNAL // 对端关闭时返回 EPIPE 而不是触发 SIGPIPE
+#define SHUT_BOTH SHUT_RDWR
+
+#endif
+
+#endif // SOCKET_H
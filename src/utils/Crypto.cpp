@@ -5,70 +5,530 @@
 #include <bcrypt.h>
 #else
 #include <openssl/rand.h>
+#include <openssl/hmac.h>
+#include <openssl/evp.h>
+#include <openssl/crypto.h>
 #endif
 
-std::vector<uint8_t> GenerateRandomBytes(size_t size)
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include <cstring>
+#include <atomic>
+
+#define RANDOM_POOL_SIZE 4096
+
+static bool SystemRandom(uint8_t *out, size_t len)
 {
 #ifdef _WIN32
-    std::vector<uint8_t> buffer(size);
-    if (BCryptGenRandom(NULL, buffer.data(), (ULONG)size, BCRYPT_USE_SYSTEM_PREFERRED_RNG) != 0)
+    return BCryptGenRandom(NULL, out, (ULONG)len, BCRYPT_USE_SYSTEM_PREFERRED_RNG) == 0;
+#else
+    return RAND_bytes(out, (int)len) == 1;
+#endif
+}
+
+static void Cleanse(uint8_t *data, size_t len)
+{
+#ifdef _WIN32
+    SecureZeroMemory(data, len);
+#else
+    OPENSSL_cleanse(data, len);
+#endif
+}
+
+namespace
+{
+#ifndef _WIN32
+// fork 出的子进程不能沿用父进程缓冲中的字节：子进程中递增代数，各线程的池随之作废
+std::atomic<uint32_t> forkGeneration{0};
+const int forkHandler = pthread_atfork(nullptr, nullptr, []()
+                                       { forkGeneration.fetch_add(1, std::memory_order_relaxed); });
+#endif
+
+struct RandomPool
+{
+    uint8_t buffer[RANDOM_POOL_SIZE];
+    size_t offset = RANDOM_POOL_SIZE; // 首次使用时补满
+#ifndef _WIN32
+    uint32_t generation = 0;
+#endif
+
+    ~RandomPool() { Cleanse(buffer, sizeof(buffer)); }
+};
+
+thread_local RandomPool randomPool;
+}
+
+bool RandomFill(uint8_t *out, size_t len)
+{
+    if (len > RANDOM_POOL_SIZE / 4)
+        return SystemRandom(out, len);
+
+    RandomPool &pool = randomPool;
+#ifndef _WIN32
+    uint32_t generation = forkGeneration.load(std::memory_order_relaxed);
+    if (pool.generation != generation)
     {
-        return std::vector<uint8_t>(size, 0);
+        pool.generation = generation;
+        pool.offset = RANDOM_POOL_SIZE;
     }
-    return buffer;
-#else
-    std::vector<uint8_t> buffer(size);
-    if (RAND_bytes(buffer.data(), (int)size) != 1)
+#endif
+    if (pool.offset + len > RANDOM_POOL_SIZE)
     {
-        return std::vector<uint8_t>(size, 0);
+        if (!SystemRandom(pool.buffer, RANDOM_POOL_SIZE))
+            return false;
+        pool.offset = 0;
     }
+    std::memcpy(out, pool.buffer + pool.offset, len);
+    Cleanse(pool.buffer + pool.offset, len);
+    pool.offset += len;
+    return true;
+}
+
+uint64_t RandomU64()
+{
+    uint64_t value = 0;
+    return RandomFill(reinterpret_cast<uint8_t *>(&value), sizeof(value)) ? value : 0;
+}
+
+std::vector<uint8_t> GenerateRandomBytes(size_t size)
+{
+    std::vector<uint8_t> buffer(size);
+    if (!RandomFill(buffer.data(), size))
+        return std::vector<uint8_t>(size, 0);
     return buffer;
+}
+
+std::vector<uint8_t> HmacSha256(const std::vector<uint8_t> &key, const uint8_t *data, size_t len)
+{
+    std::vector<uint8_t> mac(32, 0);
+#ifdef _WIN32
+    BCRYPT_ALG_HANDLE alg = NULL;
+    BCRYPT_HASH_HANDLE hash = NULL;
+    if (BCryptOpenAlgorithmProvider(&alg, BCRYPT_SHA256_ALGORITHM, NULL, BCRYPT_ALG_HANDLE_HMAC_FLAG) != 0)
+        return mac;
+    if (BCryptCreateHash(alg, &hash, NULL, 0, (PUCHAR)key.data(), (ULONG)key.size(), 0) == 0)
+    {
+        BCryptHashData(hash, (PUCHAR)data, (ULONG)len, 0);
+        BCryptFinishHash(hash, mac.data(), (ULONG)mac.size(), 0);
+        BCryptDestroyHash(hash);
+    }
+    BCryptCloseAlgorithmProvider(alg, 0);
+#else
+    unsigned int macLen = 0;
+    HMAC(EVP_sha256(), key.data(), (int)key.size(), data, len, mac.data(), &macLen);
+#endif
+    return mac;
+}
+
+// 比较耗时与首个不同字节的位置无关
+static bool ConstantTimeEqual(const uint8_t *a, const uint8_t *b, size_t len)
+{
+#ifdef _WIN32
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; i++)
+        diff |= a[i] ^ b[i];
+    return diff == 0;
+#else
+    return CRYPTO_memcmp(a, b, len) == 0;
 #endif
 }
 
-// TODO: 实现以下加密算法
-// 1. DH 密钥交换
-// 2. AES-CBC 加密/解密
-// 3. 数字签名验证
+std::vector<uint8_t> HkdfSha256(const std::vector<uint8_t> &salt, const std::vector<uint8_t> &ikm,
+                                const std::vector<uint8_t> &info, size_t len)
+{
+    // 提取：PRK = HMAC(salt, ikm)；扩展：T(i) = HMAC(PRK, T(i-1) | info | i)
+    std::vector<uint8_t> prk = HmacSha256(salt.empty() ? std::vector<uint8_t>(32, 0) : salt, ikm.data(), ikm.size());
+    std::vector<uint8_t> okm;
+    std::vector<uint8_t> block;
+    for (uint8_t i = 1; okm.size() < len; i++)
+    {
+        std::vector<uint8_t> input(block);
+        input.insert(input.end(), info.begin(), info.end());
+        input.push_back(i);
+        block = HmacSha256(prk, input.data(), input.size());
+        okm.insert(okm.end(), block.begin(), block.end());
+    }
+    okm.resize(len);
+    return okm;
+}
+
+// info = 标签 | 服务端公钥 | 客户端公钥，不同用途的密钥只靠标签区分
+static std::vector<uint8_t> DeriveLabeledKey(const char *label, const std::vector<uint8_t> &secret,
+                                             const std::vector<uint8_t> &serverPk, const std::vector<uint8_t> &clientPk)
+{
+    std::vector<uint8_t> info(label, label + std::strlen(label));
+    info.insert(info.end(), serverPk.begin(), serverPk.end());
+    info.insert(info.end(), clientPk.begin(), clientPk.end());
+    return HkdfSha256({}, secret, info, AEAD_KEY_SIZE);
+}
+
+std::vector<uint8_t> DeriveSessionKey(const std::vector<uint8_t> &secret, const std::vector<uint8_t> &serverPk,
+                                      const std::vector<uint8_t> &clientPk)
+{
+    return DeriveLabeledKey("gomoku session key", secret, serverPk, clientPk);
+}
+
+std::vector<uint8_t> DeriveResumeKey(const std::vector<uint8_t> &secret, const std::vector<uint8_t> &serverPk,
+                                     const std::vector<uint8_t> &clientPk)
+{
+    return DeriveLabeledKey("gomoku resume key", secret, serverPk, clientPk);
+}
+
+#ifdef _WIN32
+// CNG 不提供 Ed25519，X25519 也只能经由 ECDH 命名曲线间接使用；Windows 上握手暂不可用。
+// KeyAgreementSupported 返回 false，Server 启动时据此关闭加密并跳过密钥协商，以下函数不会被调用
+bool KeyAgreementSupported() { return false; }
+
+struct SigningState
+{
+};
+
+struct AgreementState
+{
+};
+
+bool X25519Agree(const std::vector<uint8_t> &, const std::vector<uint8_t> &, std::vector<uint8_t> &) { return false; }
+bool VerifySignature(const std::vector<uint8_t> &, const uint8_t *, size_t, const uint8_t *) { return false; }
+
+SigningKey::SigningKey(const std::vector<uint8_t> &seed) : seed(seed) {}
+std::vector<uint8_t> SigningKey::Sign(const uint8_t *, size_t) const { return {}; }
+#else
+bool KeyAgreementSupported() { return true; }
+
+struct SigningState
+{
+    EVP_PKEY *key = nullptr;
+
+    ~SigningState() { EVP_PKEY_free(key); }
+};
+
+struct AgreementState
+{
+    EVP_PKEY *key = nullptr;
+
+    ~AgreementState() { EVP_PKEY_free(key); }
+};
+
+static bool Agree(EVP_PKEY *key, const std::vector<uint8_t> &peerPk, std::vector<uint8_t> &secret)
+{
+    if (peerPk.size() != X25519_KEY_SIZE)
+        return false;
+    EVP_PKEY *peer = EVP_PKEY_new_raw_public_key(EVP_PKEY_X25519, nullptr, peerPk.data(), peerPk.size());
+    EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new(key, nullptr);
+    secret.resize(X25519_KEY_SIZE);
+    size_t len = secret.size();
+    // 低阶点得到全零秘密时 derive 失败
+    bool ok = ctx && peer &&
+              EVP_PKEY_derive_init(ctx) == 1 &&
+              EVP_PKEY_derive_set_peer(ctx, peer) == 1 &&
+              EVP_PKEY_derive(ctx, secret.data(), &len) == 1 && len == X25519_KEY_SIZE;
+    EVP_PKEY_CTX_free(ctx);
+    EVP_PKEY_free(peer);
+    if (!ok)
+        secret.clear();
+    return ok;
+}
+
+bool X25519Agree(const std::vector<uint8_t> &sk, const std::vector<uint8_t> &peerPk, std::vector<uint8_t> &secret)
+{
+    if (sk.size() != X25519_KEY_SIZE)
+        return false;
+    AgreementState state;
+    state.key = EVP_PKEY_new_raw_private_key(EVP_PKEY_X25519, nullptr, sk.data(), sk.size());
+    return state.key && Agree(state.key, peerPk, secret);
+}
+
+bool VerifySignature(const std::vector<uint8_t> &publicKey, const uint8_t *msg, size_t len, const uint8_t *sig)
+{
+    if (publicKey.size() != X25519_KEY_SIZE)
+        return false;
+    EVP_PKEY *key = EVP_PKEY_new_raw_public_key(EVP_PKEY_ED25519, nullptr, publicKey.data(), publicKey.size());
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    bool ok = key && ctx &&
+              EVP_DigestVerifyInit(ctx, nullptr, nullptr, nullptr, key) == 1 &&
+              EVP_DigestVerify(ctx, sig, SIGNATURE_SIZE, msg, len) == 1;
+    EVP_MD_CTX_free(ctx);
+    EVP_PKEY_free(key);
+    return ok;
+}
+
+SigningKey::SigningKey(const std::vector<uint8_t> &seed) : seed(seed)
+{
+    if (seed.size() != IDENTITY_SEED_SIZE)
+        return;
+    auto loaded = std::make_unique<SigningState>();
+    loaded->key = EVP_PKEY_new_raw_private_key(EVP_PKEY_ED25519, nullptr, seed.data(), seed.size());
+    publicKey.resize(X25519_KEY_SIZE);
+    size_t len = publicKey.size();
+    if (!loaded->key || EVP_PKEY_get_raw_public_key(loaded->key, publicKey.data(), &len) != 1)
+    {
+        publicKey.clear();
+        return;
+    }
+    state = std::move(loaded);
+}
+
+std::vector<uint8_t> SigningKey::Sign(const uint8_t *msg, size_t len) const
+{
+    if (!state)
+        return {};
+    // 每次调用独立的摘要上下文，同一把私钥可在多个线程上并发签名
+    std::vector<uint8_t> sig(SIGNATURE_SIZE);
+    size_t sigLen = sig.size();
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    bool ok = ctx &&
+              EVP_DigestSignInit(ctx, nullptr, nullptr, nullptr, state->key) == 1 &&
+              EVP_DigestSign(ctx, sig.data(), &sigLen, msg, len) == 1 && sigLen == SIGNATURE_SIZE;
+    EVP_MD_CTX_free(ctx);
+    return ok ? sig : std::vector<uint8_t>();
+}
+#endif
+
+SigningKey::SigningKey() : SigningKey(GenerateRandomBytes(IDENTITY_SEED_SIZE)) {}
+SigningKey::~SigningKey() = default;
+
+#ifdef _WIN32
+struct CipherState
+{
+    BCRYPT_ALG_HANDLE alg = NULL;
+    BCRYPT_KEY_HANDLE key = NULL;
+
+    ~CipherState()
+    {
+        if (key)
+            BCryptDestroyKey(key);
+        if (alg)
+            BCryptCloseAlgorithmProvider(alg, 0);
+    }
+
+    bool Init(const uint8_t *keyBytes)
+    {
+        return BCryptOpenAlgorithmProvider(&alg, BCRYPT_AES_ALGORITHM, NULL, 0) == 0 &&
+               BCryptSetProperty(alg, BCRYPT_CHAINING_MODE, (PUCHAR)BCRYPT_CHAIN_MODE_GCM, sizeof(BCRYPT_CHAIN_MODE_GCM), 0) == 0 &&
+               BCryptGenerateSymmetricKey(alg, &key, NULL, 0, (PUCHAR)keyBytes, AEAD_KEY_SIZE, 0) == 0;
+    }
+};
+#else
+struct CipherState
+{
+    // 加密与解密方向各一个，均已完成密钥扩展
+    EVP_CIPHER_CTX *enc = nullptr;
+    EVP_CIPHER_CTX *dec = nullptr;
+
+    ~CipherState()
+    {
+        EVP_CIPHER_CTX_free(enc);
+        EVP_CIPHER_CTX_free(dec);
+    }
+
+    bool Init(const uint8_t *key)
+    {
+        enc = EVP_CIPHER_CTX_new();
+        dec = EVP_CIPHER_CTX_new();
+        return enc && dec &&
+               EVP_EncryptInit_ex(enc, EVP_aes_256_gcm(), nullptr, key, nullptr) == 1 &&
+               EVP_DecryptInit_ex(dec, EVP_aes_256_gcm(), nullptr, key, nullptr) == 1;
+    }
+};
+#endif
 
 DHContext::DHContext()
     : isActive(false), lastHeartbeat(GetTimeMS()), lastActiveTime(0),
-      sk(0), pk(0), pk2(0), iv(16), sharedKey(0), sig(0)
+      sk(0), pk(0), pk2(0), sharedKey(0), sig(0), iv(FRAME_IV_SIZE, 0),
+      replayTop(0), replayBitmap(0)
 {
-    KeyGen();
 }
 
-void DHContext::KeyGen()
+DHContext::~DHContext() = default;
+
+bool DHContext::KeyGen()
 {
-    // TODO: 实现 DH 密钥生成
-    sk = GenerateRandomBytes(32);  // 私钥
-    pk = GenerateRandomBytes(32);  // 公钥
-    sig = GenerateRandomBytes(32); // 签名
+    sig.clear();
+    sk.clear();
+    pk.clear();
+    agreement.reset();
+#ifdef _WIN32
+    return false;
+#else
+    // 随机私钥直接载入，比 EVP_PKEY_keygen 少一次上下文分配
+    std::vector<uint8_t> secret = GenerateRandomBytes(X25519_KEY_SIZE);
+    auto state = std::make_shared<AgreementState>();
+    state->key = EVP_PKEY_new_raw_private_key(EVP_PKEY_X25519, nullptr, secret.data(), secret.size());
+    std::vector<uint8_t> pub(X25519_KEY_SIZE);
+    size_t len = pub.size();
+    if (!state->key || EVP_PKEY_get_raw_public_key(state->key, pub.data(), &len) != 1 || len != X25519_KEY_SIZE)
+        return false;
+    sk = std::move(secret);
+    pk = std::move(pub);
+    agreement = std::move(state);
+    return true;
+#endif
 }
 
-bool DHContext::CalculateSharedKey()
+bool DHContext::DeriveKey()
 {
-    sharedKey = GenerateRandomBytes(32);
-    isActive = true;
-    // TODO: 实现 DH 共享密钥计算
+    std::vector<uint8_t> secret;
+#ifdef _WIN32
+    bool ok = X25519Agree(sk, pk2, secret);
+#else
+    // 热重启接管的会话只有 sk，按需重新载入
+    bool ok = agreement ? Agree(agreement->key, pk2, secret) : X25519Agree(sk, pk2, secret);
+#endif
+    if (!ok)
+        return false;
+    sharedKey = DeriveSessionKey(secret, pk, pk2);
+    resumeKey = DeriveResumeKey(secret, pk, pk2);
     return true;
 }
 
-bool DHContext::Encrypt(std::vector<uint8_t> &data)
+void DHContext::ShareKeys(const DHContext &from)
+{
+    sk = from.sk;
+    pk = from.pk;
+    sig = from.sig;
+    agreement = from.agreement;
+}
+
+bool DHContext::CalculateSharedKey()
 {
-    // TODO: 实现 AES-CBC 加密
+    InitNonce(true);
+    isActive = DeriveKey() && InitCipher();
+    return isActive;
+}
+
+bool DHContext::InitCipher()
+{
+    cipher.reset();
+    if (sharedKey.size() != AEAD_KEY_SIZE)
+        return false;
+    auto state = std::make_unique<CipherState>();
+    if (!state->Init(sharedKey.data()))
+        return false;
+    cipher = std::move(state);
     return true;
 }
 
-bool DHContext::Decrypt(std::vector<uint8_t> &data)
+bool DHContext::Seal(uint8_t *data, size_t len, const uint8_t *nonce, const uint8_t *aad, size_t aadLen, uint8_t *tag)
+{
+    if (!cipher)
+        return false;
+#ifdef _WIN32
+    BCRYPT_AUTHENTICATED_CIPHER_MODE_INFO info;
+    BCRYPT_INIT_AUTH_MODE_INFO(info);
+    info.pbNonce = (PUCHAR)nonce;
+    info.cbNonce = AEAD_NONCE_SIZE;
+    info.pbAuthData = (PUCHAR)aad;
+    info.cbAuthData = (ULONG)aadLen;
+    info.pbTag = tag;
+    info.cbTag = AEAD_TAG_SIZE;
+    ULONG written = 0;
+    return BCryptEncrypt(cipher->key, data, (ULONG)len, &info, NULL, 0, data, (ULONG)len, &written, 0) == 0;
+#else
+    // 只重置 nonce，沿用已扩展的密钥
+    EVP_CIPHER_CTX *ctx = cipher->enc;
+    int outLen = 0;
+    return EVP_EncryptInit_ex(ctx, nullptr, nullptr, nullptr, nonce) == 1 &&
+           (aadLen == 0 || EVP_EncryptUpdate(ctx, nullptr, &outLen, aad, (int)aadLen) == 1) &&
+           (len == 0 || EVP_EncryptUpdate(ctx, data, &outLen, data, (int)len) == 1) &&
+           EVP_EncryptFinal_ex(ctx, data + len, &outLen) == 1 &&
+           EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, AEAD_TAG_SIZE, tag) == 1;
+#endif
+}
+
+bool DHContext::Open(uint8_t *data, size_t len, const uint8_t *nonce, const uint8_t *aad, size_t aadLen, const uint8_t *tag)
+{
+    if (!cipher)
+        return false;
+#ifdef _WIN32
+    BCRYPT_AUTHENTICATED_CIPHER_MODE_INFO info;
+    BCRYPT_INIT_AUTH_MODE_INFO(info);
+    info.pbNonce = (PUCHAR)nonce;
+    info.cbNonce = AEAD_NONCE_SIZE;
+    info.pbAuthData = (PUCHAR)aad;
+    info.cbAuthData = (ULONG)aadLen;
+    info.pbTag = (PUCHAR)tag;
+    info.cbTag = AEAD_TAG_SIZE;
+    ULONG written = 0;
+    return BCryptDecrypt(cipher->key, data, (ULONG)len, &info, NULL, 0, data, (ULONG)len, &written, 0) == 0;
+#else
+    EVP_CIPHER_CTX *ctx = cipher->dec;
+    int outLen = 0;
+    return EVP_DecryptInit_ex(ctx, nullptr, nullptr, nullptr, nonce) == 1 &&
+           (aadLen == 0 || EVP_DecryptUpdate(ctx, nullptr, &outLen, aad, (int)aadLen) == 1) &&
+           (len == 0 || EVP_DecryptUpdate(ctx, data, &outLen, data, (int)len) == 1) &&
+           EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, AEAD_TAG_SIZE, const_cast<uint8_t *>(tag)) == 1 &&
+           EVP_DecryptFinal_ex(ctx, data + len, &outLen) == 1;
+#endif
+}
+
+bool DHContext::Encrypt(std::vector<uint8_t> &data, const uint8_t *nonce, const uint8_t *aad, size_t aadLen)
 {
-    // TODO: 检查 IV 防重放，实现 AES-CBC 解密
+    size_t len = data.size();
+    data.resize(len + AEAD_TAG_SIZE);
+    if (Seal(data.data(), len, nonce, aad, aadLen, data.data() + len))
+        return true;
+    data.resize(len);
+    return false;
+}
+
+bool DHContext::Decrypt(std::vector<uint8_t> &data, const uint8_t *nonce, const uint8_t *aad, size_t aadLen)
+{
+    // 序号在解密前只做检查，认证通过后才记入窗口，伪造的帧不能推进窗口
+    uint64_t seq;
+    std::memcpy(&seq, nonce + NONCE_PREFIX_SIZE, 8);
+    bool fromPeer = ((nonce[0] ^ iv[0]) & NONCE_FROM_SERVER) != 0;
+    if (!fromPeer || !ReplayCheck(seq) || data.size() < AEAD_TAG_SIZE)
+        return false;
+    size_t len = data.size() - AEAD_TAG_SIZE;
+    if (!Open(data.data(), len, nonce, aad, aadLen, data.data() + len))
+        return false;
+    ReplayUpdate(seq);
+    data.resize(len);
     return true;
 }
 
-void DHContext::nextIV()
+bool DHContext::ReplayCheck(uint64_t seq) const
+{
+    if (seq == 0) // 计数从 1 开始
+        return false;
+    if (seq > replayTop)
+        return true;
+    uint64_t offset = replayTop - seq;
+    return offset < REPLAY_WINDOW && (replayBitmap & (1ull << offset)) == 0;
+}
+
+void DHContext::ReplayUpdate(uint64_t seq)
+{
+    if (seq > replayTop)
+    {
+        uint64_t shift = seq - replayTop;
+        replayBitmap = shift < REPLAY_WINDOW ? (replayBitmap << shift) | 1 : 1;
+        replayTop = seq;
+    }
+    else
+        replayBitmap |= 1ull << (replayTop - seq);
+}
+
+void DHContext::InitNonce(bool fromServer)
 {
-    iv = GenerateRandomBytes(16);
+    iv.assign(FRAME_IV_SIZE, 0);
+    RandomFill(iv.data(), NONCE_PREFIX_SIZE);
+    if (fromServer)
+        iv[0] |= NONCE_FROM_SERVER;
+    else
+        iv[0] &= ~NONCE_FROM_SERVER;
+}
+
+void DHContext::NextNonce(uint8_t *out)
+{
+    // 同一密钥下 nonce 不重复即可，计数无需保密；2^64 帧内不会回绕
+    uint64_t counter;
+    std::memcpy(&counter, iv.data() + NONCE_PREFIX_SIZE, 8);
+    counter++;
+    std::memcpy(iv.data() + NONCE_PREFIX_SIZE, &counter, 8);
+    std::memcpy(out, iv.data(), FRAME_IV_SIZE);
 }
 
 std::vector<uint8_t> DHContext::Get_Pk_Sig()
@@ -80,8 +540,56 @@ std::vector<uint8_t> DHContext::Get_Pk_Sig()
 }
 
 SessionContext::SessionContext(int s, uint64_t id)
-    : sock(s), sessionId(id)
+    : sock(s), sessionId(id), resumeCounter(0), wireFormat(0)
 {
     isActive = false;
     lastHeartbeat = GetTimeMS();
+}
+
+std::vector<uint8_t> SessionContext::SignedMessage(uint64_t sessionId, const std::vector<uint8_t> &pk)
+{
+    static const char label[] = "gomoku-hs";
+    std::vector<uint8_t> message(label, label + sizeof(label) - 1);
+    const uint8_t *id = reinterpret_cast<const uint8_t *>(&sessionId);
+    message.insert(message.end(), id, id + 8);
+    message.insert(message.end(), pk.begin(), pk.end());
+    return message;
+}
+
+bool SessionContext::Sign(const SigningKey &identity)
+{
+    std::vector<uint8_t> message = SignedMessage(sessionId, pk);
+    sig = identity.Sign(message.data(), message.size());
+    return !sig.empty();
+}
+
+std::vector<uint8_t> SessionContext::ResumeProof(uint32_t counter) const
+{
+    // 计数与 sessionId 按小端序写入，与帧内字段一致
+    uint8_t message[6 + 8 + 4];
+    std::memcpy(message, "resume", 6);
+    std::memcpy(message + 6, &sessionId, 8);
+    std::memcpy(message + 14, &counter, 4);
+
+    std::vector<uint8_t> proof(reinterpret_cast<const uint8_t *>(&counter), reinterpret_cast<const uint8_t *>(&counter) + 4);
+    std::vector<uint8_t> mac = HmacSha256(resumeKey, message, sizeof(message));
+    proof.insert(proof.end(), mac.begin(), mac.end());
+    return proof;
+}
+
+bool SessionContext::AcceptResume(const std::vector<uint8_t> &proof)
+{
+    // 只有完成密钥协商的会话才能恢复
+    if (!isActive || proof.size() != RESUME_PROOF_SIZE)
+        return false;
+    uint32_t counter;
+    std::memcpy(&counter, proof.data(), 4);
+    if (counter <= resumeCounter)
+        return false;
+
+    std::vector<uint8_t> expected = ResumeProof(counter);
+    if (!ConstantTimeEqual(expected.data() + 4, proof.data() + 4, RESUME_MAC_SIZE))
+        return false;
+    resumeCounter = counter;
+    return true;
 }
\ No newline at end of file
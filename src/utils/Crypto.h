@@ -3,9 +3,75 @@
 
 #include <vector>
 #include <cstdint>
+#include <memory>
 #include "TimeTools.hpp"
 
+#define RESUME_MAC_SIZE 32                     // HMAC-SHA256
+#define RESUME_PROOF_SIZE (4 + RESUME_MAC_SIZE) // 恢复计数 + MAC
+
+// AES-256-GCM
+#define AEAD_KEY_SIZE 32
+#define AEAD_NONCE_SIZE 12
+#define AEAD_TAG_SIZE 16
+#define FRAME_IV_SIZE 16     // 帧头 iv 字段长度，前 AEAD_NONCE_SIZE 字节作为 nonce
+#define NONCE_PREFIX_SIZE 4  // nonce = [随机前缀 4B][递增计数 8B]
+#define NONCE_FROM_SERVER 0x80 // 前缀首字节最高位标记方向，同一会话密钥下两个方向的 nonce 互不重叠
+#define REPLAY_WINDOW 64       // 入站重放窗口（位图位数）
+
+// 握手：X25519 临时密钥协商 + Ed25519 身份签名
+#define X25519_KEY_SIZE 32
+#define SIGNATURE_SIZE 64
+#define IDENTITY_SEED_SIZE 32
+
+// 随机数池：每线程一块缓冲，耗尽时一次补满，取出的字节随即从缓冲中清除；
+// sessionId、临时私钥等小块随机数不必每次都进入系统 RNG。大块请求直接走系统 RNG
+bool RandomFill(uint8_t *out, size_t len);
+uint64_t RandomU64(); // 失败时返回 0
 std::vector<uint8_t> GenerateRandomBytes(size_t size);
+std::vector<uint8_t> HmacSha256(const std::vector<uint8_t> &key, const uint8_t *data, size_t len);
+// RFC 5869，salt 为空时按规范取全零
+std::vector<uint8_t> HkdfSha256(const std::vector<uint8_t> &salt, const std::vector<uint8_t> &ikm,
+                                const std::vector<uint8_t> &info, size_t len);
+
+// X25519 密钥协商与 Ed25519 签名是否可用；Windows CNG 不提供 Ed25519，此时返回 false，
+// 下面的协商、签名与验签函数在该平台上恒失败，调用方须先检查
+bool KeyAgreementSupported();
+// 对端公钥为低阶点（共享秘密全零）时失败
+bool X25519Agree(const std::vector<uint8_t> &sk, const std::vector<uint8_t> &peerPk, std::vector<uint8_t> &secret);
+// 由共享秘密导出会话密钥，双方临时公钥按固定顺序参与导出，绑定本次握手
+std::vector<uint8_t> DeriveSessionKey(const std::vector<uint8_t> &secret, const std::vector<uint8_t> &serverPk,
+                                      const std::vector<uint8_t> &clientPk);
+// 同一共享秘密按不同标签导出的恢复密钥，只用于断线重连证明，AEAD 密钥不做他用
+std::vector<uint8_t> DeriveResumeKey(const std::vector<uint8_t> &secret, const std::vector<uint8_t> &serverPk,
+                                     const std::vector<uint8_t> &clientPk);
+bool VerifySignature(const std::vector<uint8_t> &publicKey, const uint8_t *msg, size_t len, const uint8_t *sig);
+
+struct SigningState; // 平台相关的签名私钥句柄
+
+/**
+ * @brief 服务器长期身份（Ed25519）
+ *
+ * 每个会话的临时公钥都由它签名，客户端凭预置的身份公钥确认握手对端。
+ * 私钥只在构造时载入一次，Sign 可在多个线程上并发调用。
+ */
+class SigningKey
+{
+public:
+    SigningKey();                                       // 随机生成
+    explicit SigningKey(const std::vector<uint8_t> &seed); // IDENTITY_SEED_SIZE 字节种子
+    ~SigningKey();
+    SigningKey(const SigningKey &) = delete;
+    SigningKey &operator=(const SigningKey &) = delete;
+
+    bool Valid() const { return state != nullptr; }
+    const std::vector<uint8_t> &Seed() const { return seed; }
+    const std::vector<uint8_t> &PublicKey() const { return publicKey; }
+    std::vector<uint8_t> Sign(const uint8_t *msg, size_t len) const; // 失败时返回空
+
+private:
+    std::vector<uint8_t> seed, publicKey;
+    std::unique_ptr<SigningState> state;
+};
 
 enum class CryptoAlgorithm
 {
@@ -17,9 +83,13 @@ enum class CryptoAlgorithm
 enum class CryptoMode
 {
     ECB,
-    CBC
+    CBC,
+    GCM
 };
 
+struct CipherState;    // 平台相关的密码上下文（EVP_CIPHER_CTX / BCrypt 密钥句柄）
+struct AgreementState; // 已载入的 X25519 私钥句柄
+
 class DHContext
 {
 public:
@@ -27,15 +97,44 @@ public:
     uint64_t lastHeartbeat;
     uint64_t lastActiveTime;
 
-    std::vector<uint8_t> sk, pk, pk2, iv, sharedKey, sig;
+    std::vector<uint8_t> sk, pk, pk2, sharedKey, sig;
+    std::vector<uint8_t> resumeKey; // 与 sharedKey 同时导出，仅用于恢复证明的 HMAC
+    std::vector<uint8_t> iv; // 本端发送方向的 nonce 状态：[前缀 4B][计数 8B][保留 4B]，热重启时随会话交接
+    // 入站重放窗口：序号即对端 nonce 中的计数，replayBitmap 第 i 位表示序号 replayTop - i 已收到
+    uint64_t replayTop;
+    uint64_t replayBitmap;
 
     DHContext();
-    void KeyGen();
-    bool CalculateSharedKey();
-    bool Encrypt(std::vector<uint8_t> &data);
-    bool Decrypt(std::vector<uint8_t> &data);
-    void nextIV();
+    ~DHContext();
+    DHContext(const DHContext &) = delete;
+    DHContext &operator=(const DHContext &) = delete;
+
+    bool KeyGen();             // 生成 X25519 临时密钥对 sk / pk
+    bool DeriveKey();          // 由 sk 与对端公钥 pk2 导出 sharedKey 与 resumeKey（本端为服务端）
+    void ShareKeys(const DHContext &from); // 复制临时密钥对与签名，私钥句柄共享而不重新载入
+    bool CalculateSharedKey(); // DeriveKey 成功后随即建立密码上下文
+    bool InitCipher();         // 由 sharedKey 建立 AES-256-GCM 上下文，密钥扩展只做一次，之后每帧只换 nonce
+
+    // 原地加解密：nonce 为 AEAD_NONCE_SIZE 字节，tag 为 AEAD_TAG_SIZE 字节；Open 校验失败时返回 false
+    bool Seal(uint8_t *data, size_t len, const uint8_t *nonce, const uint8_t *aad, size_t aadLen, uint8_t *tag);
+    bool Open(uint8_t *data, size_t len, const uint8_t *nonce, const uint8_t *aad, size_t aadLen, const uint8_t *tag);
+
+    // 帧负载：加密后在末尾附加 tag / 校验并去掉末尾的 tag；
+    // Decrypt 还拒绝本端方向的 nonce（反射）与重放窗口内已收到或早于窗口的序号
+    bool Encrypt(std::vector<uint8_t> &data, const uint8_t *nonce, const uint8_t *aad, size_t aadLen);
+    bool Decrypt(std::vector<uint8_t> &data, const uint8_t *nonce, const uint8_t *aad, size_t aadLen);
+
+    bool ReplayCheck(uint64_t seq) const; // 只读检查，O(1)
+    void ReplayUpdate(uint64_t seq);      // 认证通过后记入窗口
+
+    void InitNonce(bool fromServer); // 激活时调用一次：随机前缀，计数归零
+    void NextNonce(uint8_t *out);    // 计数加一后写入 FRAME_IV_SIZE 字节的帧头 iv，不分配内存
     std::vector<uint8_t> Get_Pk_Sig();
+
+private:
+    std::unique_ptr<CipherState> cipher;
+    // KeyGen 时载入，协商时免去再次载入私钥（载入即重算一次公钥）；共享所有权，握手线程计算期间会话断开也不受影响
+    std::shared_ptr<AgreementState> agreement;
 };
 
 class SessionContext : public DHContext
@@ -43,8 +142,18 @@ class SessionContext : public DHContext
 public:
     int sock;
     uint64_t sessionId;
+    uint32_t resumeCounter; // 最近一次被接受的恢复计数，只增不减，防止重放恢复请求
+    uint8_t wireFormat;     // 负载的线路格式（WireFormat），激活时协商
 
     SessionContext(int s, uint64_t id);
+
+    // 服务端对临时公钥的签名内容："gomoku-hs" | sessionId | pk，绑定到本会话，不能挪用到其他会话
+    static std::vector<uint8_t> SignedMessage(uint64_t sessionId, const std::vector<uint8_t> &pk);
+    bool Sign(const SigningKey &identity); // 签名写入 sig
+
+    // 断线重连的简化握手：Hello 携带 [计数 4B][HMAC(resumeKey, "resume" | sessionId | 计数)]
+    std::vector<uint8_t> ResumeProof(uint32_t counter) const;
+    bool AcceptResume(const std::vector<uint8_t> &proof); // 校验通过时记录计数
 };
 
 #endif
\ No newline at end of file
@@ -163,13 +163,19 @@ public:
     static void shutdown();
 };
 
-// 为了方便使用而定义的宏
-#define LOG_TRACE(msg) Logger::trace(msg)
-#define LOG_DEBUG(msg) Logger::debug(msg)
-#define LOG_INFO(msg) Logger::info(msg)
-#define LOG_WARN(msg) Logger::warn(msg)
-#define LOG_ERROR(msg) Logger::error(msg)
-#define LOG_FATAL(msg) Logger::fatal(msg)
+// 为了方便使用而定义的宏；先检查级别再对 msg 求值，未启用的级别不拼接字符串
+#define LOG_AT(level, fn, msg)            \
+    do                                    \
+    {                                     \
+        if (Logger::isEnabled(level))     \
+            Logger::fn(msg);              \
+    } while (0)
+#define LOG_TRACE(msg) LOG_AT(LogLevel::TRACE, trace, msg)
+#define LOG_DEBUG(msg) LOG_AT(LogLevel::DEBUG, debug, msg)
+#define LOG_INFO(msg) LOG_AT(LogLevel::INFO, info, msg)
+#define LOG_WARN(msg) LOG_AT(LogLevel::WARN, warn, msg)
+#define LOG_ERROR(msg) LOG_AT(LogLevel::ERROR, error, msg)
+#define LOG_FATAL(msg) LOG_AT(LogLevel::FATAL, fatal, msg)
 
 #define LOG_TRACE_FMT(fmt, ...) Logger::log(LogLevel::TRACE, fmt, ##__VA_ARGS__)
 #define LOG_DEBUG_FMT(fmt, ...) Logger::log(LogLevel::DEBUG, fmt, ##__VA_ARGS__)
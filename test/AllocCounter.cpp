@@ -0,0 +1,29 @@
+#include "AllocCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+static thread_local size_t allocCount = 0;
+
+size_t AllocCount()
+{
+    return allocCount;
+}
+
+void *operator new(size_t size)
+{
+    allocCount++;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
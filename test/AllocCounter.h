@@ -0,0 +1,9 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstddef>
+
+// 测试可执行文件替换了全局 operator new，按线程统计堆分配次数
+size_t AllocCount();
+
+#endif // ALLOC_COUNTER_H
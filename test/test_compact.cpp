@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "CompactCodec.h"
+#include "Message.h"
+
+class CompactTest : public ::testing::Test
+{
+protected:
+    static std::vector<uint8_t> Compact(const std::vector<uint8_t> &standard)
+    {
+        std::vector<uint8_t> out;
+        EXPECT_TRUE(CompactEncode(standard.data(), standard.size(), out));
+        return out;
+    }
+
+    static std::vector<uint8_t> Standard(const std::vector<uint8_t> &compact)
+    {
+        std::vector<uint8_t> out;
+        EXPECT_TRUE(CompactDecode(compact.data(), compact.size(), out));
+        return out;
+    }
+};
+
+// 测试落子消息的紧凑编码逐字节符合预期
+TEST_F(CompactTest, MakeMoveBytes)
+{
+    MoveMsg move;
+    move.x = 7;
+    move.y = 300;
+    std::vector<uint8_t> standard = Packet::Of(1, MsgType::MakeMove, move).ToBytes();
+    std::vector<uint8_t> compact = Compact(standard);
+
+    // [msgType 402][字段数 2][x: 编号 2 | u32][7][y: 编号 3 | u32][300]
+    std::vector<uint8_t> expected = {0x92, 0x03, 2, 2 << 3 | 2, 7, 3 << 3 | 2, 0xAC, 0x02};
+    EXPECT_EQ(compact, expected);
+    EXPECT_EQ(Standard(compact), standard);
+    EXPECT_EQ(Packet::Of(1, MsgType::MakeMove, move).ToBytes(WireFormat::Compact), compact);
+}
+
+// 测试各类值与字典外的键往返后与标准格式逐字节一致
+TEST_F(CompactTest, RoundTrip)
+{
+    Packet packet(1, MsgType::SyncRoomSetting);
+    packet.SetParams({{"boardSize", uint32_t(0xFFFFFFFF)},
+                      {"delta", -5},
+                      {"min", int(0x80000000)},
+                      {"flag", uint8_t(200)},
+                      {"roomId", uint64_t(0xFFFFFFFFFFFFFFFF)},
+                      {"zero", uint64_t(0)},
+                      {"ok", false},
+                      {"blob", std::vector<uint8_t>(200, 9)},
+                      {"message", std::string("")},
+                      {"A", std::string("before msgType")}});
+    std::vector<uint8_t> standard = packet.ToBytes();
+    std::vector<uint8_t> compact = Compact(standard);
+    EXPECT_LT(compact.size(), standard.size());
+    EXPECT_EQ(Standard(compact), standard);
+
+    Packet decoded;
+    ASSERT_TRUE(decoded.FromData(1, compact, WireFormat::Compact));
+    EXPECT_EQ(decoded.msgType, MsgType::SyncRoomSetting);
+    EXPECT_EQ(decoded.GetParam<uint32_t>("delta"), uint32_t(-5));
+    EXPECT_EQ(decoded.GetParam<uint64_t>("roomId"), 0xFFFFFFFFFFFFFFFFull);
+    EXPECT_EQ(decoded.GetParam<std::vector<uint8_t>>("blob").size(), 200u);
+    EXPECT_EQ(decoded.GetParam<std::string>("A"), "before msgType");
+
+    // 空消息只剩 msgType 与字段数
+    EXPECT_EQ(Packet(1, MsgType::None).ToBytes(WireFormat::Compact), (std::vector<uint8_t>{0, 0}));
+}
+
+// 测试字段数超过 127 时字段数占多个字节，两遍编码的长度仍然准确
+TEST_F(CompactTest, ManyFields)
+{
+    Packet packet(1, MsgType::SyncRoomSetting);
+    for (int i = 0; i < 300; i++)
+        packet.AddParam("k" + std::to_string(i), uint32_t(i));
+    std::vector<uint8_t> standard = packet.ToBytes();
+    std::vector<uint8_t> compact = Compact(standard);
+    ASSERT_EQ(packet.EncodedSize(WireFormat::Compact), compact.size());
+    EXPECT_EQ(compact[2], 0x80 | (300 & 0x7F)); // [msgType 301 = 0xAD 0x02][字段数 300 = 0xAC 0x02]
+    EXPECT_EQ(compact[3], 300 >> 7);
+    EXPECT_EQ(Standard(compact), standard);
+}
+
+// 测试截断、未知编号与类型、冗余的 msgType 字段、varint 溢出与多余字节都被拒绝
+TEST_F(CompactTest, RejectMalformed)
+{
+    ChatPushMsg chat;
+    chat.roomId = 1;
+    chat.userId = 2;
+    chat.message = "hello";
+    std::vector<uint8_t> compact = Packet::Of(1, MsgType::ChatMessage, chat).ToBytes(WireFormat::Compact);
+
+    std::vector<uint8_t> out;
+    for (size_t len = 0; len < compact.size(); len++)
+        EXPECT_FALSE(CompactDecode(compact.data(), len, out)) << len;
+
+    Packet packet;
+    std::vector<std::vector<uint8_t>> bad = {
+        {0, 1, 31 << 3 | 2, 1},                                                // 字典外的编号
+        {0, 1, 2 << 3 | 7, 1},                                                 // 未知类型索引
+        {0, 1, 1 << 3 | 2, 1},                                                 // msgType 字段
+        {0, 1, 0, 7, 'm', 's', 'g', 'T', 'y', 'p', 'e', 2, 1},                 // 原样携带的 msgType 字段
+        {0, 1, 2 << 3 | 2, 0x80, 0x80, 0x80, 0x80, 0x10},                      // 超出 uint32_t
+        {0, 1, 4 << 3 | 3, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02}, // 超出 uint64_t
+        {0, 0, 0},                                                             // 多余字节
+        {0, 2, 0 << 3 | 1, 1, 'b', 5, 0 << 3 | 1, 1, 'a', 6},                  // 键未按序排列
+        {0, 2, 0 << 3 | 1, 1, 'a', 5, 0 << 3 | 1, 1, 'a', 6},                  // 重复的键
+    };
+    for (const std::vector<uint8_t> &bytes : bad)
+    {
+        out.clear();
+        EXPECT_FALSE(CompactDecode(bytes.data(), bytes.size(), out));
+        EXPECT_FALSE(packet.FromData(1, bytes, WireFormat::Compact));
+    }
+}
@@ -0,0 +1,386 @@
+#include <gtest/gtest.h>
+#include "Crypto.h"
+
+#include <string>
+#include <set>
+#include <cstring>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+class ResumeProofTest : public ::testing::Test
+{
+protected:
+    SessionContext server{5, 0x1234500};
+    SessionContext client{-1, 0x1234500};
+
+    void SetUp() override
+    {
+        // 双方持有同一恢复密钥
+        server.resumeKey = GenerateRandomBytes(32);
+        server.isActive = true;
+        client.resumeKey = server.resumeKey;
+    }
+};
+
+// 测试有效证明被接受，计数随之前移
+TEST_F(ResumeProofTest, AcceptValidProof)
+{
+    std::vector<uint8_t> proof = client.ResumeProof(1);
+    ASSERT_EQ(proof.size(), (size_t)RESUME_PROOF_SIZE);
+    EXPECT_TRUE(server.AcceptResume(proof));
+    EXPECT_EQ(server.resumeCounter, 1u);
+    EXPECT_TRUE(server.AcceptResume(client.ResumeProof(5)));
+    EXPECT_EQ(server.resumeCounter, 5u);
+}
+
+// 测试重放与回退的计数被拒绝
+TEST_F(ResumeProofTest, RejectReplay)
+{
+    std::vector<uint8_t> proof = client.ResumeProof(3);
+    EXPECT_TRUE(server.AcceptResume(proof));
+    EXPECT_FALSE(server.AcceptResume(proof));
+    EXPECT_FALSE(server.AcceptResume(client.ResumeProof(2)));
+    EXPECT_EQ(server.resumeCounter, 3u);
+}
+
+// 测试密钥、sessionId 不符或会话未激活时拒绝
+TEST_F(ResumeProofTest, RejectForgedProof)
+{
+    SessionContext other{-1, 0x1234500};
+    other.resumeKey = GenerateRandomBytes(32);
+    EXPECT_FALSE(server.AcceptResume(other.ResumeProof(1)));
+
+    SessionContext wrongId{-1, 0x6789A00};
+    wrongId.resumeKey = server.resumeKey;
+    EXPECT_FALSE(server.AcceptResume(wrongId.ResumeProof(1)));
+
+    std::vector<uint8_t> truncated = client.ResumeProof(1);
+    truncated.pop_back();
+    EXPECT_FALSE(server.AcceptResume(truncated));
+
+    server.isActive = false;
+    EXPECT_FALSE(server.AcceptResume(client.ResumeProof(1)));
+    EXPECT_EQ(server.resumeCounter, 0u);
+}
+
+class AeadTest : public ::testing::Test
+{
+protected:
+    DHContext sender;   // 客户端方向
+    DHContext receiver; // 服务端方向
+    std::vector<uint8_t> nonce;
+    std::vector<uint8_t> aad = {1, 2, 3, 4};
+
+    void SetUp() override
+    {
+        sender.sharedKey = GenerateRandomBytes(AEAD_KEY_SIZE);
+        receiver.sharedKey = sender.sharedKey;
+        ASSERT_TRUE(sender.InitCipher());
+        ASSERT_TRUE(receiver.InitCipher());
+        sender.InitNonce(false);
+        receiver.InitNonce(true);
+        nonce = NextNonce();
+    }
+
+    std::vector<uint8_t> NextNonce()
+    {
+        uint8_t iv[FRAME_IV_SIZE];
+        sender.NextNonce(iv);
+        return std::vector<uint8_t>(iv, iv + AEAD_NONCE_SIZE);
+    }
+
+    // 由 sender 以指定序号加密一帧
+    std::vector<uint8_t> SealAt(uint64_t seq, std::vector<uint8_t> &seqNonce)
+    {
+        seqNonce = nonce;
+        std::memcpy(seqNonce.data() + NONCE_PREFIX_SIZE, &seq, 8);
+        std::vector<uint8_t> data = {(uint8_t)seq};
+        sender.Encrypt(data, seqNonce.data(), aad.data(), aad.size());
+        return data;
+    }
+
+    bool OpenAt(uint64_t seq)
+    {
+        std::vector<uint8_t> seqNonce;
+        std::vector<uint8_t> data = SealAt(seq, seqNonce);
+        return receiver.Decrypt(data, seqNonce.data(), aad.data(), aad.size());
+    }
+};
+
+// 测试加密后附加 tag，解密还原并去掉 tag；同一上下文连续处理多帧
+TEST_F(AeadTest, RoundTrip)
+{
+    for (size_t len : {0, 1, 15, 16, 17, 500, 1000})
+    {
+        std::vector<uint8_t> plain = GenerateRandomBytes(len);
+        std::vector<uint8_t> data = plain;
+        nonce = NextNonce();
+        ASSERT_TRUE(sender.Encrypt(data, nonce.data(), aad.data(), aad.size()));
+        ASSERT_EQ(data.size(), len + AEAD_TAG_SIZE);
+        if (len >= 16)
+        {
+            EXPECT_NE(std::vector<uint8_t>(data.begin(), data.begin() + len), plain);
+        }
+        ASSERT_TRUE(receiver.Decrypt(data, nonce.data(), aad.data(), aad.size()));
+        EXPECT_EQ(data, plain);
+    }
+}
+
+// 测试密文、tag、附加数据或 nonce 被改动时解密失败
+TEST_F(AeadTest, RejectTampering)
+{
+    std::vector<uint8_t> sealed = GenerateRandomBytes(64);
+    ASSERT_TRUE(sender.Encrypt(sealed, nonce.data(), aad.data(), aad.size()));
+
+    std::vector<uint8_t> data = sealed;
+    data[10] ^= 1;
+    EXPECT_FALSE(receiver.Decrypt(data, nonce.data(), aad.data(), aad.size()));
+
+    data = sealed;
+    data.back() ^= 1;
+    EXPECT_FALSE(receiver.Decrypt(data, nonce.data(), aad.data(), aad.size()));
+
+    data = sealed;
+    std::vector<uint8_t> otherAad = {1, 2, 3, 5};
+    EXPECT_FALSE(receiver.Decrypt(data, nonce.data(), otherAad.data(), otherAad.size()));
+
+    data = sealed;
+    std::vector<uint8_t> otherNonce = nonce;
+    otherNonce[NONCE_PREFIX_SIZE]++;
+    EXPECT_FALSE(receiver.Decrypt(data, otherNonce.data(), aad.data(), aad.size()));
+
+    data = sealed;
+    data.resize(AEAD_TAG_SIZE - 1);
+    EXPECT_FALSE(receiver.Decrypt(data, nonce.data(), aad.data(), aad.size()));
+
+    // 以上失败都不推进重放窗口，原帧仍可解密
+    data = sealed;
+    EXPECT_TRUE(receiver.Decrypt(data, nonce.data(), aad.data(), aad.size()));
+}
+
+// 测试重放窗口：重复序号被拒绝，窗口内乱序到达的序号各接受一次，早于窗口的序号被拒绝
+TEST_F(AeadTest, RejectReplay)
+{
+    std::vector<uint8_t> sealed = GenerateRandomBytes(64);
+    ASSERT_TRUE(sender.Encrypt(sealed, nonce.data(), aad.data(), aad.size()));
+    std::vector<uint8_t> data = sealed;
+    ASSERT_TRUE(receiver.Decrypt(data, nonce.data(), aad.data(), aad.size()));
+    data = sealed;
+    EXPECT_FALSE(receiver.Decrypt(data, nonce.data(), aad.data(), aad.size()));
+
+    EXPECT_TRUE(OpenAt(10));
+    EXPECT_TRUE(OpenAt(5));
+    EXPECT_FALSE(OpenAt(5));
+    EXPECT_TRUE(OpenAt(9));
+    EXPECT_FALSE(OpenAt(10));
+    EXPECT_EQ(receiver.replayTop, 10u);
+
+    EXPECT_TRUE(OpenAt(10 + REPLAY_WINDOW - 1));
+    EXPECT_TRUE(OpenAt(11));      // 仍在窗口内
+    EXPECT_FALSE(OpenAt(9));      // 已收到
+    EXPECT_FALSE(OpenAt(8));      // 未收到，但已滑出窗口
+    EXPECT_TRUE(OpenAt(1000));    // 大幅跳跃，窗口整体重置
+    EXPECT_FALSE(OpenAt(1000 - REPLAY_WINDOW));
+    EXPECT_TRUE(OpenAt(1000 - REPLAY_WINDOW + 1));
+    EXPECT_FALSE(OpenAt(0));      // 计数从 1 开始
+}
+
+// 测试本端方向的 nonce（反射回来的帧）被拒绝
+TEST_F(AeadTest, RejectReflection)
+{
+    uint8_t iv[FRAME_IV_SIZE];
+    receiver.NextNonce(iv);
+    std::vector<uint8_t> data = GenerateRandomBytes(32);
+    ASSERT_TRUE(receiver.Encrypt(data, iv, aad.data(), aad.size()));
+    EXPECT_FALSE(receiver.Decrypt(data, iv, aad.data(), aad.size()));
+    EXPECT_EQ(receiver.replayTop, 0u);
+}
+
+// 测试密钥不同或未建立上下文时失败
+TEST_F(AeadTest, RejectWrongKey)
+{
+    DHContext other;
+    other.sharedKey = GenerateRandomBytes(AEAD_KEY_SIZE);
+    ASSERT_TRUE(other.InitCipher());
+    other.InitNonce(true);
+    std::vector<uint8_t> data = GenerateRandomBytes(32);
+    ASSERT_TRUE(sender.Encrypt(data, nonce.data(), aad.data(), aad.size()));
+    EXPECT_FALSE(other.Decrypt(data, nonce.data(), aad.data(), aad.size()));
+
+    DHContext empty;
+    std::vector<uint8_t> plain(8, 0);
+    EXPECT_FALSE(empty.Encrypt(plain, nonce.data(), aad.data(), aad.size()));
+    EXPECT_EQ(plain.size(), 8u);
+}
+
+class KeyAgreementTest : public ::testing::Test
+{
+protected:
+    SigningKey identity;
+    SessionContext server{5, 0x2345600};
+    SessionContext client{-1, 0x2345600};
+
+    static std::vector<uint8_t> Hex(const char *hex)
+    {
+        std::vector<uint8_t> bytes;
+        for (size_t i = 0; hex[i] && hex[i + 1]; i += 2)
+            bytes.push_back((uint8_t)std::stoi(std::string(hex + i, 2), nullptr, 16));
+        return bytes;
+    }
+};
+
+// 测试双方由各自的临时私钥与对端公钥导出相同的会话密钥
+TEST_F(KeyAgreementTest, BothSidesDeriveSameKey)
+{
+    if (!KeyAgreementSupported())
+        GTEST_SKIP() << "X25519 / Ed25519 not available on this platform";
+    ASSERT_TRUE(server.KeyGen());
+    ASSERT_TRUE(client.KeyGen());
+    EXPECT_EQ(server.pk.size(), (size_t)X25519_KEY_SIZE);
+    EXPECT_NE(server.pk, client.pk);
+
+    server.pk2 = client.pk;
+    ASSERT_TRUE(server.CalculateSharedKey());
+    EXPECT_TRUE(server.isActive);
+
+    std::vector<uint8_t> secret;
+    ASSERT_TRUE(X25519Agree(client.sk, server.pk, secret));
+    client.sharedKey = DeriveSessionKey(secret, server.pk, client.pk);
+    EXPECT_EQ(client.sharedKey, server.sharedKey);
+    EXPECT_EQ(server.sharedKey.size(), (size_t)AEAD_KEY_SIZE);
+
+    // 公钥顺序参与导出，交换顺序得到不同密钥
+    EXPECT_NE(DeriveSessionKey(secret, client.pk, server.pk), server.sharedKey);
+
+    // 恢复密钥与 AEAD 密钥按不同标签导出，互不相同
+    EXPECT_EQ(DeriveResumeKey(secret, server.pk, client.pk), server.resumeKey);
+    EXPECT_EQ(server.resumeKey.size(), (size_t)AEAD_KEY_SIZE);
+    EXPECT_NE(server.resumeKey, server.sharedKey);
+}
+
+// 测试低阶点与长度不符的公钥被拒绝
+TEST_F(KeyAgreementTest, RejectBadPeerKey)
+{
+    if (!KeyAgreementSupported())
+        GTEST_SKIP() << "X25519 / Ed25519 not available on this platform";
+    ASSERT_TRUE(server.KeyGen());
+    server.pk2.assign(X25519_KEY_SIZE, 0);
+    EXPECT_FALSE(server.CalculateSharedKey());
+    EXPECT_FALSE(server.isActive);
+
+    server.pk2.assign(16, 9);
+    EXPECT_FALSE(server.CalculateSharedKey());
+}
+
+// 测试签名绑定 sessionId 与临时公钥
+TEST_F(KeyAgreementTest, SignatureBindsSession)
+{
+    if (!KeyAgreementSupported())
+        GTEST_SKIP() << "X25519 / Ed25519 not available on this platform";
+    ASSERT_TRUE(identity.Valid());
+    ASSERT_TRUE(server.KeyGen());
+    ASSERT_TRUE(server.Sign(identity));
+    ASSERT_EQ(server.sig.size(), (size_t)SIGNATURE_SIZE);
+    EXPECT_EQ(server.Get_Pk_Sig().size(), (size_t)(X25519_KEY_SIZE + SIGNATURE_SIZE));
+
+    std::vector<uint8_t> message = SessionContext::SignedMessage(server.sessionId, server.pk);
+    EXPECT_TRUE(VerifySignature(identity.PublicKey(), message.data(), message.size(), server.sig.data()));
+
+    std::vector<uint8_t> otherSession = SessionContext::SignedMessage(server.sessionId + 1, server.pk);
+    EXPECT_FALSE(VerifySignature(identity.PublicKey(), otherSession.data(), otherSession.size(), server.sig.data()));
+
+    SigningKey other;
+    EXPECT_FALSE(VerifySignature(other.PublicKey(), message.data(), message.size(), server.sig.data()));
+
+    // 同一种子得到同一身份
+    SigningKey reloaded(identity.Seed());
+    EXPECT_EQ(reloaded.PublicKey(), identity.PublicKey());
+    EXPECT_FALSE(SigningKey(std::vector<uint8_t>(3, 0)).Valid());
+}
+
+// 测试 HKDF 与 RFC 5869 测试向量一致
+TEST_F(KeyAgreementTest, HkdfMatchesRfc5869)
+{
+    std::vector<uint8_t> okm = HkdfSha256(Hex("000102030405060708090a0b0c"),
+                                          std::vector<uint8_t>(22, 0x0b),
+                                          Hex("f0f1f2f3f4f5f6f7f8f9"), 42);
+    EXPECT_EQ(okm, Hex("3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf"
+                       "34007208d5b887185865"));
+
+    // 测试用例 3：salt 为空
+    okm = HkdfSha256({}, std::vector<uint8_t>(22, 0x0b), {}, 42);
+    EXPECT_EQ(okm, Hex("8da4e775a563c18f715f802a063c5a31b8a11f5c5ee1879ec3454e5f3c738d2d"
+                       "9d201395faa4b61a96c8"));
+}
+
+// 测试同一会话的 nonce 前缀不变、计数递增，两个方向的前缀以最高位区分
+TEST(NonceTest, CounterAndDirection)
+{
+    DHContext server;
+    DHContext client;
+    server.InitNonce(true);
+    client.InitNonce(false);
+
+    uint8_t first[FRAME_IV_SIZE];
+    server.NextNonce(first);
+    EXPECT_TRUE(first[0] & NONCE_FROM_SERVER);
+    for (uint64_t i = 2; i <= 1000; i++)
+    {
+        uint8_t iv[FRAME_IV_SIZE];
+        server.NextNonce(iv);
+        uint64_t counter;
+        std::memcpy(&counter, iv + NONCE_PREFIX_SIZE, 8);
+        ASSERT_EQ(counter, i);
+        ASSERT_EQ(std::memcmp(iv, first, NONCE_PREFIX_SIZE), 0);
+    }
+
+    uint8_t iv[FRAME_IV_SIZE];
+    client.NextNonce(iv);
+    EXPECT_FALSE(iv[0] & NONCE_FROM_SERVER);
+    EXPECT_NE(std::memcmp(iv, first, AEAD_NONCE_SIZE), 0);
+}
+
+// 测试随机数池跨越补满边界后仍不重复，大块请求直接走系统 RNG
+TEST(RandomPoolTest, NoRepeatsAcrossRefills)
+{
+    std::set<std::vector<uint8_t>> seen;
+    for (int i = 0; i < 500; i++)
+    {
+        std::vector<uint8_t> chunk(32);
+        ASSERT_TRUE(RandomFill(chunk.data(), chunk.size()));
+        EXPECT_TRUE(seen.insert(chunk).second);
+    }
+
+    std::vector<uint8_t> large(64 * 1024, 0);
+    ASSERT_TRUE(RandomFill(large.data(), large.size()));
+    EXPECT_NE(large, std::vector<uint8_t>(large.size(), 0));
+    EXPECT_NE(RandomU64(), RandomU64());
+}
+
+#ifndef _WIN32
+// 测试 fork 后父子进程不会从池中取出相同的字节
+TEST(RandomPoolTest, ForkDoesNotShareBuffer)
+{
+    RandomU64(); // 确保池已补满
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0)
+    {
+        uint64_t value = RandomU64();
+        ssize_t n = write(fds[1], &value, sizeof(value));
+        _exit(n == sizeof(value) ? 0 : 1);
+    }
+    uint64_t mine = RandomU64();
+    uint64_t theirs = 0;
+    ASSERT_EQ(read(fds[0], &theirs, sizeof(theirs)), (ssize_t)sizeof(theirs));
+    waitpid(child, nullptr, 0);
+    close(fds[0]);
+    close(fds[1]);
+    EXPECT_NE(mine, theirs);
+}
+#endif
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include "Database.h"
+#include "ObjectManager.h"
 #include <filesystem>
+#include <thread>
+#include <set>
 
 class DatabaseTest : public ::testing::Test
 {
@@ -86,3 +89,33 @@ TEST_F(DatabaseTest, QueryValue)
     std::string username = db.QueryValue("SELECT username FROM users LIMIT 1;");
     EXPECT_EQ(username, "testUser");
 }
+
+// 测试多个线程同时写库（注册请求在工作线程上执行）：每个用户都落库且 ID 互不相同
+TEST_F(DatabaseTest, ConcurrentInsertUser)
+{
+    Database &db = Database::GetInstance();
+    ASSERT_TRUE(db.Initialize(TEST_DB));
+
+    const int threads = 4, perThread = 50;
+    std::vector<std::vector<uint64_t>> ids(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back([t, &ids]()
+                             {
+            for (int i = 0; i < perThread; i++)
+                ids[t].push_back(ObjectManager::InsertUser("user" + std::to_string(t) + "_" + std::to_string(i), "pwd")); });
+    for (std::thread &worker : workers)
+        worker.join();
+
+    std::set<uint64_t> unique;
+    for (const auto &list : ids)
+    {
+        for (uint64_t id : list)
+        {
+            EXPECT_NE(id, 0u);
+            unique.insert(id);
+        }
+    }
+    EXPECT_EQ(unique.size(), (size_t)(threads * perThread));
+    EXPECT_EQ(db.QueryValue("SELECT COUNT(*) FROM users;"), std::to_string(threads * perThread));
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "ExpiryWheel.h"
+
+#include <vector>
+
+class ExpiryWheelTest : public ::testing::Test
+{
+protected:
+    ExpiryWheel wheel;
+    std::vector<int> expired;
+
+    void SetUp() override
+    {
+        wheel.Init(10, 8); // 10ms 精度，一圈 80ms
+    }
+
+    void Advance(uint64_t now)
+    {
+        wheel.Advance(now, [this](int fd) -> uint64_t
+                      {
+            expired.push_back(fd);
+            return 0; });
+    }
+};
+
+// 测试到期顺序与精度
+TEST_F(ExpiryWheelTest, ExpireInOrder)
+{
+    wheel.Schedule(1, 1030);
+    wheel.Schedule(2, 1010);
+    wheel.Schedule(3, 1050);
+    EXPECT_EQ(wheel.Size(), 3u);
+
+    Advance(1005);
+    EXPECT_TRUE(expired.empty());
+    Advance(1035);
+    EXPECT_EQ(expired, (std::vector<int>{2, 1}));
+    Advance(1060);
+    EXPECT_EQ(expired, (std::vector<int>{2, 1, 3}));
+    EXPECT_TRUE(wheel.Empty());
+}
+
+// 测试取消与重新调度
+TEST_F(ExpiryWheelTest, CancelAndReschedule)
+{
+    wheel.Schedule(1, 1020);
+    wheel.Schedule(2, 1020);
+    wheel.Cancel(1);
+    wheel.Schedule(2, 1070);
+
+    Advance(1030);
+    EXPECT_TRUE(expired.empty());
+    Advance(1075);
+    EXPECT_EQ(expired, std::vector<int>{2});
+}
+
+// 测试超出一圈的截止时间不会提前到期
+TEST_F(ExpiryWheelTest, DeadlineBeyondOneLap)
+{
+    wheel.Schedule(7, 1500);
+    for (uint64_t now = 1000; now < 1500; now += 10)
+        Advance(now);
+    EXPECT_TRUE(expired.empty());
+    Advance(1510);
+    EXPECT_EQ(expired, std::vector<int>{7});
+}
+
+// 测试回调返回新的截止时间实现惰性续期
+TEST_F(ExpiryWheelTest, LazyRenewal)
+{
+    uint64_t lastActive = 1000;
+    wheel.Schedule(5, lastActive + 50);
+    lastActive = 1040; // 期间有过活动，但不触碰时间轮
+
+    uint64_t now = 0;
+    int calls = 0;
+    auto onDue = [&](int fd) -> uint64_t
+    {
+        calls++;
+        uint64_t deadline = lastActive + 50;
+        if (deadline > now)
+            return deadline;
+        expired.push_back(fd);
+        return 0;
+    };
+
+    now = 1060;
+    wheel.Advance(now, onDue);
+    EXPECT_EQ(calls, 1);
+    EXPECT_TRUE(expired.empty());
+    EXPECT_EQ(wheel.Size(), 1u);
+
+    // 长时间未推进也能补上
+    now = 5000;
+    wheel.Advance(now, onDue);
+    EXPECT_EQ(calls, 2);
+    EXPECT_EQ(expired, std::vector<int>{5});
+    EXPECT_TRUE(wheel.Empty());
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include "FrameDecoder.h"
+
+#include <cstring>
+
+class FrameDecoderTest : public ::testing::Test
+{
+protected:
+    FrameDecoder decoder;
+
+    static std::vector<uint8_t> MakeFrame(uint64_t sessionId, size_t payloadLen)
+    {
+        std::vector<uint8_t> payload(payloadLen);
+        for (size_t i = 0; i < payloadLen; i++)
+            payload[i] = (uint8_t)(sessionId + i);
+        return Frame(Frame::Status::Active, sessionId, {}, payload).ToBytes();
+    }
+
+    void Feed(const std::vector<uint8_t> &bytes)
+    {
+        decoder.Feed(bytes.data(), bytes.size());
+    }
+
+    // 解出当前缓冲区中的全部帧，返回各帧的 sessionId
+    std::vector<uint64_t> Drain()
+    {
+        std::vector<uint64_t> ids;
+        Frame frame;
+        while (decoder.Next(frame))
+        {
+            EXPECT_EQ(frame.data.size() + sizeof(Frame::Header), frame.head.length);
+            ids.push_back(frame.head.sessionId);
+        }
+        return ids;
+    }
+};
+
+// 测试连续多帧在任意位置被切分时都能完整解出
+TEST_F(FrameDecoderTest, SplitStream)
+{
+    std::vector<uint8_t> stream;
+    for (uint64_t id = 1; id <= 5; id++)
+    {
+        auto bytes = MakeFrame(id, id * 37);
+        stream.insert(stream.end(), bytes.begin(), bytes.end());
+    }
+
+    for (size_t step : {1, 3, 7, 36, 100, 4096})
+    {
+        FrameDecoder fresh;
+        std::swap(decoder, fresh);
+        std::vector<uint64_t> ids;
+        for (size_t offset = 0; offset < stream.size(); offset += step)
+        {
+            decoder.Feed(stream.data() + offset, std::min(step, stream.size() - offset));
+            auto got = Drain();
+            ids.insert(ids.end(), got.begin(), got.end());
+        }
+        EXPECT_EQ(ids, (std::vector<uint64_t>{1, 2, 3, 4, 5})) << "step " << step;
+        EXPECT_EQ(decoder.SkippedBytes(), 0u);
+        EXPECT_EQ(decoder.Buffer().Readable(), 0u);
+    }
+}
+
+// 测试帧前的垃圾数据被整段跳过
+TEST_F(FrameDecoderTest, ResyncAfterGarbage)
+{
+    std::vector<uint8_t> garbage(500, 0xAB);
+    Feed(garbage);
+    Feed(MakeFrame(42, 10));
+
+    EXPECT_EQ(Drain(), std::vector<uint64_t>{42});
+    EXPECT_EQ(decoder.SkippedBytes(), garbage.size());
+}
+
+// 测试非法长度的帧头被立即丢弃，不等待负载
+TEST_F(FrameDecoderTest, RejectBadLength)
+{
+    auto bad = MakeFrame(1, 0);
+    uint32_t length = MAX_FRAME_SIZE + 1;
+    std::memcpy(bad.data() + offsetof(Frame::Header, length), &length, sizeof(length));
+    Feed(bad);
+
+    Frame frame;
+    EXPECT_FALSE(decoder.Next(frame));
+    EXPECT_EQ(decoder.GetState(), FrameDecoder::State::SeekMagic);
+    EXPECT_EQ(decoder.Buffer().Readable(), 0u);
+    EXPECT_EQ(decoder.SkippedBytes(), bad.size());
+
+    Feed(MakeFrame(7, 3));
+    EXPECT_EQ(Drain(), std::vector<uint64_t>{7});
+}
+
+// 测试魔数跨越两次输入边界
+TEST_F(FrameDecoderTest, MagicAcrossFeeds)
+{
+    auto bytes = MakeFrame(9, 20);
+    std::vector<uint8_t> head = {0x00, 0x11};
+    head.insert(head.end(), bytes.begin(), bytes.begin() + 2);
+    Feed(head);
+
+    Frame frame;
+    EXPECT_FALSE(decoder.Next(frame));
+    EXPECT_EQ(decoder.Buffer().Readable(), 2u); // 魔数前缀被保留
+    EXPECT_EQ(decoder.SkippedBytes(), 2u);
+
+    decoder.Feed(bytes.data() + 2, bytes.size() - 2);
+    EXPECT_EQ(Drain(), std::vector<uint64_t>{9});
+}
+
+// 测试断开后复位
+TEST_F(FrameDecoderTest, Reset)
+{
+    auto bytes = MakeFrame(3, 50);
+    decoder.Feed(bytes.data(), sizeof(Frame::Header) + 5);
+    Frame frame;
+    EXPECT_FALSE(decoder.Next(frame));
+    EXPECT_EQ(decoder.GetState(), FrameDecoder::State::Payload);
+
+    decoder.Reset();
+    EXPECT_EQ(decoder.GetState(), FrameDecoder::State::SeekMagic);
+    EXPECT_EQ(decoder.Buffer().Readable(), 0u);
+
+    Feed(bytes);
+    EXPECT_EQ(Drain(), std::vector<uint64_t>{3});
+}
+
+// 测试负载超过 MAX_FRAME_SIZE 的帧按实际长度编码（发送端不受接收上限约束，不越界写）
+TEST(FrameTest, ToBytesLargePayload)
+{
+    std::vector<uint8_t> payload(3000);
+    for (size_t i = 0; i < payload.size(); i++)
+        payload[i] = (uint8_t)i;
+    Frame frame(Frame::Status::Active, 5, {}, payload);
+    std::vector<uint8_t> bytes = frame.ToBytes();
+    ASSERT_EQ(bytes.size(), sizeof(Frame::Header) + payload.size());
+    EXPECT_EQ(frame.Size(), bytes.size());
+
+    Frame::Header head;
+    std::memcpy(&head, bytes.data(), sizeof(head));
+    EXPECT_EQ(head.length, bytes.size());
+    EXPECT_EQ(head.sessionId, 5u);
+    EXPECT_TRUE(std::equal(payload.begin(), payload.end(), bytes.begin() + sizeof(Frame::Header)));
+}
@@ -119,6 +119,7 @@ TEST_F(GameTest, UndoMove)
     // 再悔棋一步
     EXPECT_TRUE(game.undoMove());
     EXPECT_EQ(game.getMoveCount(), 0);
+    board = game.getBoard();
     EXPECT_EQ(board[7][7], Piece::EMPTY);
 
     // 没有棋可悔
@@ -0,0 +1,143 @@
+#ifndef _WIN32
+
+#include <gtest/gtest.h>
+#include "Handoff.h"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <thread>
+
+class HandoffTest : public ::testing::Test
+{
+protected:
+    int pair[2] = {-1, -1};
+    int pipeFds[2] = {-1, -1};
+
+    void SetUp() override
+    {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+        ASSERT_EQ(pipe(pipeFds), 0);
+    }
+
+    void TearDown() override
+    {
+        for (int fd : {pair[0], pair[1], pipeFds[0], pipeFds[1]})
+        {
+            if (fd >= 0)
+                close(fd);
+        }
+    }
+};
+
+// 测试状态块与 fd 完整往返；会话数超过单条消息的 fd 上限，需分批发送
+TEST_F(HandoffTest, RoundTrip)
+{
+    HandoffState sent;
+    sent.reactorCount = 2;
+    sent.listenFds = {dup(pipeFds[1]), dup(pipeFds[1])};
+    for (uint32_t i = 0; i < 300; i++)
+    {
+        HandoffSession session;
+        session.fd = dup(pipeFds[1]);
+        session.reactor = i % 2;
+        session.peerAddr = 0x0100007F;
+        session.sessionId = i == 0 ? 0 : (uint64_t(i) << 8) | session.reactor;
+        session.idleMs = i * 10;
+        session.replayTop = i * 1000;
+        session.replayBitmap = ~uint64_t(i);
+        session.wireFormat = i % 2;
+        session.active = i % 3 == 0;
+        session.sharedKey.assign(32, (uint8_t)i);
+        session.resumeKey.assign(32, (uint8_t)~i);
+        session.inbound.assign(i % 7, 0xAB);
+        session.outbound.assign(i * 3, 0xCD);
+        session.appState = {(uint8_t)i};
+        sent.sessions.push_back(session);
+    }
+
+    // 发送方等待确认，必须与接收方并行
+    bool sendOk = false;
+    std::thread sender([&]()
+                       { sendOk = SendHandoff(pair[0], sent); });
+    HandoffState received;
+    bool recvOk = RecvHandoff(pair[1], received);
+    sender.join();
+    ASSERT_TRUE(sendOk);
+    ASSERT_TRUE(recvOk);
+
+    EXPECT_EQ(received.reactorCount, 2u);
+    ASSERT_EQ(received.listenFds.size(), 2u);
+    ASSERT_EQ(received.sessions.size(), sent.sessions.size());
+    for (size_t i = 0; i < sent.sessions.size(); i++)
+    {
+        const HandoffSession &a = sent.sessions[i];
+        const HandoffSession &b = received.sessions[i];
+        EXPECT_GE(b.fd, 0);
+        EXPECT_EQ(b.reactor, a.reactor);
+        EXPECT_EQ(b.peerAddr, a.peerAddr);
+        EXPECT_EQ(b.sessionId, a.sessionId);
+        EXPECT_EQ(b.idleMs, a.idleMs);
+        EXPECT_EQ(b.active, a.active);
+        EXPECT_EQ(b.replayTop, a.replayTop);
+        EXPECT_EQ(b.replayBitmap, a.replayBitmap);
+        EXPECT_EQ(b.wireFormat, a.wireFormat);
+        EXPECT_EQ(b.sharedKey, a.sharedKey);
+        EXPECT_EQ(b.resumeKey, a.resumeKey);
+        EXPECT_EQ(b.inbound, a.inbound);
+        EXPECT_EQ(b.outbound, a.outbound);
+        EXPECT_EQ(b.appState, a.appState);
+    }
+
+    // 收到的 fd 指向同一管道
+    const char msg = 'x';
+    ASSERT_EQ(write(received.sessions.back().fd, &msg, 1), 1);
+    char got = 0;
+    ASSERT_EQ(read(pipeFds[0], &got, 1), 1);
+    EXPECT_EQ(got, msg);
+
+    for (int fd : sent.listenFds)
+        close(fd);
+    for (int fd : received.listenFds)
+        close(fd);
+    for (auto &session : sent.sessions)
+        close(session.fd);
+    for (auto &session : received.sessions)
+        close(session.fd);
+}
+
+// 测试格式不符的数据被拒绝
+TEST_F(HandoffTest, RejectGarbage)
+{
+    std::vector<uint8_t> garbage(64, 0x5A);
+    uint64_t size = garbage.size();
+    ASSERT_EQ(write(pair[0], &size, sizeof(size)), (ssize_t)sizeof(size));
+    ASSERT_EQ(write(pair[0], garbage.data(), garbage.size()), (ssize_t)garbage.size());
+
+    HandoffState received;
+    EXPECT_FALSE(RecvHandoff(pair[1], received));
+    EXPECT_TRUE(received.sessions.empty());
+}
+
+// 测试控制 Socket 只对属主开放，属于其他用户的对端被拒绝
+TEST_F(HandoffTest, PeerMustBeSameUser)
+{
+    std::string path = "/tmp/gomoku_test_" + std::to_string(getpid()) + ".peer";
+    int listener = ListenHandoff(path);
+    ASSERT_GE(listener, 0);
+    struct stat st{};
+    ASSERT_EQ(stat(path.c_str(), &st), 0);
+    EXPECT_EQ(st.st_mode & 0777, 0600u);
+
+    int conn = ConnectHandoff(path);
+    ASSERT_GE(conn, 0);
+    EXPECT_TRUE(HandoffPeerAllowed(conn, geteuid()));
+    EXPECT_FALSE(HandoffPeerAllowed(conn, geteuid() + 1));
+    EXPECT_FALSE(HandoffPeerAllowed(pipeFds[0], geteuid())); // 不是 Socket，取不到对端凭据
+
+    close(conn);
+    close(listener);
+    unlink(path.c_str());
+}
+
+#endif // _WIN32
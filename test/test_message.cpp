@@ -0,0 +1,282 @@
+#include <gtest/gtest.h>
+#include "PacketView.h"
+#include "AllocCounter.h"
+
+class MessageTest : public ::testing::Test
+{
+protected:
+    // 按原有方式经 map 组包，作为线路格式的参照
+    static std::vector<uint8_t> MapBytes(MsgType type, const MapType &params)
+    {
+        Packet packet(7, type);
+        packet.SetParams(params);
+        return packet.ToBytes();
+    }
+};
+
+// 测试类型化编码与 map 序列化逐字节一致（含 msgType 键的位置与大写键名的排序）
+TEST_F(MessageTest, WireCompatibleWithMapEncoding)
+{
+    MoveMsg move;
+    move.x = 7;
+    move.y = 9;
+    std::vector<uint8_t> typed = Packet::Of(7, MsgType::MakeMove, move).ToBytes();
+    EXPECT_EQ(typed, MapBytes(MsgType::MakeMove, {{"x", uint32_t(7)}, {"y", uint32_t(9)}}));
+
+    // [msgType][字段数 3]["msgType" u32]["x" u32]["y" u32]
+    std::vector<uint8_t> expected = {0x92, 0x01, 0, 0, 3, 0, 0, 0,
+                                     7, 0, 0, 0, 'm', 's', 'g', 'T', 'y', 'p', 'e', 2, 0x92, 0x01, 0, 0,
+                                     1, 0, 0, 0, 'x', 2, 7, 0, 0, 0,
+                                     1, 0, 0, 0, 'y', 2, 9, 0, 0, 0};
+    EXPECT_EQ(typed, expected);
+
+    AccountMsg account;
+    account.username = "alice";
+    account.rating = 1500;
+    EXPECT_EQ(Packet::Of(7, MsgType::Login, account).ToBytes(),
+              MapBytes(MsgType::Login, {{"success", true}, {"username", std::string("alice")}, {"rating", 1500}}));
+    EXPECT_EQ(EncodedSize(account), Packet::Of(7, MsgType::Login, account).ToBytes().size());
+
+    SeatMsg seat;
+    seat.P1 = "black";
+    seat.P2 = "white";
+    EXPECT_EQ(Packet::Of(7, MsgType::SyncSeat, seat).ToBytes(),
+              MapBytes(MsgType::SyncSeat, {{"P1", std::string("black")}, {"P2", std::string("white")}}));
+
+    RoomCreatedMsg created;
+    created.roomId = 42;
+    created.userId = 3;
+    EXPECT_EQ(Packet::Of(7, MsgType::SyncGame, created).ToBytes(),
+              MapBytes(MsgType::SyncGame, {{"roomId", uint64_t(42)}, {"userId", uint64_t(3)},
+                                           {"status", std::string("created")}, {"boardSize", uint32_t(15)}}));
+}
+
+// 测试由 map 组包的数据解码：未知键跳过，缺失字段保留默认值，类型不符的字段保留默认值
+TEST_F(MessageTest, DecodeFromMapPacket)
+{
+    Packet packet;
+    ASSERT_TRUE(packet.FromData(7, MapBytes(MsgType::MakeMove, {{"x", 3}, {"y", uint32_t(4)}, {"extra", std::string("skip")}})));
+    EXPECT_EQ(packet.msgType, MsgType::MakeMove);
+    MoveMsg move;
+    ASSERT_TRUE(packet.As(move));
+    EXPECT_EQ(move.x, 3u); // int 索引按 uint32_t 读取，与 GetParam<uint32_t> 一致
+    EXPECT_EQ(move.y, 4u);
+
+    ASSERT_TRUE(packet.FromData(7, MapBytes(MsgType::updateRoomsToLobby, {})));
+    ListQueryMsg query;
+    ASSERT_TRUE(packet.As(query));
+    EXPECT_EQ(query.maxCount, 10u);
+
+    ASSERT_TRUE(packet.FromData(7, MapBytes(MsgType::MakeMove, {{"x", std::string("3")}, {"y", uint32_t(5)}})));
+    MoveMsg mismatched;
+    ASSERT_TRUE(packet.As(mismatched));
+    EXPECT_EQ(mismatched.x, 0u);
+    EXPECT_EQ(mismatched.y, 5u);
+}
+
+// 测试截断或类型索引未知的数据在 FromData 时被拒绝
+TEST_F(MessageTest, RejectMalformed)
+{
+    CredentialsMsg credentials;
+    credentials.username = "bob";
+    credentials.password = "secret";
+    std::vector<uint8_t> bytes = Packet::Of(7, MsgType::Login, credentials).ToBytes();
+
+    Packet packet;
+    for (size_t len = 0; len < bytes.size(); len++)
+        EXPECT_FALSE(packet.FromData(7, std::vector<uint8_t>(bytes.begin(), bytes.begin() + len))) << len;
+
+    std::vector<uint8_t> badIndex = bytes;
+    badIndex[8 + 4 + 7] = 9; // "msgType" 的类型索引
+    EXPECT_FALSE(packet.FromData(7, badIndex));
+
+    ASSERT_TRUE(packet.FromData(7, bytes));
+    CredentialsMsg decoded;
+    ASSERT_TRUE(packet.As(decoded));
+    EXPECT_EQ(decoded.username, "bob");
+    EXPECT_EQ(decoded.password, "secret");
+}
+
+// 测试类型化 Packet 仍可按 map 读取与追加字段
+TEST_F(MessageTest, MapAccessOnTypedPacket)
+{
+    ChatPushMsg chat;
+    chat.roomId = 5;
+    chat.userId = 6;
+    chat.message = "hi";
+    Packet packet;
+    ASSERT_TRUE(packet.FromData(7, Packet::Of(7, MsgType::ChatMessage, chat).ToBytes()));
+    EXPECT_EQ(packet.GetParam<std::string>("message"), "hi");
+    EXPECT_EQ(packet.GetParam<uint64_t>("roomId"), 5u);
+    EXPECT_EQ(packet.GetParams().count("msgType"), 0u);
+
+    packet.AddParam("seq", uint32_t(11));
+    Packet reparsed;
+    ASSERT_TRUE(reparsed.FromData(7, packet.ToBytes()));
+    EXPECT_EQ(reparsed.msgType, MsgType::ChatMessage);
+    EXPECT_EQ(reparsed.GetParam<uint32_t>("seq"), 11u);
+    ChatPushMsg decoded;
+    ASSERT_TRUE(reparsed.As(decoded));
+    EXPECT_EQ(decoded.userId, 6u);
+    EXPECT_EQ(decoded.message, "hi");
+}
+
+// 测试 Packet::Of 构造的 Packet 不经序列化直接按 map 读取，追加字段不丢失类型化字段
+TEST_F(MessageTest, MapAccessOnOfPacket)
+{
+    MoveMsg move;
+    move.x = 3;
+    move.y = 4;
+    Packet packet = Packet::Of(7, MsgType::MakeMove, move);
+    EXPECT_EQ(packet.GetParam<uint32_t>("x", 999), 3u);
+    EXPECT_EQ(packet.GetParams().size(), 2u);
+
+    packet.AddParam("seq", uint32_t(11));
+    EXPECT_EQ(packet.GetParam<uint32_t>("y"), 4u);
+    MoveMsg decoded;
+    ASSERT_TRUE(packet.As(decoded));
+    EXPECT_EQ(decoded.x, 3u);
+    EXPECT_EQ(decoded.y, 4u);
+}
+
+// 测试两遍编码：EncodedSize 与实际写入的长度一致，WriteTo 不越界、不分配内存
+TEST_F(MessageTest, TwoPassEncoding)
+{
+    ChatPushMsg chat;
+    chat.roomId = 5;
+    chat.userId = 6;
+    chat.message = "hello";
+    Packet typed = Packet::Of(7, MsgType::ChatMessage, chat);
+    Packet mapped(7, MsgType::SyncRoomSetting);
+    mapped.SetParams({{"boardSize", uint32_t(19)}, {"name", std::string("room")}, {"delta", -1}});
+
+    for (WireFormat format : {WireFormat::Standard, WireFormat::Compact})
+    {
+        for (const Packet *packet : {&typed, &mapped})
+        {
+            std::vector<uint8_t> expected = packet->ToBytes(format);
+            ASSERT_EQ(packet->EncodedSize(format), expected.size());
+
+            std::vector<uint8_t> buffer(expected.size() + 4, 0xEE);
+            size_t before = AllocCount();
+            packet->WriteTo(buffer.data(), format);
+            EXPECT_EQ(AllocCount() - before, 0u);
+            EXPECT_TRUE(std::equal(expected.begin(), expected.end(), buffer.begin()));
+            EXPECT_EQ(buffer[expected.size()], 0xEE);
+        }
+    }
+    EXPECT_EQ(mapped.ToBytes(), MapBytes(MsgType::SyncRoomSetting, mapped.GetParams()));
+}
+
+// 测试共享负载：两种格式的字节与共享前一致，副本不分配内存，修改副本不影响其他副本
+TEST_F(MessageTest, SharedPayload)
+{
+    ChatPushMsg chat;
+    chat.roomId = 5;
+    chat.userId = 6;
+    chat.message = "hello";
+    Packet typed = Packet::Of(0, MsgType::ChatMessage, chat);
+    Packet mapped(0, MsgType::SyncRoomSetting);
+    mapped.SetParams({{"boardSize", uint32_t(19)}, {"name", std::string("room")}});
+
+    for (Packet *packet : {&typed, &mapped})
+    {
+        std::vector<uint8_t> standard = packet->ToBytes();
+        std::vector<uint8_t> compact = packet->ToBytes(WireFormat::Compact);
+        packet->Share();
+        packet->Share(); // 重复调用无副作用
+
+        size_t before = AllocCount();
+        Packet copy = *packet;
+        copy.sessionId = 42;
+        EXPECT_EQ(AllocCount() - before, 0u);
+
+        EXPECT_EQ(copy.ToBytes(), standard);
+        EXPECT_EQ(copy.ToBytes(WireFormat::Compact), compact);
+        EXPECT_EQ(copy.EncodedSize(WireFormat::Compact), compact.size());
+        std::vector<uint8_t> buffer(compact.size());
+        copy.WriteTo(buffer.data(), WireFormat::Compact);
+        EXPECT_EQ(buffer, compact);
+        EXPECT_EQ(copy.View().sessionId, 42u);
+    }
+
+    ChatPushMsg decoded;
+    ASSERT_TRUE(typed.As(decoded));
+    EXPECT_EQ(decoded.message, "hello");
+    EXPECT_EQ(mapped.GetParam<std::string>("name"), "room");
+
+    Packet modified = mapped;
+    modified.AddParam("seq", uint32_t(11));
+    EXPECT_EQ(modified.GetParam<uint32_t>("boardSize"), 19u);
+    EXPECT_EQ(modified.GetParam<uint32_t>("seq"), 11u);
+    EXPECT_EQ(mapped.GetParams().count("seq"), 0u);
+    EXPECT_EQ(mapped.ToBytes(), MapBytes(MsgType::SyncRoomSetting, {{"boardSize", uint32_t(19)}, {"name", std::string("room")}}));
+}
+
+// 测试批量负载：两种格式往返后顺序与内容不变，截断或多余字节整批拒绝
+TEST_F(MessageTest, BatchRoundTrip)
+{
+    MoveMsg move;
+    move.x = 3;
+    move.y = 4;
+    JoinRoomMsg join;
+    join.roomId = 9;
+    std::vector<Packet> packets = {Packet::Of(7, MsgType::JoinRoom, join), Packet::Of(7, MsgType::SyncSeat, SeatMsg()),
+                                   Packet(7, MsgType::SyncRoomSetting), Packet::Of(7, MsgType::MakeMove, move)};
+
+    for (WireFormat format : {WireFormat::Standard, WireFormat::Compact})
+    {
+        size_t size = BatchEncodedSize(packets.data(), packets.size(), format);
+        std::vector<uint8_t> bytes(size + 1, 0xEE);
+        WriteBatch(packets.data(), packets.size(), bytes.data(), format);
+        EXPECT_EQ(bytes[size], 0xEE);
+        bytes.pop_back();
+
+        std::vector<Packet> decoded;
+        ASSERT_TRUE(ReadBatch(7, bytes, decoded, format));
+        ASSERT_EQ(decoded.size(), packets.size());
+        for (size_t i = 0; i < packets.size(); i++)
+        {
+            EXPECT_EQ(decoded[i].msgType, packets[i].msgType);
+            EXPECT_EQ(decoded[i].ToBytes(), packets[i].ToBytes());
+        }
+        MoveMsg decodedMove;
+        ASSERT_TRUE(decoded[3].As(decodedMove));
+        EXPECT_EQ(decodedMove.y, 4u);
+
+        for (size_t len = 0; len < bytes.size(); len++)
+            EXPECT_FALSE(ReadBatch(7, std::vector<uint8_t>(bytes.begin(), bytes.begin() + len), decoded, format)) << len;
+        bytes.push_back(0);
+        EXPECT_FALSE(ReadBatch(7, bytes, decoded, format));
+    }
+
+    std::vector<Packet> decoded;
+    std::vector<uint8_t> empty(4, 0);
+    ASSERT_TRUE(ReadBatch(7, empty, decoded));
+    EXPECT_TRUE(decoded.empty());
+    std::vector<uint8_t> huge = {0xFF, 0xFF, 0xFF, 0xFF};
+    EXPECT_FALSE(ReadBatch(7, huge, decoded));
+}
+
+// 测试 requestId：非零时按键名顺序编码，与 map 组包一致；为 0 时不输出；紧凑格式使用字典编号
+TEST_F(MessageTest, RequestIdEncoding)
+{
+    MoveResultMsg result;
+    result.x = 1;
+    result.y = 2;
+    Packet reply = Packet::Of(7, MsgType::MakeMove, result, 42);
+    EXPECT_EQ(reply.ToBytes(), MapBytes(MsgType::MakeMove, {{"x", uint32_t(1)}, {"y", uint32_t(2)}, {"success", true}, {"requestId", uint32_t(42)}}));
+    EXPECT_EQ(reply.EncodedSize(), EncodedSize(result, 42));
+    EXPECT_EQ(reply.View().RequestId(), 42u);
+    EXPECT_EQ(Packet::Of(7, MsgType::MakeMove, result, 0).ToBytes(), Packet::Of(7, MsgType::MakeMove, result).ToBytes());
+    EXPECT_EQ(Packet::Of(7, MsgType::MakeMove, result).View().RequestId(), 0u);
+
+    std::vector<uint8_t> compact = reply.ToBytes(WireFormat::Compact);
+    EXPECT_EQ(compact.size(), Packet::Of(7, MsgType::MakeMove, result).ToBytes(WireFormat::Compact).size() + 2);
+    Packet decoded;
+    ASSERT_TRUE(decoded.FromData(7, compact, WireFormat::Compact));
+    EXPECT_EQ(decoded.View().RequestId(), 42u);
+    MoveResultMsg decodedResult;
+    ASSERT_TRUE(decoded.As(decodedResult));
+    EXPECT_EQ(decodedResult.y, 2u);
+}
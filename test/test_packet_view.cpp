@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include "PacketView.h"
+#include "AllocCounter.h"
+
+#include <cstring>
+
+class PacketViewTest : public ::testing::Test
+{
+protected:
+    static std::vector<uint8_t> Bytes(MsgType type, const MapType &params)
+    {
+        Packet packet(7, type);
+        packet.SetParams(params);
+        return packet.ToBytes();
+    }
+};
+
+// 测试按键原地取值：字符串与字节数组指向原始数据，缺失或类型不符时返回默认值
+TEST_F(PacketViewTest, GetInPlace)
+{
+    std::vector<uint8_t> bytes = Bytes(MsgType::ChatMessage, {{"message", std::string("hello")},
+                                                              {"blob", std::vector<uint8_t>{1, 2, 3}},
+                                                              {"x", 5},
+                                                              {"roomId", uint64_t(9)},
+                                                              {"ok", true}});
+    PacketView view;
+    ASSERT_TRUE(view.Parse(3, bytes.data(), bytes.size()));
+    EXPECT_EQ(view.sessionId, 3u);
+    EXPECT_EQ(view.msgType, MsgType::ChatMessage);
+    EXPECT_EQ(view.Count(), 6u); // 含 msgType
+
+    std::string_view message = view.Get<std::string_view>("message");
+    EXPECT_EQ(message, "hello");
+    EXPECT_GE((const uint8_t *)message.data(), bytes.data());
+    EXPECT_LT((const uint8_t *)message.data(), bytes.data() + bytes.size());
+
+    ByteSpan blob = view.Get<ByteSpan>("blob");
+    ASSERT_EQ(blob.size, 3u);
+    EXPECT_EQ(blob.data[2], 3);
+    EXPECT_EQ(view.Get<uint32_t>("x"), 5u);
+    EXPECT_EQ(view.Get<uint64_t>("roomId"), 9u);
+    EXPECT_TRUE(view.Get<bool>("ok"));
+    EXPECT_EQ(view.Get<uint32_t>("msgType"), (uint32_t)MsgType::ChatMessage);
+
+    EXPECT_EQ(view.Get<uint32_t>("missing", 42), 42u);
+    EXPECT_EQ(view.Get<uint64_t>("x", 1), 1u);
+    EXPECT_EQ(view.Get<std::string_view>("roomId"), "");
+
+    MapType params = view.ToParams();
+    EXPECT_EQ(params.size(), 5u);
+    EXPECT_EQ(std::get<std::string>(params["message"]), "hello");
+    EXPECT_EQ(std::get<uint32_t>(params["x"]), 5u);
+}
+
+// 测试心跳、落子、加入房间的解析与取值全程不分配内存
+TEST_F(PacketViewTest, TypicalRequestsDoNotAllocate)
+{
+    std::vector<std::vector<uint8_t>> requests = {
+        Bytes(MsgType::None, {}),
+        Bytes(MsgType::MakeMove, {{"x", uint32_t(7)}, {"y", uint32_t(8)}}),
+        Bytes(MsgType::JoinRoom, {{"roomId", uint32_t(12)}}),
+    };
+
+    uint32_t sum = 0;
+    size_t before = AllocCount();
+    for (std::vector<uint8_t> &bytes : requests)
+    {
+        Packet packet;
+        ASSERT_TRUE(packet.FromData(7, std::move(bytes)));
+        PacketView view = packet.View();
+        MoveMsg move;
+        JoinRoomMsg join;
+        switch (view.msgType)
+        {
+        case MsgType::MakeMove:
+            ASSERT_TRUE(view.As(move));
+            sum += move.x + move.y;
+            break;
+        case MsgType::JoinRoom:
+            ASSERT_TRUE(view.As(join));
+            sum += join.roomId;
+            break;
+        default:
+            break;
+        }
+    }
+    EXPECT_EQ(AllocCount() - before, 0u);
+    EXPECT_EQ(sum, 7u + 8u + 12u);
+}
+
+// 测试字段数超过内联容量时溢出到堆上，仍能完整解析（两种线路格式）
+TEST_F(PacketViewTest, ManyFieldsOverflow)
+{
+    MapType many;
+    for (uint32_t i = 0; i < 3 * INLINE_VIEW_FIELDS; i++)
+        many["k" + std::to_string(i)] = i;
+    for (WireFormat format : {WireFormat::Standard, WireFormat::Compact})
+    {
+        Packet source(7, MsgType::SyncRoomSetting);
+        source.SetParams(many);
+        Packet packet;
+        ASSERT_TRUE(packet.FromData(7, source.ToBytes(format), format));
+        PacketView view = packet.View();
+        ASSERT_EQ(view.Count(), many.size() + 1); // 含 msgType
+        EXPECT_EQ(view.msgType, MsgType::SyncRoomSetting);
+        for (uint32_t i = 0; i < 3 * INLINE_VIEW_FIELDS; i++)
+            EXPECT_EQ(view.Get<uint32_t>("k" + std::to_string(i), 9999), i);
+        EXPECT_EQ(view.ToParams().size(), many.size());
+    }
+
+    // 不超过内联容量时仍不分配
+    MapType few;
+    for (uint32_t i = 0; i + 1 < INLINE_VIEW_FIELDS; i++)
+        few["k" + std::to_string(i)] = i;
+    std::vector<uint8_t> bytes = Bytes(MsgType::SyncRoomSetting, few);
+    PacketView view;
+    size_t before = AllocCount();
+    ASSERT_TRUE(view.Parse(7, bytes.data(), bytes.size()));
+    EXPECT_EQ(AllocCount() - before, 0u);
+    EXPECT_EQ(view.Count(), (size_t)INLINE_VIEW_FIELDS);
+}
+
+// 测试结构损坏或字段计数超过数据长度时解析失败
+TEST_F(PacketViewTest, RejectMalformed)
+{
+    MapType many;
+    for (int i = 0; i < 8; i++)
+        many["k" + std::to_string(i)] = true;
+    std::vector<uint8_t> bytes = Bytes(MsgType::SyncRoomSetting, many);
+    PacketView view;
+    EXPECT_TRUE(view.Parse(7, bytes.data(), bytes.size()));
+    EXPECT_FALSE(view.Parse(7, bytes.data(), bytes.size() - 1));
+    EXPECT_EQ(view.Count(), 0u);
+
+    // 伪造的超大字段计数在分配之前被拒绝
+    uint32_t forged = 0xFFFFFFFF;
+    std::memcpy(bytes.data() + 4, &forged, 4);
+    size_t before = AllocCount();
+    EXPECT_FALSE(view.Parse(7, bytes.data(), bytes.size()));
+    EXPECT_EQ(AllocCount() - before, 0u);
+    Packet packet;
+    EXPECT_FALSE(packet.FromData(7, bytes));
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include "RecvBuffer.h"
+#include "FrameDecoder.h"
+
+#include <cstring>
+
+class RecvBufferTest : public ::testing::Test
+{
+protected:
+    RecvBuffer buffer;
+
+    // 模拟一次 recv：按 Reserve / WritePtr / Commit 写入 [first, first + len) 的递增字节
+    void Receive(uint8_t first, size_t len)
+    {
+        buffer.Reserve(len);
+        for (size_t i = 0; i < len; i++)
+            buffer.WritePtr()[i] = (uint8_t)(first + i);
+        buffer.Commit(len);
+    }
+
+    void ExpectReadable(uint8_t first, size_t len)
+    {
+        ASSERT_EQ(buffer.Readable(), len);
+        for (size_t i = 0; i < len; i++)
+            ASSERT_EQ(buffer.ReadPtr()[i], (uint8_t)(first + i)) << "offset " << i;
+    }
+};
+
+// 测试写空间不足时把未读尾部搬到开头，容量足够则不扩容
+TEST_F(RecvBufferTest, CompactsUnreadTail)
+{
+    Receive(0, 100);
+    buffer.Consume(80);
+    EXPECT_EQ(buffer.Writable(), 0u);
+
+    Receive(100, 50);
+    ExpectReadable(80, 70);
+    EXPECT_EQ(buffer.Readable() + buffer.Writable(), 100u); // 只搬移，未扩容
+}
+
+// 测试写空间足够时不搬移，读游标原地前进
+TEST_F(RecvBufferTest, NoCompactionWhileSpaceRemains)
+{
+    buffer.Reserve(128);
+    Receive(0, 64);
+    buffer.Consume(16);
+    const uint8_t *read = buffer.ReadPtr();
+    Receive(64, 32);
+    EXPECT_EQ(buffer.ReadPtr(), read);
+    ExpectReadable(16, 80);
+}
+
+// 测试只读出一小段前缀时扩容而不搬移：积压很大时每次追加都搬移整段会退化为 O(n²)
+TEST_F(RecvBufferTest, SmallPrefixGrowsInsteadOfMoving)
+{
+    Receive(0, 200);
+    buffer.Consume(10);
+    Receive(200, 10);
+    EXPECT_EQ(buffer.Readable() + buffer.Writable(), 400u - 10u); // 容量翻倍，读游标未动
+    for (int i = 0; i < 19; i++)
+        Receive((uint8_t)(210 + i * 10), 10);
+    EXPECT_EQ(buffer.Readable() + buffer.Writable(), 400u - 10u); // 倍增后的空间足够，不再搬移或扩容
+    ExpectReadable(10, 390);
+}
+
+// 测试读空后游标归零，下一次写入从头开始
+TEST_F(RecvBufferTest, ConsumeAllResetsCursors)
+{
+    Receive(0, 64);
+    buffer.Consume(64);
+    EXPECT_EQ(buffer.Readable(), 0u);
+    EXPECT_EQ(buffer.Writable(), 64u);
+}
+
+// 测试未读数据超过初始容量时扩容，已有内容保留
+TEST_F(RecvBufferTest, GrowsPastInitialCapacity)
+{
+    Receive(0, 16);
+    buffer.Consume(4);
+    Receive(16, 4096);
+    EXPECT_GE(buffer.Readable() + buffer.Writable(), 4108u);
+    ExpectReadable(4, 4108);
+}
+
+// 测试跨两次读取的帧：前一帧解出后半帧随搬移移到开头，补齐后完整解出
+TEST_F(RecvBufferTest, FrameSplitAcrossReads)
+{
+    std::vector<uint8_t> first = Frame(Frame::Status::Active, 1, {}, std::vector<uint8_t>(200, 0xAA)).ToBytes();
+    std::vector<uint8_t> second = Frame(Frame::Status::Active, 2, {}, std::vector<uint8_t>(300, 0xBB)).ToBytes();
+    std::vector<uint8_t> stream = first;
+    stream.insert(stream.end(), second.begin(), second.end());
+
+    FrameDecoder decoder;
+    RecvBuffer &recv = decoder.Buffer();
+    size_t cut = first.size() + 100;
+    recv.Reserve(cut);
+    std::memcpy(recv.WritePtr(), stream.data(), cut);
+    recv.Commit(cut);
+
+    Frame frame;
+    ASSERT_TRUE(decoder.Next(frame));
+    EXPECT_EQ(frame.head.sessionId, 1u);
+    EXPECT_FALSE(decoder.Next(frame));
+
+    size_t rest = stream.size() - cut;
+    recv.Reserve(rest);
+    std::memcpy(recv.WritePtr(), stream.data() + cut, rest);
+    recv.Commit(rest);
+    ASSERT_TRUE(decoder.Next(frame));
+    EXPECT_EQ(frame.head.sessionId, 2u);
+    EXPECT_EQ(frame.data, std::vector<uint8_t>(300, 0xBB));
+    EXPECT_EQ(recv.Readable(), 0u);
+    EXPECT_EQ(decoder.SkippedBytes(), 0u);
+}
@@ -0,0 +1,102 @@
+#ifndef _WIN32
+
+#include <gtest/gtest.h>
+#include "SendQueue.h"
+#include "AllocCounter.h"
+
+#include <cstring>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+class SendQueueTest : public ::testing::Test
+{
+protected:
+    SendQueue queue;
+    int pair[2] = {-1, -1};
+
+    void SetUp() override
+    {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+        int sndbuf = 4096;
+        setsockopt(pair[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        fcntl(pair[0], F_SETFL, fcntl(pair[0], F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    void TearDown() override
+    {
+        close(pair[0]);
+        close(pair[1]);
+    }
+
+    void Push(uint8_t fill, size_t len)
+    {
+        std::memset(queue.Reserve(len), fill, len);
+        queue.Commit(len);
+    }
+
+    std::vector<uint8_t> ReadAll()
+    {
+        std::vector<uint8_t> out;
+        uint8_t buf[4096];
+        ssize_t n;
+        while ((n = recv(pair[1], buf, sizeof(buf), MSG_DONTWAIT)) > 0)
+            out.insert(out.end(), buf, buf + n);
+        return out;
+    }
+};
+
+// 测试写不完时剩余字节与帧数保留，可写后按顺序写出
+TEST_F(SendQueueTest, PartialFlushKeepsOrder)
+{
+    std::vector<uint8_t> expected;
+    for (int i = 0; i < 64; i++)
+    {
+        Push((uint8_t)i, 1000);
+        expected.insert(expected.end(), 1000, (uint8_t)i);
+    }
+    EXPECT_EQ(queue.Chunks(), 64u);
+    EXPECT_EQ(queue.Size(), 64000u);
+
+    std::vector<uint8_t> received;
+    size_t syscalls = 0;
+    SendQueue::FlushResult result = queue.Flush(pair[0], syscalls);
+    EXPECT_EQ(result, SendQueue::WouldBlock);
+    EXPECT_GT(queue.Chunks(), 0u);
+    EXPECT_LT(queue.Chunks(), 64u);
+    while (result != SendQueue::Drained)
+    {
+        std::vector<uint8_t> part = ReadAll();
+        received.insert(received.end(), part.begin(), part.end());
+        result = queue.Flush(pair[0], syscalls);
+        ASSERT_NE(result, SendQueue::Failed);
+    }
+    std::vector<uint8_t> rest = ReadAll();
+    received.insert(received.end(), rest.begin(), rest.end());
+    EXPECT_EQ(received, expected);
+    EXPECT_TRUE(queue.Empty());
+    EXPECT_EQ(queue.Chunks(), 0u);
+}
+
+// 测试容量在写出后复用：稳定后入队与写出都不分配内存
+TEST_F(SendQueueTest, ReuseWithoutAllocation)
+{
+    size_t syscalls = 0;
+    for (int i = 0; i < 8; i++)
+        Push(1, 200);
+    ASSERT_EQ(queue.Flush(pair[0], syscalls), SendQueue::Drained);
+    ReadAll();
+
+    size_t before = AllocCount();
+    for (int round = 0; round < 100; round++)
+    {
+        for (int i = 0; i < 8; i++)
+            Push((uint8_t)round, 200);
+        ASSERT_EQ(queue.Flush(pair[0], syscalls), SendQueue::Drained);
+        uint8_t buf[4096];
+        ASSERT_EQ(recv(pair[1], buf, sizeof(buf), 0), 1600);
+    }
+    EXPECT_EQ(AllocCount() - before, 0u);
+}
+
+#endif
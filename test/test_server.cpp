@@ -0,0 +1,1248 @@
+#ifndef _WIN32
+
+#include <gtest/gtest.h>
+#include "Server.h"
+#include "BenchUtil.h"
+#include "AllocCounter.h"
+#include "PacketView.h"
+
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstring>
+
+#define TEST_PORT 18190
+
+class ServerTest : public ::testing::Test
+{
+protected:
+    Server server;
+    std::thread serverThread;
+    SOCKET_TYPE client = (SOCKET_TYPE)INVALID_SOCKET;
+    SessionContext session{-1, 0}; // 客户端一侧的会话密钥
+    uint64_t sessionId = 0;
+
+    void Launch()
+    {
+        server.SetPort(TEST_PORT);
+        ASSERT_EQ(server.Init(), 0);
+        serverThread = std::thread([this]()
+                                   { server.Run(); });
+    }
+
+    // 启动服务端并建立一个已握手的客户端；接收缓冲区调小以便快速制造积压
+    void Start(size_t low, size_t high, size_t hard)
+    {
+        server.SetBackpressure(low, high, hard);
+        Launch();
+
+        client = ConnectLoopback(TEST_PORT);
+        ASSERT_NE(client, (SOCKET_TYPE)INVALID_SOCKET);
+        int rcvbuf = 16 * 1024;
+        setsockopt(client, SOL_SOCKET, SO_RCVBUF, (const char *)&rcvbuf, sizeof(rcvbuf));
+        timeval timeout{5, 0};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+        ASSERT_TRUE(Handshake(client, session));
+        sessionId = session.sessionId;
+    }
+
+    void TearDown() override
+    {
+        if (client != (SOCKET_TYPE)INVALID_SOCKET)
+            CLOSE_SOCKET(client);
+        server.Stop();
+        if (serverThread.joinable())
+            serverThread.join();
+    }
+
+    Packet Push(MsgType type, uint32_t seq, size_t padding = 0)
+    {
+        Packet packet(sessionId, type);
+        packet.AddParam("seq", seq);
+        packet.AddParam("pad", std::string(padding, 'x'));
+        return packet;
+    }
+
+    // 轮询统计直到条件满足（SendPacket 跨线程投递，异步执行）
+    template <typename Pred>
+    bool WaitFor(Pred pred)
+    {
+        for (int i = 0; i < 500; i++)
+        {
+            if (pred(server.GetStats()))
+                return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+};
+
+// 测试积压期间对局消息全部送达，聊天被丢弃，大厅列表只保留最新一份
+TEST_F(ServerTest, ShedNonCriticalPushes)
+{
+    Start(8 * 1024, 32 * 1024, 64 * 1024 * 1024);
+
+    const uint32_t rounds = 500;
+    for (uint32_t i = 0; i < rounds; i++)
+    {
+        server.SendPacket(Push(MsgType::MakeMove, i, 512));
+        server.SendPacket(Push(MsgType::ChatMessage, i, 512));
+        server.SendPacket(Push(MsgType::updateRoomsToLobby, i, 512));
+    }
+    server.SendPacket(Push(MsgType::GameEnded, rounds));
+
+    // 客户端开始读取：MakeMove 必须连续，最后一份房间列表必须到达
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    uint32_t nextMove = 0;
+    uint32_t lastRooms = 0;
+    bool ended = false;
+    while (!ended || lastRooms != rounds - 1)
+    {
+        ASSERT_TRUE(RecvFrame(client, head, data));
+        ASSERT_TRUE(OpenFrame(session, head, data));
+        Packet packet;
+        ASSERT_TRUE(packet.FromData(sessionId, data));
+        uint32_t seq = packet.GetParam<uint32_t>("seq");
+        if (packet.msgType == MsgType::MakeMove)
+            EXPECT_EQ(seq, nextMove++);
+        else if (packet.msgType == MsgType::updateRoomsToLobby)
+            lastRooms = seq;
+        else if (packet.msgType == MsgType::GameEnded)
+            ended = true;
+    }
+    EXPECT_EQ(nextMove, rounds);
+
+    Server::NetStats stats = server.GetStats();
+    EXPECT_GT(stats.dropped, 0u);
+    EXPECT_GT(stats.coalesced, 0u);
+    EXPECT_EQ(stats.slowDisconnects, 0u);
+
+    Server::OutboundStats session = server.GetOutboundStats(sessionId);
+    EXPECT_EQ(session.dropped, stats.dropped);
+    EXPECT_EQ(session.coalesced, stats.coalesced);
+}
+
+// 测试积压超过硬上限时断开连接
+TEST_F(ServerTest, DisconnectAboveHardLimit)
+{
+    Start(8 * 1024, 32 * 1024, 256 * 1024);
+
+    for (uint32_t i = 0; i < 20000; i++)
+        server.SendPacket(Push(MsgType::MakeMove, i, 512));
+
+    EXPECT_TRUE(WaitFor([](const Server::NetStats &stats)
+                        { return stats.slowDisconnects == 1; }));
+
+    // 服务端已断开，客户端读完内核缓冲区后应收到 EOF 或连接重置
+    uint8_t buf[4096];
+    int n;
+    while ((n = recv(client, (char *)buf, sizeof(buf), 0)) > 0)
+    {
+    }
+    EXPECT_LE(n, 0);
+    EXPECT_EQ(server.GetOutboundDepth(sessionId), 0u);
+}
+
+// 测试短写：内核发送缓冲区写满后剩余字节排队，可写事件到来后按序续写，内容不损坏
+TEST_F(ServerTest, PartialSendResumesInOrder)
+{
+    Start(8 * 1024, 32 * 1024, 64 * 1024 * 1024);
+
+    // 客户端接收缓冲区只有 16K 且暂不读取，约 5MB 的对局消息必然写不完
+    const uint32_t count = 10000;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        Packet packet(sessionId, MsgType::MakeMove);
+        packet.AddParam("seq", i);
+        packet.AddParam("pad", std::string(512, char('a' + i % 26)));
+        server.SendPacket(packet);
+    }
+    ASSERT_TRUE(WaitFor([this](const Server::NetStats &)
+                        { return server.GetOutboundDepth(sessionId) > 0; }));
+
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        ASSERT_TRUE(RecvFrame(client, head, data));
+        ASSERT_TRUE(OpenFrame(session, head, data));
+        Packet packet;
+        ASSERT_TRUE(packet.FromData(sessionId, data));
+        ASSERT_EQ(packet.GetParam<uint32_t>("seq"), i);
+        ASSERT_EQ(packet.GetParam<std::string>("pad"), std::string(512, char('a' + i % 26)));
+    }
+    EXPECT_TRUE(WaitFor([this](const Server::NetStats &)
+                        { return server.GetOutboundDepth(sessionId) == 0; }));
+    EXPECT_EQ(server.GetStats().slowDisconnects, 0u);
+}
+
+// 测试一轮事件循环内产生的多个帧合并为一次 sendmsg 写出
+TEST_F(ServerTest, FramesCoalescedIntoOneSend)
+{
+    const uint32_t replies = 4;
+    server.SetOnPacketCallback([this](const Packet &packet)
+                               {
+        for (uint32_t i = 0; i < replies; i++)
+        {
+            Packet reply(packet.sessionId, MsgType::MakeMove);
+            reply.AddParam("seq", i);
+            server.SendPacket(reply);
+        } });
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+    // 握手应答的统计在写出返回后才更新，客户端收到时可能尚未计入；等计数稳定后再取基准
+    Server::NetStats before = server.GetStats();
+    ASSERT_TRUE(WaitFor([&before](const Server::NetStats &stats)
+                        {
+        bool settled = stats.framesSent == before.framesSent && stats.sendCalls == before.sendCalls;
+        before = stats;
+        return settled; }));
+
+    Packet request(sessionId, MsgType::ChatMessage);
+    ASSERT_TRUE(SendAll(client, SealFrame(session, request.ToBytes())));
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    for (uint32_t i = 0; i < replies; i++)
+    {
+        ASSERT_TRUE(RecvFrame(client, head, data));
+        ASSERT_TRUE(OpenFrame(session, head, data));
+        Packet packet;
+        ASSERT_TRUE(packet.FromData(sessionId, data));
+        EXPECT_EQ(packet.GetParam<uint32_t>("seq"), i);
+    }
+
+    // 回调在 Reactor 线程上执行，4 个应答都在同一轮循环末尾写出；统计在系统调用返回后更新
+    ASSERT_TRUE(WaitFor([&before](const Server::NetStats &stats)
+                        { return stats.framesSent == before.framesSent + replies; }));
+    Server::NetStats after = server.GetStats();
+    EXPECT_EQ(after.sendCalls - before.sendCalls, 1u);
+    EXPECT_EQ(after.flushes - before.flushes, 1u);
+    EXPECT_EQ(after.syscallsSaved - before.syscallsSaved, replies - 1);
+}
+
+// 握手成功返回 true；被服务端拒绝的连接会直接读到 EOF
+static bool TryHandshake(SOCKET_TYPE sock)
+{
+    timeval timeout{2, 0};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+    return sock != (SOCKET_TYPE)INVALID_SOCKET && Handshake(sock) != 0;
+}
+
+// 测试单 IP 并发连接上限，断开后名额归还
+TEST_F(ServerTest, PerAddressLimit)
+{
+    server.SetConnectionLimits(0, 2);
+    Launch();
+
+    SOCKET_TYPE a = ConnectLoopback(TEST_PORT);
+    SOCKET_TYPE b = ConnectLoopback(TEST_PORT);
+    SOCKET_TYPE c = ConnectLoopback(TEST_PORT);
+    EXPECT_TRUE(TryHandshake(a));
+    EXPECT_TRUE(TryHandshake(b));
+    EXPECT_FALSE(TryHandshake(c));
+    CLOSE_SOCKET(c);
+
+    CLOSE_SOCKET(a);
+    EXPECT_TRUE(WaitFor([this](const Server::NetStats &)
+                        {
+        // 断开由服务端异步处理，轮询直到新连接可以准入
+        SOCKET_TYPE d = ConnectLoopback(TEST_PORT);
+        bool ok = TryHandshake(d);
+        CLOSE_SOCKET(d);
+        return ok; }));
+    CLOSE_SOCKET(b);
+
+    Server::NetStats stats = server.GetStats();
+    EXPECT_GE(stats.rejected, 1u);
+}
+
+// 测试全局连接上限在建立会话之前拒绝
+TEST_F(ServerTest, GlobalConnectionLimit)
+{
+    server.SetConnectionLimits(3, 0);
+    Launch();
+
+    std::vector<SOCKET_TYPE> socks;
+    for (int i = 0; i < 5; i++)
+        socks.push_back(ConnectLoopback(TEST_PORT));
+
+    int admitted = 0;
+    for (SOCKET_TYPE sock : socks)
+    {
+        admitted += TryHandshake(sock);
+        CLOSE_SOCKET(sock);
+    }
+    EXPECT_EQ(admitted, 3);
+    EXPECT_EQ(server.GetStats().accepted, 3u);
+    EXPECT_EQ(server.GetStats().rejected, 2u);
+}
+
+// 测试无心跳的会话超时断开，持续心跳的会话保持连接
+TEST_F(ServerTest, SessionTimeout)
+{
+    server.SetSessionTimeout(300);
+    Launch();
+
+    SOCKET_TYPE idle = ConnectLoopback(TEST_PORT);
+    SOCKET_TYPE alive = ConnectLoopback(TEST_PORT);
+    SessionContext aliveSession(-1, 0);
+    ASSERT_TRUE(TryHandshake(idle));
+    ASSERT_TRUE(Handshake(alive, aliveSession));
+
+    for (int i = 0; i < 10; i++)
+    {
+        ASSERT_TRUE(SendAll(alive, SealFrame(aliveSession, Packet(aliveSession.sessionId, MsgType::None).ToBytes())));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    // 空闲连接此时应已被服务端关闭
+    uint8_t buf[64];
+    EXPECT_EQ(recv(idle, (char *)buf, sizeof(buf), 0), 0);
+    EXPECT_EQ(server.GetStats().expired, 1u);
+
+    // 心跳连接仍然可用
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(SendAll(alive, Frame(Frame::Status::Hello).ToBytes()));
+    EXPECT_TRUE(RecvFrame(alive, head, data));
+
+    CLOSE_SOCKET(idle);
+    CLOSE_SOCKET(alive);
+}
+
+// 测试优雅退出：停止 accept，已排队的出站数据全部送达后才关闭连接
+TEST_F(ServerTest, GracefulShutdown)
+{
+    Start(256 * 1024, 512 * 1024, 4 * 1024 * 1024);
+
+    const uint32_t count = 400;
+    for (uint32_t i = 0; i < count; i++)
+        server.SendPacket(Push(MsgType::MakeMove, i, 512));
+    server.Shutdown();
+
+    // 排空期间新连接被拒绝
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    SOCKET_TYPE late = ConnectLoopback(TEST_PORT);
+    EXPECT_FALSE(TryHandshake(late));
+    if (late != (SOCKET_TYPE)INVALID_SOCKET)
+        CLOSE_SOCKET(late);
+
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    uint32_t received = 0;
+    while (RecvFrame(client, head, data))
+        received++;
+    EXPECT_EQ(received, count);
+
+    // 排空完成后 Run 返回
+    serverThread.join();
+}
+
+// 构造 Ping：[客户端时间戳][回显的服务端时间戳]
+static std::vector<uint8_t> PingFrame(uint64_t clientTime, uint64_t echoed)
+{
+    std::vector<uint8_t> data(16);
+    std::memcpy(data.data(), &clientTime, 8);
+    std::memcpy(data.data() + 8, &echoed, 8);
+    return Frame(Frame::Status::Ping, 0, {}, data).ToBytes();
+}
+
+// 测试 Ping 由 Reactor 直接应答、不进入上层回调，回显服务端时间戳后得到 RTT
+TEST_F(ServerTest, PingMeasuresRtt)
+{
+    int callbacks = 0;
+    server.SetOnPacketCallback([&callbacks](const Packet &)
+                               { callbacks++; });
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(SendAll(client, PingFrame(12345, 0)));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Pong);
+    EXPECT_EQ(head.sessionId, sessionId);
+    ASSERT_EQ(data.size(), 16u);
+    uint64_t clientTime, serverTime;
+    std::memcpy(&clientTime, data.data(), 8);
+    std::memcpy(&serverTime, data.data() + 8, 8);
+    EXPECT_EQ(clientTime, 12345u);
+    EXPECT_EQ(server.GetRtt(sessionId).samples, 0u);
+
+    // 下一次 Ping 回显服务端时间戳，服务端据此计算往返时延
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_TRUE(SendAll(client, PingFrame(12346, serverTime)));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    Server::RttStats rtt = server.GetRtt(sessionId);
+    EXPECT_EQ(rtt.samples, 1u);
+    EXPECT_GE(rtt.last, 20000u);
+    EXPECT_EQ(rtt.smoothed, rtt.last);
+    EXPECT_EQ(rtt.min, rtt.last);
+
+    // 伪造的未来时间戳不计入
+    ASSERT_TRUE(SendAll(client, PingFrame(12347, serverTime + 3600ull * 1000000)));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(server.GetRtt(sessionId).samples, 1u);
+    EXPECT_EQ(callbacks, 0);
+}
+
+// 测试 Ping 作为心跳维持会话
+TEST_F(ServerTest, PingKeepsSessionAlive)
+{
+    server.SetSessionTimeout(300);
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    for (int i = 0; i < 8; i++)
+    {
+        ASSERT_TRUE(SendAll(client, PingFrame(i, 0)));
+        ASSERT_TRUE(RecvFrame(client, head, data));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    EXPECT_EQ(server.GetStats().expired, 0u);
+}
+
+// 测试未握手的连接只发 Ping 不能续期，仍按空闲超时断开
+TEST_F(ServerTest, PingWithoutSessionStillExpires)
+{
+    server.SetSessionTimeout(300);
+    Launch();
+
+    SOCKET_TYPE raw = ConnectLoopback(TEST_PORT);
+    ASSERT_NE(raw, (SOCKET_TYPE)INVALID_SOCKET);
+    timeval timeout{2, 0};
+    setsockopt(raw, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    bool closed = false;
+    for (int i = 0; i < 20 && !closed; i++)
+    {
+        closed = !SendAll(raw, PingFrame(i, 0)) || !RecvFrame(raw, head, data);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    EXPECT_TRUE(closed);
+    EXPECT_EQ(server.GetStats().expired, 1u);
+    CLOSE_SOCKET(raw);
+}
+
+// 测试握手导出的会话密钥双向可用：客户端加密的请求进入上层回调，服务端推送可被客户端解密
+TEST_F(ServerTest, EncryptedRoundTrip)
+{
+    std::atomic<int> callbacks{0};
+    std::atomic<uint64_t> from{0};
+    server.SetOnPacketCallback([&](const Packet &packet)
+                               {
+        from = packet.sessionId;
+        callbacks++; });
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+
+    ASSERT_TRUE(SendAll(client, SealFrame(session, Packet(sessionId, MsgType::None).ToBytes())));
+    ASSERT_TRUE(WaitFor([&](const Server::NetStats &)
+                        { return callbacks == 1; }));
+    EXPECT_EQ(from, sessionId);
+
+    server.SendPacket(Push(MsgType::MakeMove, 7, 100));
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Active);
+    ASSERT_TRUE(OpenFrame(session, head, data));
+    Packet packet;
+    ASSERT_TRUE(packet.FromData(sessionId, data));
+    EXPECT_EQ(packet.GetParam<uint32_t>("seq"), 7u);
+
+    // 篡改密文后认证失败
+    std::vector<uint8_t> sealed = SealFrame(session, Packet(sessionId, MsgType::None).ToBytes());
+    sealed[sizeof(Frame::Header)] ^= 1;
+    ASSERT_TRUE(SendAll(client, sealed));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Error);
+    EXPECT_EQ(callbacks, 1);
+}
+
+// 测试客户端凭身份公钥验证服务端签名，身份不符时握手失败
+TEST_F(ServerTest, HandshakeVerifiesIdentity)
+{
+    std::vector<uint8_t> seed(IDENTITY_SEED_SIZE, 7);
+    ASSERT_TRUE(server.SetIdentity(seed));
+    EXPECT_FALSE(server.SetIdentity(std::vector<uint8_t>(5, 0)));
+    SigningKey expected(seed);
+    EXPECT_EQ(server.GetIdentityKey(), expected.PublicKey());
+    Launch();
+
+    SOCKET_TYPE sock = ConnectLoopback(TEST_PORT);
+    SessionContext trusted(-1, 0);
+    EXPECT_TRUE(Handshake(sock, trusted, &expected.PublicKey()));
+    CLOSE_SOCKET(sock);
+
+    SigningKey other;
+    sock = ConnectLoopback(TEST_PORT);
+    SessionContext untrusted(-1, 0);
+    EXPECT_FALSE(Handshake(sock, untrusted, &other.PublicKey()));
+    CLOSE_SOCKET(sock);
+}
+
+// 测试 Pending 中的公钥长度不符或为低阶点时返回 Error，会话保持未激活
+TEST_F(ServerTest, PendingRejectsBadKey)
+{
+    Launch();
+    client = ConnectLoopback(TEST_PORT);
+    ASSERT_NE(client, (SOCKET_TYPE)INVALID_SOCKET);
+
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(SendAll(client, Frame(Frame::Status::Hello).ToBytes()));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    uint64_t id = head.sessionId;
+
+    ASSERT_TRUE(SendAll(client, Frame(Frame::Status::Pending, id, {}, std::vector<uint8_t>(8, 1)).ToBytes()));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Error);
+
+    ASSERT_TRUE(SendAll(client, Frame(Frame::Status::Pending, id, {}, std::vector<uint8_t>(X25519_KEY_SIZE, 0)).ToBytes()));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Error);
+
+    ASSERT_TRUE(SendAll(client, Frame(Frame::Status::Active, id, {}, Packet(id, MsgType::None).ToBytes()).ToBytes()));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Inactive);
+}
+
+// 测试握手时协商紧凑线路格式：双向负载按紧凑格式编码，未请求的客户端仍用标准格式
+TEST_F(ServerTest, CompactEncodingNegotiated)
+{
+    std::atomic<uint32_t> seq{0};
+    server.SetOnPacketCallback([&seq](const Packet &packet)
+                               { seq = packet.GetParam<uint32_t>("seq"); });
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+
+    SOCKET_TYPE compactClient = ConnectLoopback(TEST_PORT);
+    timeval timeout{5, 0};
+    setsockopt(compactClient, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+    SessionContext compact(-1, 0);
+    ASSERT_TRUE(Handshake(compactClient, compact, nullptr, WireFormat::Compact));
+    EXPECT_EQ(compact.wireFormat, (uint8_t)WireFormat::Compact);
+    EXPECT_EQ(session.wireFormat, (uint8_t)WireFormat::Standard);
+
+    Packet request(compact.sessionId, MsgType::MakeMove);
+    request.AddParam("seq", uint32_t(5));
+    ASSERT_TRUE(SendAll(compactClient, SealFrame(compact, request.ToBytes(WireFormat::Compact))));
+    ASSERT_TRUE(WaitFor([&](const Server::NetStats &)
+                        { return seq == 5; }));
+
+    Packet push(compact.sessionId, MsgType::MakeMove);
+    push.AddParam("seq", uint32_t(9));
+    server.SendPacket(push);
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(RecvFrame(compactClient, head, data));
+    ASSERT_TRUE(OpenFrame(compact, head, data));
+    EXPECT_EQ(data, push.ToBytes(WireFormat::Compact));
+    Packet packet;
+    ASSERT_TRUE(packet.FromData(compact.sessionId, data, WireFormat::Compact));
+    EXPECT_EQ(packet.GetParam<uint32_t>("seq"), 9u);
+    CLOSE_SOCKET(compactClient);
+}
+
+// 测试服务端关闭紧凑格式时，请求紧凑格式的客户端退回标准格式
+TEST_F(ServerTest, CompactEncodingDisabled)
+{
+    server.SetCompactEncoding(false);
+    Launch();
+    client = ConnectLoopback(TEST_PORT);
+    ASSERT_NE(client, (SOCKET_TYPE)INVALID_SOCKET);
+    ASSERT_TRUE(Handshake(client, session, nullptr, WireFormat::Compact));
+    EXPECT_EQ(session.wireFormat, (uint8_t)WireFormat::Standard);
+}
+
+// 测试出站路径不分配内存：Reactor 线程上 SendPacket 把类型化消息直接编码、加密进出站队列
+TEST_F(ServerTest, SendPathDoesNotAllocate)
+{
+    std::atomic<int> replies{0};
+    std::atomic<size_t> allocs{0};
+    server.SetOnPacketCallback([&](const Packet &packet)
+                               {
+        MoveMsg move;
+        move.x = packet.GetParam<uint32_t>("x");
+        Packet reply = Packet::Of(packet.sessionId, MsgType::MakeMove, move);
+        size_t before = AllocCount();
+        server.SendPacket(std::move(reply));
+        // 前两次用于出站队列与待发列表扩容
+        if (replies++ >= 2)
+            allocs += AllocCount() - before; });
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        Packet request(sessionId, MsgType::MakeMove);
+        request.AddParam("x", i);
+        ASSERT_TRUE(SendAll(client, SealFrame(session, request.ToBytes())));
+
+        Frame::Header head;
+        std::vector<uint8_t> data;
+        ASSERT_TRUE(RecvFrame(client, head, data));
+        ASSERT_TRUE(OpenFrame(session, head, data));
+        MoveMsg move;
+        Packet packet;
+        ASSERT_TRUE(packet.FromData(sessionId, data));
+        ASSERT_TRUE(packet.As(move));
+        EXPECT_EQ(move.x, i);
+    }
+    EXPECT_EQ(replies, 20);
+    EXPECT_EQ(allocs, 0u);
+}
+
+// 测试握手运算交给独立线程时，结果回到 Reactor 后照常应答
+TEST_F(ServerTest, HandshakeOnWorkerThreads)
+{
+    server.SetHandshakeThreads(2);
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+
+    std::vector<SOCKET_TYPE> socks;
+    for (int i = 0; i < 20; i++)
+    {
+        socks.push_back(ConnectLoopback(TEST_PORT));
+        SessionContext other(-1, 0);
+        EXPECT_TRUE(Handshake(socks.back(), other, &server.GetIdentityKey()));
+    }
+    for (SOCKET_TYPE sock : socks)
+        CLOSE_SOCKET(sock);
+
+    server.SendPacket(Push(MsgType::MakeMove, 1));
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_TRUE(OpenFrame(session, head, data));
+}
+
+// 测试握手运算进行中重复的 Hello / Pending 不再排队，每个阶段只提交一次运算、只应答一次
+TEST_F(ServerTest, DuplicateHandshakeFramesQueueOnce)
+{
+    server.SetHandshakeThreads(1);
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+    uint64_t before = server.GetStats().handshakes;
+
+    SOCKET_TYPE sock = ConnectLoopback(TEST_PORT);
+    ASSERT_NE(sock, (SOCKET_TYPE)INVALID_SOCKET);
+    timeval timeout{5, 0};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+
+    // 同一次写入的帧在一轮读事件内解出，运算结果要等本轮结束后才投递回来
+    const int repeats = 20;
+    std::vector<uint8_t> hellos;
+    std::vector<uint8_t> hello = Frame(Frame::Status::Hello, 0, {}, {}).ToBytes();
+    for (int i = 0; i < repeats; i++)
+        hellos.insert(hellos.end(), hello.begin(), hello.end());
+    ASSERT_TRUE(SendAll(sock, hellos));
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(RecvFrame(sock, head, data));
+    ASSERT_EQ(head.status, Frame::Status::NewSession);
+    uint64_t id = head.sessionId;
+
+    SessionContext other(-1, id);
+    ASSERT_TRUE(other.KeyGen());
+    std::vector<uint8_t> pendings;
+    std::vector<uint8_t> pending = Frame(Frame::Status::Pending, id, {}, other.pk).ToBytes();
+    for (int i = 0; i < repeats; i++)
+        pendings.insert(pendings.end(), pending.begin(), pending.end());
+    ASSERT_TRUE(SendAll(sock, pendings));
+    ASSERT_TRUE(RecvFrame(sock, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Activated);
+
+    // 重复帧没有多余的应答：下一帧就是 Pong
+    ASSERT_TRUE(SendAll(sock, PingFrame(1, 0)));
+    ASSERT_TRUE(RecvFrame(sock, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Pong);
+    EXPECT_EQ(server.GetStats().handshakes - before, 2u);
+    CLOSE_SOCKET(sock);
+}
+
+// 测试开启加密后未认证的明文 Active 帧被拒绝，不进入上层回调
+TEST_F(ServerTest, EncryptionRejectsPlaintext)
+{
+    int callbacks = 0;
+    server.SetOnPacketCallback([&callbacks](const Packet &)
+                               { callbacks++; });
+    server.SetEncryption(true);
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> plain = Frame(Frame::Status::Active, sessionId, {}, Packet(sessionId, MsgType::None).ToBytes()).ToBytes();
+    ASSERT_TRUE(SendAll(client, plain));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Error);
+    EXPECT_EQ(callbacks, 0);
+}
+
+// 测试原样重发的已加密帧被重放窗口拒绝，落子只执行一次；之后的新帧照常处理
+TEST_F(ServerTest, ReplayedFrameRejected)
+{
+    std::atomic<int> callbacks{0};
+    server.SetOnPacketCallback([&callbacks](const Packet &)
+                               { callbacks++; });
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+
+    std::vector<uint8_t> move = SealFrame(session, Packet(sessionId, MsgType::MakeMove).ToBytes());
+    ASSERT_TRUE(SendAll(client, move));
+    ASSERT_TRUE(WaitFor([&](const Server::NetStats &)
+                        { return callbacks == 1; }));
+
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(SendAll(client, move));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Error);
+    EXPECT_EQ(callbacks, 1);
+
+    ASSERT_TRUE(SendAll(client, SealFrame(session, Packet(sessionId, MsgType::MakeMove).ToBytes())));
+    ASSERT_TRUE(WaitFor([&](const Server::NetStats &)
+                        { return callbacks == 2; }));
+}
+
+// 测试 Batch 帧：请求按序处理，期间的应答与推送合并为一个 Batch 帧
+TEST_F(ServerTest, BatchAnsweredInOneFrame)
+{
+    server.SetOnPacketCallback([&](const Packet &packet)
+                               {
+        uint32_t seq = packet.GetParam<uint32_t>("seq");
+        Packet reply(packet.sessionId, packet.msgType);
+        reply.AddParam("seq", seq);
+        server.SendPacket(reply);
+        Packet push(packet.sessionId, MsgType::SyncGame);
+        push.AddParam("seq", seq + 100);
+        server.SendPacket(push); });
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+
+    std::vector<Packet> requests = {Push(MsgType::JoinRoom, 1), Push(MsgType::SyncSeat, 2),
+                                    Push(MsgType::SyncRoomSetting, 3), Push(MsgType::SyncGame, 4)};
+    ASSERT_TRUE(SendAll(client, SealFrame(session, BatchBytes(requests), Frame::Status::Batch)));
+
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Batch);
+    ASSERT_TRUE(OpenFrame(session, head, data));
+    std::vector<Packet> replies;
+    ASSERT_TRUE(ReadBatch(sessionId, data, replies));
+    ASSERT_EQ(replies.size(), 8u);
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        EXPECT_EQ(replies[2 * i].msgType, requests[i].msgType);
+        EXPECT_EQ(replies[2 * i].GetParam<uint32_t>("seq"), i + 1);
+        EXPECT_EQ(replies[2 * i + 1].GetParam<uint32_t>("seq"), i + 101);
+    }
+
+    // 单个 Active 请求仍以 Active 帧应答
+    ASSERT_TRUE(SendAll(client, SealFrame(session, Push(MsgType::MakeMove, 5).ToBytes())));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Active);
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Active);
+}
+
+// 测试合并后超过帧长上限的应答拆成多个 Batch 帧，顺序不变；非法的 Batch 负载整批拒绝
+TEST_F(ServerTest, BatchRepliesSplitAtFrameLimit)
+{
+    std::atomic<int> callbacks{0};
+    server.SetOnPacketCallback([&](const Packet &packet)
+                               {
+        callbacks++;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            Packet reply(packet.sessionId, MsgType::SyncGame);
+            reply.AddParam("seq", packet.GetParam<uint32_t>("seq") * 10 + i);
+            reply.AddParam("pad", std::string(300, 'x'));
+            server.SendPacket(reply);
+        } });
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+
+    std::vector<Packet> requests = {Push(MsgType::SyncGame, 1), Push(MsgType::SyncGame, 2)};
+    ASSERT_TRUE(SendAll(client, SealFrame(session, BatchBytes(requests), Frame::Status::Batch)));
+
+    std::vector<uint32_t> seqs;
+    while (seqs.size() < 6)
+    {
+        Frame::Header head;
+        std::vector<uint8_t> data;
+        ASSERT_TRUE(RecvFrame(client, head, data));
+        EXPECT_EQ(head.status, Frame::Status::Batch);
+        EXPECT_LE(head.length, (uint32_t)MAX_FRAME_SIZE);
+        ASSERT_TRUE(OpenFrame(session, head, data));
+        std::vector<Packet> replies;
+        ASSERT_TRUE(ReadBatch(sessionId, data, replies));
+        ASSERT_FALSE(replies.empty());
+        for (const Packet &reply : replies)
+            seqs.push_back(reply.GetParam<uint32_t>("seq"));
+    }
+    EXPECT_EQ(seqs, (std::vector<uint32_t>{10, 11, 12, 20, 21, 22}));
+
+    std::vector<uint8_t> truncated = BatchBytes(requests);
+    truncated.pop_back();
+    ASSERT_TRUE(SendAll(client, SealFrame(session, truncated, Frame::Status::Batch)));
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Error);
+    EXPECT_EQ(callbacks, 2);
+}
+
+// 测试超过帧长上限的应答被丢弃并改为 Error，前后的应答照常送达，流不失步
+TEST_F(ServerTest, OversizeReplyRejected)
+{
+    server.SetOnPacketCallback([this](const Packet &packet)
+                               {
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            Packet reply(packet.sessionId, MsgType::SyncGame);
+            reply.AddParam("seq", i);
+            reply.AddParam("pad", std::string(i == 1 ? MAX_FRAME_SIZE : 16, 'x'));
+            server.SendPacket(reply);
+        } });
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+
+    // 逐帧应答与 Batch 应答两条路径都要拦住超长的包
+    for (Frame::Status status : {Frame::Status::Active, Frame::Status::Batch})
+    {
+        Packet request = Push(MsgType::SyncGame, 0);
+        bool batch = status == Frame::Status::Batch;
+        ASSERT_TRUE(SendAll(client, SealFrame(session, batch ? BatchBytes({request}) : request.ToBytes(), status)));
+
+        std::vector<Frame::Status> statuses;
+        std::vector<uint32_t> seqs;
+        for (int i = 0; i < 3; i++)
+        {
+            Frame::Header head;
+            std::vector<uint8_t> data;
+            ASSERT_TRUE(RecvFrame(client, head, data));
+            EXPECT_LE(head.length, (uint32_t)MAX_FRAME_SIZE);
+            statuses.push_back(head.status);
+            if (head.status == Frame::Status::Error)
+                continue;
+            ASSERT_TRUE(OpenFrame(session, head, data));
+            std::vector<Packet> replies(1);
+            if (batch)
+                ASSERT_TRUE(ReadBatch(sessionId, data, replies));
+            else
+                ASSERT_TRUE(replies[0].FromData(sessionId, data));
+            for (const Packet &reply : replies)
+                seqs.push_back(reply.GetParam<uint32_t>("seq"));
+        }
+        EXPECT_EQ(statuses, (std::vector<Frame::Status>{status, Frame::Status::Error, status}));
+        EXPECT_EQ(seqs, (std::vector<uint32_t>{0, 2}));
+    }
+
+    // 之后的帧仍按序到达
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(SendAll(client, PingFrame(1, 0)));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Pong);
+}
+
+// 测试异步请求乱序完成：写库类请求交给工作线程，后到的请求先得到响应，两者都带回各自的 requestId
+TEST_F(ServerTest, AsyncRequestCompletesOutOfOrder)
+{
+    std::atomic<bool> release{false};
+    server.SetHandshakeThreads(1);
+    server.SetOnPacketCallback([&](const Packet &packet)
+                               {
+        uint64_t sid = packet.sessionId;
+        uint32_t requestId = packet.View().RequestId();
+        MsgType type = packet.msgType;
+        auto reply = [this, sid, requestId, type]()
+        { server.SendPacket(Packet::Of(sid, type, ResultMsg(), requestId)); };
+        if (type == MsgType::SignIn)
+        {
+            // 工作线程上等待放行，最多 2 秒，避免用例失败时卡住 Stop
+            auto work = [&release]()
+            {
+                for (int i = 0; i < 2000 && !release; i++)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            };
+            server.RunAsync(sid, work, reply);
+        }
+        else
+            reply(); });
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+
+    Packet signIn(sessionId, MsgType::SignIn);
+    signIn.AddParam(REQUEST_ID_KEY, uint32_t(1));
+    Packet move(sessionId, MsgType::MakeMove);
+    move.AddParam(REQUEST_ID_KEY, uint32_t(2));
+    ASSERT_TRUE(SendAll(client, SealFrame(session, signIn.ToBytes())));
+    ASSERT_TRUE(SendAll(client, SealFrame(session, move.ToBytes())));
+
+    std::vector<uint32_t> order;
+    for (int i = 0; i < 2; i++)
+    {
+        Frame::Header head;
+        std::vector<uint8_t> data;
+        ASSERT_TRUE(RecvFrame(client, head, data));
+        ASSERT_TRUE(OpenFrame(session, head, data));
+        Packet packet;
+        ASSERT_TRUE(packet.FromData(sessionId, data));
+        order.push_back(packet.View().RequestId());
+        release = true; // MakeMove 的响应已先送达，再放行写库
+    }
+    EXPECT_EQ(order, (std::vector<uint32_t>{2, 1}));
+}
+
+// 测试单会话未完成异步请求达到上限后暂停读取，有请求完成后继续处理积压的请求
+TEST_F(ServerTest, InFlightLimitPausesReading)
+{
+    std::atomic<int> dispatched{0};
+    std::atomic<bool> release{false};
+    server.SetHandshakeThreads(1);
+    server.SetMaxInFlight(2);
+    server.SetOnPacketCallback([&](const Packet &packet)
+                               {
+        dispatched++;
+        uint64_t sid = packet.sessionId;
+        uint32_t requestId = packet.View().RequestId();
+        auto work = [&release]()
+        {
+            for (int i = 0; i < 2000 && !release; i++)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        };
+        server.RunAsync(sid, work, [this, sid, requestId]()
+                        { server.SendPacket(Packet::Of(sid, MsgType::SignIn, ResultMsg(), requestId)); }); });
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+
+    for (uint32_t i = 1; i <= 5; i++)
+    {
+        Packet request(sessionId, MsgType::SignIn);
+        request.AddParam(REQUEST_ID_KEY, i);
+        ASSERT_TRUE(SendAll(client, SealFrame(session, request.ToBytes())));
+    }
+    ASSERT_TRUE(WaitFor([&](const Server::NetStats &)
+                        { return dispatched == 2; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(dispatched, 2);
+
+    release = true;
+    std::vector<uint32_t> ids;
+    for (int i = 0; i < 5; i++)
+    {
+        Frame::Header head;
+        std::vector<uint8_t> data;
+        ASSERT_TRUE(RecvFrame(client, head, data));
+        ASSERT_TRUE(OpenFrame(session, head, data));
+        Packet packet;
+        ASSERT_TRUE(packet.FromData(sessionId, data));
+        ids.push_back(packet.View().RequestId());
+    }
+    EXPECT_EQ(ids, (std::vector<uint32_t>{1, 2, 3, 4, 5}));
+    EXPECT_EQ(dispatched, 5);
+}
+
+// 测试 Batch 帧中的异步请求同样受上限约束：一批 5 个只先分发 2 个，完成后按序分发其余请求
+TEST_F(ServerTest, InFlightLimitAppliesWithinBatch)
+{
+    std::atomic<int> dispatched{0};
+    std::atomic<bool> release{false};
+    server.SetHandshakeThreads(1);
+    server.SetMaxInFlight(2);
+    server.SetOnPacketCallback([&](const Packet &packet)
+                               {
+        dispatched++;
+        uint64_t sid = packet.sessionId;
+        uint32_t requestId = packet.View().RequestId();
+        auto work = [&release]()
+        {
+            for (int i = 0; i < 2000 && !release; i++)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        };
+        server.RunAsync(sid, work, [this, sid, requestId]()
+                        { server.SendPacket(Packet::Of(sid, MsgType::SignIn, ResultMsg(), requestId)); }); });
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+
+    std::vector<Packet> requests;
+    for (uint32_t i = 1; i <= 5; i++)
+    {
+        Packet request(sessionId, MsgType::SignIn);
+        request.AddParam(REQUEST_ID_KEY, i);
+        requests.push_back(request);
+    }
+    ASSERT_TRUE(SendAll(client, SealFrame(session, BatchBytes(requests), Frame::Status::Batch)));
+    ASSERT_TRUE(WaitFor([&](const Server::NetStats &)
+                        { return dispatched == 2; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(dispatched, 2);
+
+    release = true;
+    std::vector<uint32_t> ids;
+    while (ids.size() < 5)
+    {
+        Frame::Header head;
+        std::vector<uint8_t> data;
+        ASSERT_TRUE(RecvFrame(client, head, data));
+        ASSERT_TRUE(OpenFrame(session, head, data));
+        std::vector<Packet> replies(1);
+        if (head.status == Frame::Status::Batch)
+            ASSERT_TRUE(ReadBatch(sessionId, data, replies));
+        else
+            ASSERT_TRUE(replies[0].FromData(sessionId, data));
+        for (const Packet &reply : replies)
+            ids.push_back(reply.View().RequestId());
+    }
+    EXPECT_EQ(ids, (std::vector<uint32_t>{1, 2, 3, 4, 5}));
+    EXPECT_EQ(dispatched, 5);
+}
+
+// 测试断线重连：凭会话密钥计算的证明恢复原会话，沿用原密钥收发
+TEST_F(ServerTest, ResumeAfterReconnect)
+{
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+    CLOSE_SOCKET(client);
+    client = ConnectLoopback(TEST_PORT);
+    ASSERT_NE(client, (SOCKET_TYPE)INVALID_SOCKET);
+    timeval timeout{5, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(SendAll(client, Frame(Frame::Status::Hello, sessionId, {}, session.ResumeProof(1)).ToBytes()));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::Resumed);
+    EXPECT_EQ(head.sessionId, sessionId);
+    EXPECT_EQ(server.GetStats().resumed, 1u);
+
+    server.SendPacket(Push(MsgType::MakeMove, 3));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    ASSERT_TRUE(OpenFrame(session, head, data));
+    Packet packet;
+    ASSERT_TRUE(packet.FromData(sessionId, data));
+    EXPECT_EQ(packet.GetParam<uint32_t>("seq"), 3u);
+}
+
+// 测试断线重连时证明无效则按新会话处理，旧会话不受影响
+TEST_F(ServerTest, ResumeWithBadProofStartsNewSession)
+{
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+    CLOSE_SOCKET(client);
+    client = ConnectLoopback(TEST_PORT);
+    ASSERT_NE(client, (SOCKET_TYPE)INVALID_SOCKET);
+
+    std::vector<uint8_t> proof(RESUME_PROOF_SIZE, 0);
+    proof[0] = 1; // 计数 1，MAC 全零
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(SendAll(client, Frame(Frame::Status::Hello, sessionId, {}, proof).ToBytes()));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::NewSession);
+    EXPECT_NE(head.sessionId, sessionId);
+    EXPECT_EQ(server.GetStats().resumed, 0u);
+}
+
+// 测试多 Reactor：跨 Reactor 投递推送，断线重连落到其他 Reactor 时连接迁移到会话属主
+TEST_F(ServerTest, CrossReactorSendAndResume)
+{
+    const int reactors = 2;
+    std::atomic<uint64_t> target{0};
+    server.SetThreadCount(reactors);
+    server.SetOnPacketCallback([this, &target](const Packet &packet)
+                               {
+        // 在发送方所属 Reactor 上转发给另一个 Reactor 的会话
+        Packet forward(target.load(), MsgType::MakeMove);
+        forward.AddParam("seq", packet.GetParam<uint32_t>("seq"));
+        server.SendPacket(forward); });
+    Launch();
+
+    // 连接分布由内核按四元组散列决定，多建几条直到两个 Reactor 上都有会话
+    timeval timeout{5, 0};
+    std::vector<SOCKET_TYPE> socks;
+    std::vector<std::unique_ptr<SessionContext>> sessions;
+    int owner[reactors] = {-1, -1};
+    for (int i = 0; i < 32 && (owner[0] < 0 || owner[1] < 0); i++)
+    {
+        SOCKET_TYPE sock = ConnectLoopback(TEST_PORT);
+        ASSERT_NE(sock, (SOCKET_TYPE)INVALID_SOCKET);
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+        sessions.push_back(std::make_unique<SessionContext>(-1, 0));
+        socks.push_back(sock);
+        ASSERT_TRUE(Handshake(sock, *sessions.back()));
+        owner[sessions.back()->sessionId & 0xFF] = (int)socks.size() - 1;
+    }
+    ASSERT_GE(owner[0], 0);
+    ASSERT_GE(owner[1], 0);
+    SessionContext &from = *sessions[owner[0]];
+    SessionContext &to = *sessions[owner[1]];
+    target = to.sessionId;
+
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    Packet request(from.sessionId, MsgType::ChatMessage);
+    request.AddParam("seq", uint32_t(7));
+    ASSERT_TRUE(SendAll(socks[owner[0]], SealFrame(from, request.ToBytes())));
+    ASSERT_TRUE(RecvFrame(socks[owner[1]], head, data));
+    ASSERT_TRUE(OpenFrame(to, head, data));
+    Packet forwarded;
+    ASSERT_TRUE(forwarded.FromData(to.sessionId, data));
+    EXPECT_EQ(forwarded.msgType, MsgType::MakeMove);
+    EXPECT_EQ(forwarded.GetParam<uint32_t>("seq"), 7u);
+
+    // 反复重连恢复 Reactor 1 的会话，直到某次新连接落在 Reactor 0 上触发迁移；每次恢复后推送都要送达
+    SOCKET_TYPE &sock = socks[owner[1]];
+    uint32_t counter = 0;
+    while (server.GetStats().migrated == 0 && counter < 32)
+    {
+        CLOSE_SOCKET(sock);
+        sock = ConnectLoopback(TEST_PORT);
+        ASSERT_NE(sock, (SOCKET_TYPE)INVALID_SOCKET);
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+        ASSERT_TRUE(SendAll(sock, Frame(Frame::Status::Hello, to.sessionId, {}, to.ResumeProof(++counter)).ToBytes()));
+        ASSERT_TRUE(RecvFrame(sock, head, data));
+        ASSERT_EQ(head.status, Frame::Status::Resumed);
+        EXPECT_EQ(head.sessionId, to.sessionId);
+
+        Packet push(to.sessionId, MsgType::MakeMove);
+        push.AddParam("seq", counter);
+        server.SendPacket(push);
+        ASSERT_TRUE(RecvFrame(sock, head, data));
+        ASSERT_TRUE(OpenFrame(to, head, data));
+        Packet packet;
+        ASSERT_TRUE(packet.FromData(to.sessionId, data));
+        EXPECT_EQ(packet.GetParam<uint32_t>("seq"), counter);
+    }
+    Server::NetStats stats = server.GetStats();
+    EXPECT_GT(stats.migrated, 0u);
+    EXPECT_EQ(stats.resumed, counter);
+
+    for (SOCKET_TYPE s : socks)
+        CLOSE_SOCKET(s);
+}
+
+// 测试热重启：新进程接管后客户端连接与 sessionId 不变，半帧与未写出的数据都不丢
+TEST_F(ServerTest, HotRestart)
+{
+    std::string path = "/tmp/gomoku_test_" + std::to_string(getpid()) + ".handoff";
+    server.SetHandoffPath(path);
+    server.SetHandoffCallbacks([](uint64_t sessionId)
+                               { return std::vector<uint8_t>{(uint8_t)sessionId}; },
+                               nullptr);
+    Start(8 * 1024, 32 * 1024, 64 * 1024 * 1024);
+
+    // 客户端不读，制造出站积压
+    const uint32_t count = 10000;
+    for (uint32_t i = 0; i < count; i++)
+        server.SendPacket(Push(MsgType::MakeMove, i, 512));
+    ASSERT_TRUE(WaitFor([this](const Server::NetStats &)
+                        { return server.GetOutboundDepth(sessionId) > 0; }));
+
+    // 半个 Hello 留在旧进程的接收缓冲区
+    std::vector<uint8_t> hello = Frame(Frame::Status::Hello).ToBytes();
+    size_t half = hello.size() / 2;
+    ASSERT_TRUE(SendAll(client, std::vector<uint8_t>(hello.begin(), hello.begin() + half)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    Server next;
+    uint64_t imported = 0;
+    std::vector<uint8_t> importedState;
+    next.SetPort(TEST_PORT);
+    next.SetHandoffPath(path, true);
+    next.SetHandoffCallbacks(nullptr, [&](uint64_t id, const std::vector<uint8_t> &state)
+                             {
+        imported = id;
+        importedState = state; });
+    ASSERT_EQ(next.Init(), 0);
+    serverThread.join(); // 旧服务端交接后 Run 返回
+    std::thread nextThread([&next]()
+                           { next.Run(); });
+    EXPECT_EQ(imported, sessionId);
+    EXPECT_EQ(importedState, std::vector<uint8_t>{(uint8_t)sessionId});
+
+    // 旧进程积压的推送由新进程按序写出；nonce 计数随会话交接，新进程继续递增而不重复
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    uint64_t lastCounter = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        ASSERT_TRUE(RecvFrame(client, head, data));
+        uint64_t counter;
+        std::memcpy(&counter, head.iv.data() + NONCE_PREFIX_SIZE, 8);
+        ASSERT_GT(counter, lastCounter);
+        lastCounter = counter;
+        ASSERT_TRUE(OpenFrame(session, head, data));
+        Packet packet;
+        ASSERT_TRUE(packet.FromData(sessionId, data));
+        EXPECT_EQ(packet.GetParam<uint32_t>("seq"), i);
+    }
+
+    // 补齐 Hello，新进程以原 sessionId 应答
+    ASSERT_TRUE(SendAll(client, std::vector<uint8_t>(hello.begin() + half, hello.end())));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    EXPECT_EQ(head.status, Frame::Status::NewSession);
+    EXPECT_EQ(head.sessionId, sessionId);
+
+    // 新进程生成的推送接着旧进程的计数
+    next.SendPacket(Push(MsgType::MakeMove, count));
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    uint64_t counter;
+    std::memcpy(&counter, head.iv.data() + NONCE_PREFIX_SIZE, 8);
+    EXPECT_GT(counter, lastCounter);
+    EXPECT_TRUE(OpenFrame(session, head, data));
+
+    // 继承的监听 Socket 继续接受新连接
+    SOCKET_TYPE fresh = ConnectLoopback(TEST_PORT);
+    EXPECT_TRUE(TryHandshake(fresh));
+    CLOSE_SOCKET(fresh);
+
+    next.Stop();
+    nextThread.join();
+}
+
+// 测试热重启时异步请求未完成：完成回调在交接前执行（不能与交接重复持有逻辑锁），应答随出站队列交接
+TEST_F(ServerTest, HotRestartWithAsyncInFlight)
+{
+    std::string path = "/tmp/gomoku_test_" + std::to_string(getpid()) + ".handoff";
+    std::atomic<bool> started{false}, done{false};
+    server.SetHandoffPath(path);
+    server.SetHandshakeThreads(1);
+    server.SetOnPacketCallback([&](const Packet &packet)
+                               {
+        uint64_t sid = packet.sessionId;
+        uint32_t requestId = packet.View().RequestId();
+        auto work = [&started]()
+        {
+            started = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        };
+        server.RunAsync(sid, work, [this, &done, sid, requestId]()
+                        {
+            done = true;
+            server.SendPacket(Packet::Of(sid, MsgType::SignIn, ResultMsg(), requestId)); }); });
+    Start(32 * 1024, 128 * 1024, 1024 * 1024);
+
+    Packet signIn(sessionId, MsgType::SignIn);
+    signIn.AddParam(REQUEST_ID_KEY, uint32_t(9));
+    ASSERT_TRUE(SendAll(client, SealFrame(session, signIn.ToBytes())));
+    ASSERT_TRUE(WaitFor([&](const Server::NetStats &)
+                        { return started.load(); }));
+
+    Server next;
+    next.SetPort(TEST_PORT);
+    next.SetHandoffPath(path, true);
+    ASSERT_EQ(next.Init(), 0);
+    serverThread.join();
+    EXPECT_TRUE(done);
+    std::thread nextThread([&next]()
+                           { next.Run(); });
+
+    Frame::Header head;
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(RecvFrame(client, head, data));
+    ASSERT_TRUE(OpenFrame(session, head, data));
+    Packet reply;
+    ASSERT_TRUE(reply.FromData(sessionId, data));
+    EXPECT_EQ(reply.msgType, MsgType::SignIn);
+    EXPECT_EQ(reply.View().RequestId(), 9u);
+
+    next.Stop();
+    nextThread.join();
+}
+
+#endif // _WIN32
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "SessionIndex.h"
+
+#include <random>
+#include <unordered_map>
+
+class SessionIndexTest : public ::testing::Test
+{
+protected:
+    SessionIndex index;
+};
+
+// 测试基本的插入、查找与覆盖
+TEST_F(SessionIndexTest, InsertAndFind)
+{
+    index.Insert(0x1100, 5);
+    index.Insert(0x2200, 6);
+    EXPECT_EQ(index.Find(0x1100), 5);
+    EXPECT_EQ(index.Find(0x2200), 6);
+    EXPECT_EQ(index.Find(0x3300), -1);
+    EXPECT_EQ(index.Find(0), -1);
+
+    index.Insert(0x1100, 9);
+    EXPECT_EQ(index.Find(0x1100), 9);
+    EXPECT_EQ(index.Size(), 2u);
+}
+
+// 测试同一桶内冲突项删除后，探测链上的其他项仍可查到
+TEST_F(SessionIndexTest, EraseInCollisionChain)
+{
+    // 低 8 位不参与分桶，以下三个 id 落在同一个桶
+    index.Insert(0x100, 1);
+    index.Insert(0x101, 2);
+    index.Insert(0x102, 3);
+
+    EXPECT_TRUE(index.Erase(0x100));
+    EXPECT_FALSE(index.Erase(0x100));
+    EXPECT_EQ(index.Find(0x101), 2);
+    EXPECT_EQ(index.Find(0x102), 3);
+    EXPECT_EQ(index.Size(), 2u);
+}
+
+// 测试大量随机增删后与 unordered_map 结果一致
+TEST_F(SessionIndexTest, RandomizedAgainstMap)
+{
+    std::mt19937_64 rng(42);
+    std::unordered_map<uint64_t, int> expect;
+    std::vector<uint64_t> ids;
+
+    for (int i = 0; i < 20000; i++)
+    {
+        if (ids.empty() || rng() % 3 != 0)
+        {
+            uint64_t id = rng() | 0x100;
+            int fd = (int)(rng() % 100000);
+            index.Insert(id, fd);
+            if (!expect.count(id))
+                ids.push_back(id);
+            expect[id] = fd;
+        }
+        else
+        {
+            size_t pos = rng() % ids.size();
+            uint64_t id = ids[pos];
+            ids[pos] = ids.back();
+            ids.pop_back();
+            EXPECT_TRUE(index.Erase(id));
+            expect.erase(id);
+        }
+    }
+
+    EXPECT_EQ(index.Size(), expect.size());
+    for (const auto &[id, fd] : expect)
+        EXPECT_EQ(index.Find(id), fd);
+}